@@ -21,7 +21,7 @@ class n_path: public application<T,R> {
         (void) node; (void) nbr; (void) attribute;
         return true;
       };
-      return SparseMatrix<T,R>::build(this->input_graph,node_selection,edge_selection,this->num_threads);
+      return this->build_graph(node_selection,edge_selection);
     }
 
     void run(){
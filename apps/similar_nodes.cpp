@@ -23,7 +23,7 @@ class similar_nodes: public application<T,R> {
         (void) attribute; (void) node; (void) nbr;
         return true;
       };
-      return SparseMatrix<T,R>::build(this->input_graph,node_selection,edge_selection,this->num_threads);
+      return this->build_graph(node_selection,edge_selection);
     }
 
     void run(){
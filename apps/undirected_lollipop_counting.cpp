@@ -21,7 +21,7 @@ class undirected_lollipop_counting: public application<T,R> {
         (void) attribute; (void) node; (void) nbr;
         return true;
       };
-      return SparseMatrix<T,R>::build(this->input_graph,node_selection,edge_selection,this->num_threads);
+      return this->build_graph(node_selection,edge_selection);
     }
 
     void run(){
@@ -34,7 +34,7 @@ class undirected_lollipop_counting: public application<T,R> {
 
       ParallelBuffer<uint32_t> y_buffers(num_threads,graph->max_nbrhood_size * 8);
       ParallelBuffer<uint32_t> z_buffers(num_threads,graph->max_nbrhood_size * 8);
-      ParallelBuffer<uint8_t> r_buffers(num_threads,graph->max_nbrhood_size*sizeof(uint32_t) * 8);
+      ParallelBuffer<uint8_t> r_buffers(num_threads,graph->max_nbrhood_size*MAX_BYTES_PER_ELEMENT);
 
       const size_t matrix_size = graph->matrix_size;
       size_t *t_count = new size_t[num_threads * PADDING];
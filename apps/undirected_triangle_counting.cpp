@@ -21,7 +21,7 @@ class undirected_triangle_counting: public application<T,R> {
         (void) attribute;
         return nbr < node;
       };
-      return SparseMatrix<T,R>::build(this->input_graph,node_selection,edge_selection,this->num_threads);
+      return this->build_graph(node_selection,edge_selection);
     }
 
     void run(){
@@ -62,6 +62,7 @@ class undirected_triangle_counting: public application<T,R> {
       common::stopClock("UNDIRECTED TRIANGLE COUNTING",start_time);
 
       cout << "Number of triangles: " << num_triangles << endl;
+      delete graph;
     }
 };
 
@@ -0,0 +1,429 @@
+/*
+
+An updatable SparseMatrix. Edge insertions and deletions are recorded in a
+per-row delta: a sorted insert buffer and a sorted delete buffer that
+override the packed row (inserted ids are present and deleted ids are absent
+whatever the packed row holds). get_row returns clean rows straight from the
+packed matrix and merges the delta of a dirty row into a Set<T> flattened in
+a caller buffer. compact() re-packs the dirty rows in parallel into a new
+matrix and drops the deltas it folded in. Every update batch that leaves
+more than compact_fraction of the rows dirty compacts on its own, a
+compact_fraction of 0 leaves compaction to the caller.
+
+Queries work on a version: the packed matrix plus the delta chunks at some
+point in time. Versions are never modified once published, updates copy the
+chunks and row deltas they touch and publish a new version. A query that
+holds on to snapshot() therefore sees a consistent graph while updates and
+compactions keep going. Updates are serialized with each other, queries take
+no locks. Snapshots must not outlive the DeltaMatrix that handed them out.
+
+Rows and columns are updated independently: insert_edge(src,dst) adds dst to
+row src and, for asymmetric matrices, src to column dst. Undirected graphs
+must insert both directions themselves (or only the one their pruning keeps).
+
+I is the index type of the underlying SparseMatrix; ids, decode buffers and
+deltas use it, so a 64-bit matrix stays 64-bit through updates and compaction.
+
+*/
+#ifndef DELTAMATRIX_H
+#define DELTAMATRIX_H
+
+#include <memory>
+#include <mutex>
+
+#include "SparseMatrix.hpp"
+
+//Rows per copy-on-write chunk of deltas.
+#define DELTA_CHUNK_ROWS 256
+//Fraction of dirty rows past which an update batch compacts.
+#define DELTA_COMPACT_FRACTION 0.1
+
+template<class T,class R,class I=uint32_t>
+class DeltaMatrix{
+  public:
+    struct row_delta{
+      vector<I> inserts;
+      vector<I> deletes;
+    };
+    typedef vector< shared_ptr<const row_delta> > delta_chunk;
+
+    struct version{
+      shared_ptr< SparseMatrix<T,R,I> > base;
+      //Deltas of the rows [0] and, for asymmetric matrices, of the columns [1].
+      vector< shared_ptr<const delta_chunk> > chunks[2];
+      size_t num_dirty;
+      size_t max_inserts;
+
+      const row_delta* get_delta(const size_t side, const I i) const {
+        const shared_ptr<const delta_chunk> &chunk = chunks[side][i/DELTA_CHUNK_ROWS];
+        return (chunk == NULL) ? NULL : chunk->at(i%DELTA_CHUNK_ROWS).get();
+      }
+
+      //Upper bound of the length of a row, for sizing the decode buffers.
+      size_t max_row_length() const {
+        return base->max_nbrhood_size + max_inserts;
+      }
+
+      //Upper bound of the bytes of a flattened row, for sizing the set buffers.
+      size_t max_row_bytes() const {
+        return max_row_length()*(2*sizeof(I)+BLOCK_SIZE/8) + base->matrix_size/8 + ARENA_PADDING;
+      }
+
+      size_t merge(const size_t side, const I i, I *decoded) const;
+      Set<T> get_row(const I row, I *decoded, uint8_t *buffer) const;
+      Set<T> get_column(const I column, I *decoded, uint8_t *buffer) const;
+    };
+
+    DeltaMatrix(SparseMatrix<T,R,I> *base_in,
+      const double compact_fraction_in = DELTA_COMPACT_FRACTION,
+      const size_t num_threads_in = edge_list::default_num_threads());
+
+    shared_ptr<const version> snapshot() const {
+      return std::atomic_load(&current);
+    }
+
+    void insert_edges(const vector< pair<I,I> > &edges);
+    void delete_edges(const vector< pair<I,I> > &edges);
+    void insert_edge(const I src, const I dst){
+      insert_edges(vector< pair<I,I> >(1,make_pair(src,dst)));
+    }
+    void delete_edge(const I src, const I dst){
+      delete_edges(vector< pair<I,I> >(1,make_pair(src,dst)));
+    }
+
+    bool needs_compaction(const double dirty_fraction) const {
+      shared_ptr<const version> v = snapshot();
+      return v->num_dirty > dirty_fraction*v->base->matrix_size;
+    }
+    void compact(const size_t num_threads);
+
+  private:
+    const double compact_fraction;
+    const size_t num_threads;
+    shared_ptr<const version> current;
+    std::mutex update_lock;
+    std::mutex compaction_lock;
+
+    //Compacted matrices point here, the base may be a mapped snapshot.
+    vector<uint64_t> id_map;
+    vector<uint32_t> node_attributes;
+
+    void apply(const vector< pair<I,I> > &edges, const bool insert);
+    void compact_if_needed(){
+      if(compact_fraction > 0.0 && needs_compaction(compact_fraction))
+        compact(num_threads);
+    }
+};
+
+template<class T,class R,class I>
+DeltaMatrix<T,R,I>::DeltaMatrix(SparseMatrix<T,R,I> *base_in,
+  const double compact_fraction_in, const size_t num_threads_in):
+  compact_fraction(compact_fraction_in),
+  num_threads(num_threads_in){
+  if(base_in->row_edge_attributes != NULL || base_in->column_edge_attributes != NULL){
+    fputs ("Updates of graphs with edge attributes are not supported",stderr); exit (1);
+  }
+  id_map.assign(base_in->id_map,base_in->id_map+base_in->matrix_size);
+  if(base_in->node_attributes != NULL)
+    node_attributes.assign(base_in->node_attributes,base_in->node_attributes+base_in->matrix_size);
+
+  version *v = new version();
+  v->base = shared_ptr< SparseMatrix<T,R,I> >(base_in);
+  const size_t num_chunks = (base_in->matrix_size + DELTA_CHUNK_ROWS - 1)/DELTA_CHUNK_ROWS;
+  v->chunks[0].resize(num_chunks);
+  if(!base_in->symmetric)
+    v->chunks[1].resize(num_chunks);
+  v->num_dirty = 0;
+  v->max_inserts = 0;
+  current = shared_ptr<const version>(v);
+}
+
+/*
+Writes the ids of row (column) i of this version into decoded and returns
+their number: the packed ids without the deletes, merged with the inserts.
+*/
+template<class T,class R,class I>
+size_t DeltaMatrix<T,R,I>::version::merge(const size_t side, const I i, I *decoded) const {
+  const row_delta *delta = get_delta(side,i);
+  const Set<T> packed = (side == 0) ? base->get_row(i) : base->get_column(i);
+  if(delta == NULL){
+    size_t n = 0;
+    packed.foreach([&](I id){
+      decoded[n++] = id;
+    });
+    return n;
+  }
+
+  const vector<I> &inserts = delta->inserts;
+  const vector<I> &deletes = delta->deletes;
+  size_t n = 0;
+  size_t ins = 0;
+  size_t del = 0;
+  packed.foreach([&](I id){
+    while(ins < inserts.size() && inserts[ins] < id)
+      decoded[n++] = inserts[ins++];
+    if(ins < inserts.size() && inserts[ins] == id)
+      ins++;
+    while(del < deletes.size() && deletes[del] < id)
+      del++;
+    if(del < deletes.size() && deletes[del] == id)
+      return;
+    decoded[n++] = id;
+  });
+  while(ins < inserts.size())
+    decoded[n++] = inserts[ins++];
+  return n;
+}
+
+//decoded must hold max_row_length() ids and buffer max_row_bytes() bytes.
+template<class T,class R,class I>
+inline Set<T> DeltaMatrix<T,R,I>::version::get_row(const I row, I *decoded, uint8_t *buffer) const {
+  if(get_delta(0,row) == NULL)
+    return base->get_row(row);
+  const size_t length = merge(0,row,decoded);
+  Set<T>::flatten_from_array(buffer,decoded,length);
+  return Set<T>::from_flattened(buffer,length);
+}
+
+template<class T,class R,class I>
+inline Set<T> DeltaMatrix<T,R,I>::version::get_column(const I column, I *decoded, uint8_t *buffer) const {
+  if(base->symmetric)
+    return get_row(column,decoded,buffer);
+  if(get_delta(1,column) == NULL)
+    return base->get_column(column);
+  const size_t length = merge(1,column,decoded);
+  Set<T>::flatten_from_array(buffer,decoded,length);
+  return Set<T>::from_flattened(buffer,length);
+}
+
+template<class T,class R,class I>
+void DeltaMatrix<T,R,I>::insert_edges(const vector< pair<I,I> > &edges){
+  apply(edges,true);
+  compact_if_needed();
+}
+
+template<class T,class R,class I>
+void DeltaMatrix<T,R,I>::delete_edges(const vector< pair<I,I> > &edges){
+  apply(edges,false);
+  compact_if_needed();
+}
+
+/*
+Publishes a new version with the edges inserted (deleted). Only the chunks
+and row deltas of touched rows are copied, everything else is shared with
+the previous version.
+*/
+template<class T,class R,class I>
+void DeltaMatrix<T,R,I>::apply(const vector< pair<I,I> > &edges, const bool insert){
+  std::lock_guard<std::mutex> guard(update_lock);
+  const shared_ptr<const version> old_version = snapshot();
+  const size_t matrix_size = old_version->base->matrix_size;
+  version *v = new version(*old_version);
+
+  const size_t sides = old_version->base->symmetric ? 1 : 2;
+  for(size_t side = 0; side < sides; side++){
+    //Row deltas are edited one row at a time with the ids in order.
+    vector< pair<I,I> > updates;
+    updates.reserve(edges.size());
+    for(size_t e = 0; e < edges.size(); e++){
+      if(edges[e].first >= matrix_size || edges[e].second >= matrix_size){
+        fputs ("Edge update out of range",stderr); exit (1);
+      }
+      updates.push_back((side == 0) ? edges[e] : make_pair(edges[e].second,edges[e].first));
+    }
+    std::sort(updates.begin(),updates.end());
+    updates.erase(unique(updates.begin(),updates.end()),updates.end());
+
+    delta_chunk *chunk = NULL;
+    size_t chunk_id = (size_t)-1;
+    size_t e = 0;
+    while(e < updates.size()){
+      const I i = updates[e].first;
+      size_t last = e;
+      while(last < updates.size() && updates[last].first == i)
+        last++;
+
+      if(i/DELTA_CHUNK_ROWS != chunk_id){
+        chunk_id = i/DELTA_CHUNK_ROWS;
+        const shared_ptr<const delta_chunk> &old_chunk = v->chunks[side][chunk_id];
+        chunk = (old_chunk == NULL) ? new delta_chunk(DELTA_CHUNK_ROWS) : new delta_chunk(*old_chunk);
+        v->chunks[side][chunk_id] = shared_ptr<const delta_chunk>(chunk);
+      }
+
+      shared_ptr<const row_delta> &slot = chunk->at(i%DELTA_CHUNK_ROWS);
+      row_delta *delta = (slot == NULL) ? new row_delta() : new row_delta(*slot);
+      if(slot == NULL)
+        v->num_dirty++;
+
+      vector<I> ids;
+      for(size_t j = e; j < last; j++)
+        ids.push_back(updates[j].second);
+      vector<I> &add_to = insert ? delta->inserts : delta->deletes;
+      vector<I> &remove_from = insert ? delta->deletes : delta->inserts;
+
+      vector<I> merged;
+      std::set_union(add_to.begin(),add_to.end(),ids.begin(),ids.end(),back_inserter(merged));
+      add_to.swap(merged);
+      merged.clear();
+      std::set_difference(remove_from.begin(),remove_from.end(),ids.begin(),ids.end(),back_inserter(merged));
+      remove_from.swap(merged);
+
+      v->max_inserts = max(v->max_inserts,delta->inserts.size());
+      slot = shared_ptr<const row_delta>(delta);
+      e = last;
+    }
+  }
+  std::atomic_store(&current,shared_ptr<const version>(v));
+}
+
+/*
+Re-packs every dirty row of the current version into a new matrix: clean rows
+are copied byte for byte, dirty rows are merged and flattened into the layout
+T picks for them. Sizing and packing run in parallel like pack_arena.
+Updates that arrive while the new matrix is built are kept: once it is done
+only the deltas that are still the ones that were folded in are dropped.
+*/
+template<class T,class R,class I>
+void DeltaMatrix<T,R,I>::compact(const size_t num_threads){
+  std::lock_guard<std::mutex> compaction_guard(compaction_lock);
+  const shared_ptr<const version> folded = snapshot();
+  if(folded->num_dirty == 0)
+    return;
+
+  const SparseMatrix<T,R,I> *base = folded->base.get();
+  const size_t matrix_size = base->matrix_size;
+  const size_t max_row_length = folded->max_row_length();
+  const size_t max_row_bytes = folded->max_row_bytes();
+
+  double compaction_time = common::startClock();
+
+  I *lengths[2] = {NULL,NULL};
+  uint64_t *offsets[2] = {NULL,NULL};
+  I *ranges[2] = {NULL,NULL};
+  uint8_t *arenas[2] = {NULL,NULL};
+  size_t cardinality = 0;
+  size_t max_nbrhood_size = 0;
+
+  const size_t sides = base->symmetric ? 1 : 2;
+  for(size_t side = 0; side < sides; side++){
+    const I *old_lengths = (side == 0) ? base->row_lengths : base->column_lengths;
+    const uint64_t *old_offsets = (side == 0) ? base->row_offsets : base->column_offsets;
+    const I *old_ranges = (side == 0) ? base->row_ranges : base->column_ranges;
+    const uint8_t *old_data = (side == 0) ? base->row_data : base->column_data;
+
+    lengths[side] = new I[matrix_size];
+    offsets[side] = new uint64_t[matrix_size+1];
+    ranges[side] = (old_ranges != NULL) ? new I[matrix_size] : NULL;
+    offsets[side][0] = 0;
+
+    ParallelBuffer<I> decoded_buffer(num_threads,max_row_length+1);
+    ParallelBuffer<uint8_t> sizing_buffer(num_threads,max_row_bytes);
+
+    //build_flattened counts the layouts it picks, only the final pass should count.
+    const size_t layout_counts[] = {common::num_bs,common::num_pshort,common::num_uint,common::num_bp,common::num_v,common::num_runs};
+    common::par_for_range(num_threads,0,matrix_size,256,
+      [&](size_t tid){
+        decoded_buffer.allocate(tid);
+        sizing_buffer.allocate(tid);
+      },
+      [&](size_t tid, size_t i){
+        if(folded->get_delta(side,i) == NULL){
+          lengths[side][i] = old_lengths[i];
+          offsets[side][i+1] = old_offsets[i+1]-old_offsets[i];
+          if(old_ranges != NULL)
+            ranges[side][i] = old_ranges[i];
+          return;
+        }
+        I * const decoded = decoded_buffer.data[tid];
+        const size_t length = folded->merge(side,i,decoded);
+        lengths[side][i] = length;
+        if(old_ranges != NULL)
+          ranges[side][i] = (length > 0) ? decoded[length-1]-decoded[0] : 0;
+        offsets[side][i+1] = Set<T>::flatten_from_array(sizing_buffer.data[tid],decoded,length);
+      },
+      [&](size_t tid){
+        decoded_buffer.unallocate(tid);
+        sizing_buffer.unallocate(tid);
+      }
+    );
+    common::num_bs = layout_counts[0];
+    common::num_pshort = layout_counts[1];
+    common::num_uint = layout_counts[2];
+    common::num_bp = layout_counts[3];
+    common::num_v = layout_counts[4];
+    common::num_runs = layout_counts[5];
+
+    for(size_t i = 0; i < matrix_size; i++){
+      offsets[side][i+1] += offsets[side][i];
+      cardinality += lengths[side][i];
+      max_nbrhood_size = max(max_nbrhood_size,(size_t)lengths[side][i]);
+    }
+    const size_t total_bytes = offsets[side][matrix_size];
+    arenas[side] = common::allocate_arena(total_bytes+ARENA_PADDING);
+    memset(arenas[side]+total_bytes,0,ARENA_PADDING);
+
+    common::par_for_range(num_threads,0,matrix_size,256,
+      [&](size_t tid){
+        decoded_buffer.allocate(tid);
+      },
+      [&](size_t tid, size_t i){
+        uint8_t * const dst = &arenas[side][offsets[side][i]];
+        if(folded->get_delta(side,i) == NULL){
+          memcpy(dst,&old_data[old_offsets[i]],old_offsets[i+1]-old_offsets[i]);
+          return;
+        }
+        I * const decoded = decoded_buffer.data[tid];
+        const size_t length = folded->merge(side,i,decoded);
+        Set<T>::flatten_from_array(dst,decoded,length);
+      },
+      [&](size_t tid){
+        decoded_buffer.unallocate(tid);
+      }
+    );
+  }
+
+  const size_t col = sides-1;
+  SparseMatrix<T,R,I> *compacted = new SparseMatrix<T,R,I>(matrix_size,cardinality,
+    offsets[0][matrix_size],base->symmetric ? 0 : offsets[col][matrix_size],
+    max_nbrhood_size,base->symmetric,
+    lengths[0],offsets[0],arenas[0],ranges[0],
+    lengths[col],offsets[col],arenas[col],ranges[col],
+    id_map.data(),node_attributes.empty() ? NULL : node_attributes.data(),NULL,NULL,NULL,NULL);
+  slab::trim();
+  common::stopClock("delta compaction",compaction_time);
+
+  //Rebase the deltas that changed since the snapshot onto the new matrix.
+  std::lock_guard<std::mutex> update_guard(update_lock);
+  const shared_ptr<const version> latest = snapshot();
+  version *v = new version();
+  v->base = shared_ptr< SparseMatrix<T,R,I> >(compacted);
+  v->num_dirty = 0;
+  v->max_inserts = 0;
+  for(size_t side = 0; side < sides; side++){
+    v->chunks[side].resize(latest->chunks[side].size());
+    for(size_t c = 0; c < latest->chunks[side].size(); c++){
+      const shared_ptr<const delta_chunk> &chunk = latest->chunks[side][c];
+      const shared_ptr<const delta_chunk> &folded_chunk = folded->chunks[side][c];
+      if(chunk == NULL || chunk == folded_chunk)
+        continue;
+      delta_chunk *kept = new delta_chunk(DELTA_CHUNK_ROWS);
+      bool any_kept = false;
+      for(size_t r = 0; r < DELTA_CHUNK_ROWS; r++){
+        const shared_ptr<const row_delta> &delta = chunk->at(r);
+        if(delta == NULL || (folded_chunk != NULL && delta == folded_chunk->at(r)))
+          continue;
+        kept->at(r) = delta;
+        any_kept = true;
+        v->num_dirty++;
+        v->max_inserts = max(v->max_inserts,delta->inserts.size());
+      }
+      if(any_kept)
+        v->chunks[side][c] = shared_ptr<const delta_chunk>(kept);
+      else
+        delete kept;
+    }
+  }
+  std::atomic_store(&current,shared_ptr<const version>(v));
+}
+
+#endif
@@ -1,7 +1,8 @@
 /*
 
 A vector of vector structure that handles file loading
-and the ordering of the node ID's. 
+and the ordering of the node ID's. Node IDs are of the index
+type I; MutableGraph is the 32-bit graph the applications use.
 
 */
 #ifndef MUTABLEGRAPH_H
@@ -12,17 +13,92 @@ and the ordering of the node ID's.
 #include <assert.h>
 
 #include "common.hpp"
+#include "pipelined_io.hpp"
+#include "edge_list_parser.hpp"
+#include "neighborhood_sort.hpp"
+#include "reordering.hpp"
 #include "set/layouts/hybrid.hpp"
+#include "compressed_graph.hpp"
+#include "ordering_cache.hpp"
+
+/*
+Version 2 of the binary graph format, written by writeToBinaryV2. Every
+section is one contiguous array so that the file can be mmap'd and sliced:
+
+  header | id map | out offsets | out neighbors |
+  (directed only) in offsets | in neighbors
+
+Offsets are uint64_t element offsets into the following neighbor section, one
+per node plus a sentinel. Neighbors are index_bytes wide and every section
+starts on an ALIGNMENT boundary. Files of the first version start with the
+number of nodes instead of MAGIC; the loaders tell them apart by that word.
+*/
+namespace graph_binary {
+  static const uint64_t MAGIC = 0x3248504152474845ULL; // "EHGRAPH2"
+  static const uint32_t VERSION = 2;
+  static const size_t ALIGNMENT = 64;
+
+  struct section{
+    uint64_t offsets;
+    uint64_t data;
+  };
+
+  struct header{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t index_bytes;
+    uint64_t num_nodes;
+    uint64_t num_edges;
+    uint64_t max_nbrhood_size;
+    uint32_t symmetric;
+    uint32_t reserved;
+    uint64_t id_map;
+    section out;
+    section in;
+    uint64_t file_size;
+  };
+
+  inline size_t align(const size_t offset){
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  inline bool is_v2(const string path){
+    uint64_t magic = 0;
+    FILE *pFile = fopen(path.c_str(),"r");
+    if (pFile==NULL) {fputs ("File error",stderr); exit (1);}
+    const bool has_magic = fread(&magic,sizeof(magic),1,pFile) == 1 && magic == MAGIC;
+    fclose(pFile);
+    return has_magic;
+  }
+
+  //Maps a version 2 file read-only, release with munmap(base,h.file_size).
+  inline uint8_t* map(const string path, const size_t index_bytes, const bool symmetric, header &h){
+    int fd = open(path.c_str(),O_RDONLY);
+    if (fd == -1) {fputs ("File error",stderr); exit (1);}
+    if(read(fd,&h,sizeof(h)) != (ssize_t)sizeof(h)) {fputs ("Reading error",stderr); exit (3);}
+    if(h.magic != MAGIC || h.version != VERSION || h.index_bytes != index_bytes) {fputs ("Binary graph format error",stderr); exit (4);}
+    if((h.symmetric != 0) != symmetric) {fputs ("Binary graph has the wrong direction",stderr); exit (4);}
+    struct stat file_stat;
+    fstat(fd,&file_stat);
+    if((size_t)file_stat.st_size < h.file_size) {fputs ("Binary graph is truncated",stderr); exit (3);}
+
+    uint8_t *base = (uint8_t*) mmap(NULL,h.file_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(base == MAP_FAILED) {fputs ("Memory error",stderr); exit (2);}
+    return base;
+  }
+}
 
 /*
 Functors to perform sorts for node orderings. 
 */
+template<class I>
 struct OrderNeighborhoodByDegree{
-  vector< vector<uint32_t>*  > *g;
-  OrderNeighborhoodByDegree(vector< vector<uint32_t>*  > *g_in){
+  const vector< vector<I>*  > *g;
+  OrderNeighborhoodByDegree(const vector< vector<I>*  > *g_in){
     g = g_in;
   }
-  bool operator()(uint32_t i, uint32_t j) const {
+  bool operator()(I i, I j) const {
     size_t i_size = g->at(i)->size();
     size_t j_size = g->at(j)->size();
     if(i_size == j_size)
@@ -30,42 +106,49 @@ struct OrderNeighborhoodByDegree{
     return i_size > j_size;
   }
 };
+template<class I>
 struct OrderNeighborhoodByRevDegree{
-  vector< vector<uint32_t>*  > *g;
-  OrderNeighborhoodByRevDegree(vector< vector<uint32_t>*  > *g_in){
+  const vector< vector<I>*  > *g;
+  OrderNeighborhoodByRevDegree(const vector< vector<I>*  > *g_in){
     g = g_in;
   }
-  bool operator()(uint32_t i, uint32_t j) const { 
-    return (g->at(i)->size() < g->at(j)->size()); 
+  bool operator()(I i, I j) const { 
+    size_t i_size = g->at(i)->size();
+    size_t j_size = g->at(j)->size();
+    if(i_size == j_size)
+      return i < j;
+    return i_size < j_size;
   }
 };
+template<class I>
 struct OrderByID{
   OrderByID(){}
-  bool operator()(pair<uint32_t,uint32_t> i, pair<uint32_t,uint32_t> j) const {
+  bool operator()(pair<I,uint32_t> i, pair<I,uint32_t> j) const {
     return i.first < j.first;
   }
 };
 
-struct MutableGraph {
+template<class I>
+struct BasicMutableGraph {
   size_t num_nodes;
   size_t num_edges;
   size_t max_nbrhood_size;
   bool symmetric;
   vector<uint64_t> *id_map;
   vector<uint32_t> *node_attr;
-  vector< vector<uint32_t>*  > *out_neighborhoods;
-  vector< vector<uint32_t>*  > *in_neighborhoods;
+  vector< vector<I>*  > *out_neighborhoods;
+  vector< vector<I>*  > *in_neighborhoods;
   vector< vector<uint32_t>*  > *out_edge_attributes;
   vector< vector<uint32_t>*  > *in_edge_attributes;
 
-  MutableGraph(  size_t num_nodes_in, 
+  BasicMutableGraph(  size_t num_nodes_in, 
       size_t num_edges_in,
       size_t max_nbrhood_size_in,
       bool symmetric_in,
       vector<uint64_t> *id_map_in,
       vector<uint32_t> *node_attr_in,
-      vector< vector<uint32_t>*  > *out_neighborhoods_in,
-      vector< vector<uint32_t>*  > *in_neighborhoods_in,
+      vector< vector<I>*  > *out_neighborhoods_in,
+      vector< vector<I>*  > *in_neighborhoods_in,
       vector< vector<uint32_t>*  > *out_edge_attributes_in,
       vector< vector<uint32_t>*  > *in_edge_attributes_in): 
     num_nodes(num_nodes_in), 
@@ -78,7 +161,7 @@ struct MutableGraph {
     in_neighborhoods(in_neighborhoods_in),
     out_edge_attributes(out_edge_attributes_in),
     in_edge_attributes(in_edge_attributes_in){}
-  ~MutableGraph(){
+  ~BasicMutableGraph(){
     for(size_t i = 0; i < out_neighborhoods->size(); ++i) {
       delete out_neighborhoods->at(i);
     }
@@ -93,82 +176,117 @@ struct MutableGraph {
   }
 
   /*
-  Given a mapping of IDs remap the IDs into a new vector structure.
-  Then set the out and in neighborhoods in the graph.
-  This function only works for undirected graphs currently.
+  Given a mapping of IDs (new to old) relabel the graph. The out and, for
+  directed graphs, the in neighborhoods are relabeled and sorted again in
+  parallel, together with their edge attributes. The id map and the node
+  attributes are permuted.
   */
-  void reassign_ids(vector<uint32_t> const& new2old_ids) {
-    vector<uint32_t> old2new_ids(num_nodes);
-    for(size_t i = 0; i < num_nodes; i++) {
-      old2new_ids.at(new2old_ids.at(i)) = i;
+  void reassign_ids(vector<I> const& new2old_ids,
+    const size_t num_threads = edge_list::default_num_threads()) {
+    vector<I> old2new_ids(num_nodes);
+    common::par_for_range(num_threads,0,num_nodes,4096,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        old2new_ids[new2old_ids[i]] = i;
+      });
+
+    vector<uint64_t> *new_id_map = new vector<uint64_t>(num_nodes);
+    vector<uint32_t> *new_node_attr = (node_attr == NULL) ? NULL : new vector<uint32_t>(num_nodes);
+    common::par_for_range(num_threads,0,num_nodes,4096,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        new_id_map->at(i) = id_map->at(new2old_ids[i]);
+        if(new_node_attr != NULL)
+          new_node_attr->at(i) = node_attr->at(new2old_ids[i]);
+      });
+    id_map->swap(*new_id_map);
+    delete new_id_map;
+    if(new_node_attr != NULL){
+      node_attr->swap(*new_node_attr);
+      delete new_node_attr;
     }
 
-    vector<uint64_t> *new_id_map = new vector<uint64_t>();
-    vector<vector<uint32_t>*>* new_neighborhoods =
-      new vector<vector<uint32_t>*>(num_nodes);
-
-    for(size_t i = 0; i < out_neighborhoods->size(); ++i) {
-      vector<uint32_t> *hood = out_neighborhoods->at(new2old_ids.at(i));
-      new_id_map->push_back(id_map->at(new2old_ids.at(i)));
-      for(size_t j = 0; j < hood->size(); ++j) {
-        hood->at(j) = old2new_ids.at(hood->at(j));
-      }
-      sort(hood->begin(),hood->end());
-      new_neighborhoods->at(i) = hood;
+    const bool shared_attributes = (in_edge_attributes == out_edge_attributes);
+    vector< vector<I>* > *new_out = relabel_side(out_neighborhoods,out_edge_attributes,
+      new2old_ids,old2new_ids,num_threads);
+    if(symmetric){
+      in_neighborhoods = new_out;
+    } else{
+      in_neighborhoods = relabel_side(in_neighborhoods,shared_attributes ? NULL : in_edge_attributes,
+        new2old_ids,old2new_ids,num_threads);
     }
-
-    id_map->swap(*new_id_map);
-    out_neighborhoods = new_neighborhoods;
-    in_neighborhoods = new_neighborhoods;
+    out_neighborhoods = new_out;
+    if(shared_attributes)
+      in_edge_attributes = out_edge_attributes;
   }
 
-  //BFS ordering.
-  void reorder_bfs(){
-    vector<uint32_t> tmp_new2old_ids = common::range(num_nodes);
-    std::random_shuffle(tmp_new2old_ids.begin(), tmp_new2old_ids.end());
-    //std::sort(tmp_new2old_ids.begin(), tmp_new2old_ids.end(), OrderNeighborhoodByDegree(out_neighborhoods));
-
-    vector<uint32_t> new2old_ids;
-    new2old_ids.reserve(num_nodes);
-
-    std::unordered_set<uint32_t> visited;
-
-    vector<uint32_t> cur_level;
-    size_t bfs_i = 0;
-    uint32_t mapped_bfs_i = tmp_new2old_ids.at(bfs_i);
-    cur_level.push_back(mapped_bfs_i);
-    new2old_ids.push_back(mapped_bfs_i);
-    visited.insert(mapped_bfs_i);
-    bfs_i++;
-
-    vector<uint32_t> next_level;
-    while(new2old_ids.size() != out_neighborhoods->size()){
-      for(size_t i = 0; i < cur_level.size(); i++) {
-        vector<uint32_t>* hood = out_neighborhoods->at(cur_level.at(i));
+  /*
+  Moves the rows of one side to their new positions, relabels their
+  neighbors and sorts them again (with their attributes, permuted alongside,
+  if there are any). Returns the new neighborhoods, the old vector is freed.
+  */
+  vector< vector<I>* >* relabel_side(vector< vector<I>* > *neighborhoods,
+    vector< vector<uint32_t>* > *edge_attributes, vector<I> const& new2old_ids,
+    vector<I> const& old2new_ids, const size_t num_threads) {
+
+    vector< vector<I>* > *new_neighborhoods = new vector< vector<I>* >(num_nodes);
+    vector< vector<uint32_t>* > *new_attributes = (edge_attributes == NULL) ? NULL :
+      new vector< vector<uint32_t>* >(num_nodes);
+    common::par_for_range(num_threads,0,num_nodes,neighborhood_sort::ROW_BATCH,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        vector<I> *hood = neighborhoods->at(new2old_ids[i]);
         for(size_t j = 0; j < hood->size(); ++j) {
-          if(visited.find(hood->at(j)) == visited.end()){
-            next_level.push_back(hood->at(j));
-            new2old_ids.push_back(hood->at(j));
-            visited.insert(hood->at(j));
-          }
-        }
-      }
-      if(next_level.size() == 0 && new2old_ids.size() < out_neighborhoods->size()) {
-        while(visited.find(tmp_new2old_ids.at(bfs_i)) != visited.end()) {
-          bfs_i++;
+          hood->at(j) = old2new_ids[hood->at(j)];
         }
-        uint32_t mapped_bfs_i = tmp_new2old_ids.at(bfs_i);
-        next_level.push_back(mapped_bfs_i);
-        new2old_ids.push_back(mapped_bfs_i);
-        visited.insert(mapped_bfs_i);
-        bfs_i++;
-      }
+        new_neighborhoods->at(i) = hood;
+        if(new_attributes != NULL)
+          new_attributes->at(i) = edge_attributes->at(new2old_ids[i]);
+      });
+    delete neighborhoods;
+
+    if(new_attributes == NULL){
+      neighborhood_sort::sort_rows(*new_neighborhoods,num_threads,std::less<I>(),
+        [](size_t tid, size_t i){ (void) tid; (void) i; });
+    } else{
+      neighborhood_sort::sort_attributed_neighborhoods<I>(new_neighborhoods,new_attributes,
+        num_threads,max_nbrhood_size);
+      edge_attributes->swap(*new_attributes);
+      delete new_attributes;
+    }
+    return new_neighborhoods;
+  }
 
-      cur_level.swap(next_level);
-      next_level.clear();
+  /*
+  Relabels the graph by the order (new to old ids) that order computes from
+  undirected neighborhoods: the out neighborhoods of a symmetric graph, the
+  union of the out and in neighborhoods of a directed one.
+  */
+  void reorder_by(const std::function<vector<I>(const vector< vector<I>* >*)> order,
+    const size_t num_threads) {
+    if(symmetric){
+      reassign_ids(order(out_neighborhoods),num_threads);
+      return;
     }
+    vector< vector<I>* > *neighborhoods =
+      reordering::undirected_neighborhoods<I>(out_neighborhoods,in_neighborhoods,num_threads);
+    const vector<I> new2old_ids = order(neighborhoods);
+    for(size_t i = 0; i < neighborhoods->size(); i++) {
+      delete neighborhoods->at(i);
+    }
+    delete neighborhoods;
+    reassign_ids(new2old_ids,num_threads);
+  }
 
-    reassign_ids(new2old_ids);
+  //BFS ordering, see reordering::bfs_order.
+  void reorder_bfs(const size_t num_threads = edge_list::default_num_threads()){
+    vector<I> seeds = common::range<I>(num_nodes);
+    std::random_shuffle(seeds.begin(), seeds.end());
+    //std::sort(seeds.begin(), seeds.end(), OrderNeighborhoodByDegree<I>(out_neighborhoods));
+
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        return reordering::bfs_order<I>(neighborhoods,seeds,num_threads);
+      },num_threads);
   }
 
   /*
@@ -176,34 +294,22 @@ struct MutableGraph {
   Next we take the second largest neighborhood and assign the next consecutive 
   IDs.  Proceed until whole graph has been labeled.
   */
-  void reorder_strong_run(){
-    vector<uint32_t> tmp_new2old_ids = common::range(num_nodes);
-    std::sort(tmp_new2old_ids.begin(), tmp_new2old_ids.end(), OrderNeighborhoodByDegree(out_neighborhoods));
-
-    vector<uint32_t> new2old_ids;
-    new2old_ids.reserve(num_nodes);
-
-    std::unordered_set<uint32_t> visited;
-    for(uint32_t v : tmp_new2old_ids) {
-      vector<uint32_t> *hood = out_neighborhoods->at(v);
-      for(size_t j = 0; j < hood->size(); ++j) {
-        if(visited.find(hood->at(j)) == visited.end()){
-          new2old_ids.push_back(hood->at(j));
-          visited.insert(hood->at(j));
-        }
-      }
-    }
-
-    reassign_ids(new2old_ids);
+  void reorder_strong_run(const size_t num_threads = edge_list::default_num_threads()){
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        vector<I> rows = common::range<I>(num_nodes);
+        neighborhood_sort::parallel_sort(rows.data(),num_nodes,num_threads,
+          OrderNeighborhoodByDegree<I>(neighborhoods));
+        return reordering::first_appearance_order<I>(neighborhoods,rows,num_threads);
+      },num_threads);
   }
 
   /*
   A random ordering of node IDs.
   */
-  void reorder_random() {
-    vector<uint32_t> new2old_ids = common::range(num_nodes);
+  void reorder_random(const size_t num_threads = edge_list::default_num_threads()) {
+    vector<I> new2old_ids = common::range<I>(num_nodes);
     std::random_shuffle(new2old_ids.begin(), new2old_ids.end());
-    reassign_ids(new2old_ids);
+    reassign_ids(new2old_ids,num_threads);
   }
 
   /*
@@ -211,77 +317,243 @@ struct MutableGraph {
 
   http://www.eecs.harvard.edu/~michaelm/postscripts/kdd2009.pdf
   */
-  void reorder_by_shingles() {
-    // Initialize ordering
-    vector<uint32_t> ordering = common::range(num_nodes);
-    vector<uint32_t> new2old_ids = common::range(num_nodes);
-
-    // Find shingles for different orderings
-    const size_t num_orderings = 2;
-    vector<vector<uint32_t>> shingles(num_orderings, vector<uint32_t>(num_nodes));
-    for(size_t i = 0; i < num_orderings; i++) {
-      // New ordering
-      std::random_shuffle(ordering.begin(), ordering.end());
-
-      // Find shingles for each neighbor set
-      for(size_t j = 0; j < num_nodes; j++) {
-        vector<uint32_t>* neighbors = out_neighborhoods->at(j);
-
-        uint32_t shingle = 0;
-        if(neighbors->size() > 0) {
-          shingle = neighbors->at(0);
-          uint32_t shingle_ord = ordering.at(shingle);
-          for(size_t k = 1; k < neighbors->size(); k++) {
-            uint32_t curr_elem = neighbors->at(k);
-            uint32_t curr_ord = ordering.at(curr_elem);
-            if(curr_ord < shingle_ord) {
-              shingle = curr_elem;
-              shingle_ord = curr_ord;
-            }
-          }
+  void reorder_by_shingles(const size_t num_threads = edge_list::default_num_threads()) {
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        // Initialize ordering
+        vector<I> ordering = common::range<I>(num_nodes);
+        vector<I> new2old_ids = common::range<I>(num_nodes);
+
+        // Find shingles for different orderings
+        const size_t num_orderings = 2;
+        vector<vector<I>> shingles(num_orderings, vector<I>(num_nodes));
+        for(size_t i = 0; i < num_orderings; i++) {
+          // New ordering
+          std::random_shuffle(ordering.begin(), ordering.end());
+
+          // Find shingles for each neighbor set
+          common::par_for_range(num_threads,0,num_nodes,neighborhood_sort::ROW_BATCH,
+            [&](size_t tid, size_t j){
+              (void) tid;
+              vector<I>* neighbors = neighborhoods->at(j);
+
+              I shingle = 0;
+              if(neighbors->size() > 0) {
+                shingle = neighbors->at(0);
+                I shingle_ord = ordering[shingle];
+                for(size_t k = 1; k < neighbors->size(); k++) {
+                  I curr_elem = neighbors->at(k);
+                  I curr_ord = ordering[curr_elem];
+                  if(curr_ord < shingle_ord) {
+                    shingle = curr_elem;
+                    shingle_ord = curr_ord;
+                  }
+                }
+              }
+              shingles[i][j] = shingle;
+            });
         }
-        shingles.at(i).at(j) = shingle;
-      }
-    }
 
-    auto cmp_nodes = [&shingles](uint32_t a, uint32_t b) -> bool {
-      for(size_t i = 0; i < num_orderings; i++) {
-        uint32_t a_val = shingles.at(i).at(a);
-        uint32_t b_val = shingles.at(i).at(b);
+        //Ties are broken by id so the order does not depend on the sort.
+        auto cmp_nodes = [&shingles](I a, I b) -> bool {
+          for(size_t i = 0; i < num_orderings; i++) {
+            I a_val = shingles[i][a];
+            I b_val = shingles[i][b];
 
-        if(a_val < b_val) {
-          return true;
-        } else if(a_val > b_val) {
-          return false;
-        }
-      }
+            if(a_val < b_val) {
+              return true;
+            } else if(a_val > b_val) {
+              return false;
+            }
+          }
 
-      return false;
-    };
+          return a < b;
+        };
 
-    // Sort using shingles
-    std::sort(new2old_ids.begin(), new2old_ids.end(), cmp_nodes);
-    reassign_ids(new2old_ids);
+        // Sort using shingles
+        neighborhood_sort::parallel_sort(new2old_ids.data(),num_nodes,num_threads,cmp_nodes);
+        return new2old_ids;
+      },num_threads);
   }
 
   //Order by degree
-  void reorder_by_degree(){
-    vector<uint32_t> new2old_ids = common::range(num_nodes);
-    std::sort(new2old_ids.begin(), new2old_ids.end(), OrderNeighborhoodByDegree(out_neighborhoods));
-    reassign_ids(new2old_ids);
+  void reorder_by_degree(const size_t num_threads = edge_list::default_num_threads()){
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        vector<I> new2old_ids = common::range<I>(num_nodes);
+        neighborhood_sort::parallel_sort(new2old_ids.data(),num_nodes,num_threads,
+          OrderNeighborhoodByDegree<I>(neighborhoods));
+        return new2old_ids;
+      },num_threads);
   }
 
   //Reverse degree.
-  void reorder_by_rev_degree(){
-    vector<uint32_t> new2old_ids = common::range(num_nodes);
-    std::sort(new2old_ids.begin(), new2old_ids.end(), OrderNeighborhoodByRevDegree(out_neighborhoods));
-    reassign_ids(new2old_ids);
+  void reorder_by_rev_degree(const size_t num_threads = edge_list::default_num_threads()){
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        vector<I> new2old_ids = common::range<I>(num_nodes);
+        neighborhood_sort::parallel_sort(new2old_ids.data(),num_nodes,num_threads,
+          OrderNeighborhoodByRevDegree<I>(neighborhoods));
+        return new2old_ids;
+      },num_threads);
+  }
+
+  //Reverse Cuthill-McKee, see reordering::rcm_order.
+  void reorder_rcm(const size_t num_threads = edge_list::default_num_threads()){
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        return reordering::rcm_order<I>(neighborhoods,num_threads);
+      },num_threads);
+  }
+
+  /*
+  Gorder, see reordering::gorder_order. The window is the number of
+  recently placed nodes a candidate is scored against.
+  */
+  void reorder_gorder(const size_t window = 5,
+    const size_t num_threads = edge_list::default_num_threads()){
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        return reordering::gorder_order<I>(neighborhoods,window,num_threads);
+      },num_threads);
+  }
+
+  //Rabbit Order, see reordering::rabbit_order.
+  void reorder_rabbit(const size_t num_threads = edge_list::default_num_threads()){
+    reorder_by([&](const vector< vector<I>* > *neighborhoods){
+        return reordering::rabbit_order<I>(neighborhoods,num_threads);
+      },num_threads);
   }
 
   //Our hybrid ordering scheme
-  void reorder_by_the_game() {
-    reorder_bfs();
-    reorder_by_degree();
+  void reorder_by_the_game(const size_t num_threads = edge_list::default_num_threads()) {
+    reorder_bfs(num_threads);
+    reorder_by_degree(num_threads);
+  }
+
+  //Applies the ordering of the given name, false if there is none.
+  bool reorder_by_name(const string ordering,
+    const size_t num_threads = edge_list::default_num_threads()) {
+    if(ordering == "bfs") reorder_bfs(num_threads);
+    else if(ordering == "strong_run") reorder_strong_run(num_threads);
+    else if(ordering == "random") reorder_random(num_threads);
+    else if(ordering == "shingles") reorder_by_shingles(num_threads);
+    else if(ordering == "degree") reorder_by_degree(num_threads);
+    else if(ordering == "rev_degree") reorder_by_rev_degree(num_threads);
+    else if(ordering == "rcm") reorder_rcm(num_threads);
+    else if(ordering == "gorder") reorder_gorder(5,num_threads);
+    else if(ordering == "rabbit") reorder_rabbit(num_threads);
+    else if(ordering == "the_game") reorder_by_the_game(num_threads);
+    else return false;
+    return true;
+  }
+
+  /*
+  Applies an ordering by name like reorder_by_name, but reuses the ordering
+  cached next to graph_path if it was computed for this graph, and caches
+  it there otherwise (see ordering_cache). Exits on an unknown ordering.
+  */
+  void reorder_cached(const string ordering, const string graph_path,
+    const size_t num_threads = edge_list::default_num_threads()) {
+    const string cache_path = ordering_cache::path(graph_path,ordering);
+    const uint64_t graph_hash = ordering_cache::graph_hash<I>(id_map,out_neighborhoods,
+      in_neighborhoods,symmetric,num_threads);
+
+    vector<I> new2old_ids;
+    if(ordering_cache::load<I>(cache_path,ordering,graph_hash,num_nodes,new2old_ids)){
+      cout << "Using cached ordering " << cache_path << endl;
+      reassign_ids(new2old_ids,num_threads);
+      return;
+    }
+
+    //Orderings may relabel several times; labelling the nodes with their
+    //positions first makes the id map end up as the composed new to old ids.
+    vector<uint64_t> loaded_id_map(num_nodes);
+    common::par_for_range(num_threads,0,num_nodes,4096,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        loaded_id_map[i] = id_map->at(i);
+        id_map->at(i) = i;
+      });
+    if(!reorder_by_name(ordering,num_threads)) {fputs ("Unknown ordering",stderr); exit (1);}
+    new2old_ids.resize(num_nodes);
+    common::par_for_range(num_threads,0,num_nodes,4096,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        new2old_ids[i] = id_map->at(i);
+        id_map->at(i) = loaded_id_map[new2old_ids[i]];
+      });
+
+    if(ordering_cache::save<I>(cache_path,ordering,graph_hash,new2old_ids))
+      cout << "Cached ordering " << cache_path << endl;
+    else
+      cout << "WARNING: could not cache the ordering at " << cache_path << endl;
+  }
+
+  /*
+  Position of every node in an orientation order. Pruned symmetric builds
+  compare these positions instead of the ids, so an edge is kept towards the
+  endpoint with the smaller rank: the higher degree node, or the node that is
+  peeled later when repeatedly removing a node of minimum degree.
+  */
+  vector<I> orientation_ranks(const common::orientation orientation) {
+    vector<I> ranks(num_nodes);
+    if(orientation == common::DEGREE_ORDER){
+      vector<I> order = common::range<I>(num_nodes);
+      std::sort(order.begin(), order.end(), OrderNeighborhoodByDegree<I>(out_neighborhoods));
+      for(size_t i = 0; i < num_nodes; i++) {
+        ranks.at(order.at(i)) = i;
+      }
+    } else if(orientation == common::DEGENERACY_ORDER){
+      //Batagelj and Zaversnik, An O(m) Algorithm for Cores Decomposition of Networks.
+      vector<size_t> degree(num_nodes);
+      size_t max_degree = 0;
+      for(size_t v = 0; v < num_nodes; v++) {
+        degree.at(v) = out_neighborhoods->at(v)->size();
+        max_degree = max(max_degree,degree.at(v));
+      }
+      vector<size_t> bin(max_degree+1,0);
+      for(size_t v = 0; v < num_nodes; v++) {
+        bin.at(degree.at(v))++;
+      }
+      size_t start = 0;
+      for(size_t d = 0; d <= max_degree; d++) {
+        const size_t count = bin.at(d);
+        bin.at(d) = start;
+        start += count;
+      }
+      vector<size_t> pos(num_nodes);
+      vector<I> vert(num_nodes);
+      for(size_t v = 0; v < num_nodes; v++) {
+        pos.at(v) = bin.at(degree.at(v))++;
+        vert.at(pos.at(v)) = v;
+      }
+      for(size_t d = max_degree; d > 0; d--) {
+        bin.at(d) = bin.at(d-1);
+      }
+      bin.at(0) = 0;
+
+      for(size_t i = 0; i < num_nodes; i++) {
+        const I v = vert.at(i);
+        vector<I> *hood = out_neighborhoods->at(v);
+        for(size_t j = 0; j < hood->size(); j++) {
+          const I u = hood->at(j);
+          if(degree.at(u) > degree.at(v)) {
+            const size_t du = degree.at(u);
+            const size_t pu = pos.at(u);
+            const size_t pw = bin.at(du);
+            const I w = vert.at(pw);
+            if(u != w) {
+              pos.at(u) = pw;
+              vert.at(pu) = w;
+              pos.at(w) = pu;
+              vert.at(pw) = u;
+            }
+            bin.at(du)++;
+            degree.at(u)--;
+          }
+        }
+        ranks.at(v) = num_nodes-1-i;
+      }
+    } else{
+      ranks = common::range<I>(num_nodes);
+    }
+    return ranks;
   }
 
   /*
@@ -304,22 +576,180 @@ struct MutableGraph {
     size_t osize = out_neighborhoods->size();
     outfile.write((char *)&osize, sizeof(osize));
     for(size_t i = 0; i < out_neighborhoods->size(); ++i){
-      vector<uint32_t> *row = out_neighborhoods->at(i);
+      vector<I> *row = out_neighborhoods->at(i);
       size_t rsize = row->size();
       outfile.write((char*)&id_map->at(i),sizeof(uint64_t));
       outfile.write((char *)&rsize, sizeof(rsize));
-      outfile.write((char *)row->data(),sizeof(uint32_t)*rsize);
+      outfile.write((char *)row->data(),sizeof(I)*rsize);
     }
     outfile.close();
   }
 
-  static MutableGraph* undirectedFromBinary(const string path) {
-    ifstream infile;
-    infile.open(path, ios::binary | ios::in);
+  //Writes the graph in version 2 of the binary format (see graph_binary).
+  void writeToBinaryV2(const string path) {
+    std::cout << "Writing graph to binary file..." << std::endl;
+
+    ofstream outfile;
+    outfile.open(path, ios::binary | ios::out);
+    if(!outfile.is_open()) {fputs ("File error",stderr); exit (1);}
+
+    graph_binary::header h;
+    memset(&h,0,sizeof(h));
+    h.magic = graph_binary::MAGIC;
+    h.version = graph_binary::VERSION;
+    h.index_bytes = sizeof(I);
+    h.num_nodes = num_nodes;
+    h.symmetric = symmetric;
+
+    //The header is rewritten once all section offsets are known.
+    outfile.write((char*)&h,sizeof(h));
+    size_t position = sizeof(h);
+    const char padding[graph_binary::ALIGNMENT] = {0};
+    auto start_section = [&]() -> uint64_t {
+      const size_t start = graph_binary::align(position);
+      outfile.write(padding,start-position);
+      position = start;
+      return start;
+    };
+
+    h.id_map = start_section();
+    outfile.write((char*)id_map->data(),sizeof(uint64_t)*num_nodes);
+    position += sizeof(uint64_t)*num_nodes;
+
+    auto write_side = [&](vector< vector<I>* > *neighborhoods, graph_binary::section &sec){
+      vector<uint64_t> offsets(num_nodes+1,0);
+      for(size_t i = 0; i < num_nodes; i++){
+        offsets[i+1] = offsets[i] + neighborhoods->at(i)->size();
+        h.max_nbrhood_size = max(h.max_nbrhood_size,(uint64_t)neighborhoods->at(i)->size());
+      }
+      h.num_edges += offsets[num_nodes];
+      sec.offsets = start_section();
+      outfile.write((char*)offsets.data(),sizeof(uint64_t)*(num_nodes+1));
+      position += sizeof(uint64_t)*(num_nodes+1);
+      sec.data = start_section();
+      for(size_t i = 0; i < num_nodes; i++){
+        outfile.write((char*)neighborhoods->at(i)->data(),sizeof(I)*neighborhoods->at(i)->size());
+      }
+      position += sizeof(I)*offsets[num_nodes];
+    };
+    write_side(out_neighborhoods,h.out);
+    if(!symmetric)
+      write_side(in_neighborhoods,h.in);
+    h.file_size = position;
+
+    outfile.seekp(0);
+    outfile.write((char*)&h,sizeof(h));
+    outfile.close();
+  }
+
+  /*
+  Loads a version 2 binary file. The file is mapped and every neighborhood is
+  copied out of the neighbor section in parallel.
+  */
+  static BasicMutableGraph* fromBinaryV2(const string path, const bool symmetric_in,
+    const size_t num_threads) {
+    graph_binary::header h;
+    uint8_t *base = graph_binary::map(path,sizeof(I),symmetric_in,h);
+
+    const uint64_t *external_ids = (const uint64_t*)(base + h.id_map);
+    vector<uint64_t> *id_map = new vector<uint64_t>(external_ids,external_ids+h.num_nodes);
+    auto read_side = [&](const graph_binary::section &sec) -> vector< vector<I>* >* {
+      const uint64_t *offsets = (const uint64_t*)(base + sec.offsets);
+      const I *data = (const I*)(base + sec.data);
+      vector< vector<I>* > *neighborhoods = new vector< vector<I>* >(h.num_nodes);
+      common::par_for_range(num_threads,0,h.num_nodes,1024,
+        [&](size_t tid, size_t i){
+          (void) tid;
+          neighborhoods->at(i) = new vector<I>(data+offsets[i],data+offsets[i+1]);
+        });
+      return neighborhoods;
+    };
+    vector< vector<I>* > *out_neighborhoods = read_side(h.out);
+    vector< vector<I>* > *in_neighborhoods = symmetric_in ? out_neighborhoods : read_side(h.in);
+    munmap(base,h.file_size);
+
+    return new BasicMutableGraph(h.num_nodes,h.num_edges,h.max_nbrhood_size,symmetric_in,
+      id_map,NULL,out_neighborhoods,in_neighborhoods,NULL,NULL);
+  }
+
+  //Writes the graph in the compressed binary format (see compressed_graph).
+  void writeToCompressedBinary(const string path,
+    const size_t num_threads = edge_list::default_num_threads()) {
+    if(sizeof(I) != sizeof(uint32_t)) {fputs ("Compressed graphs need 32-bit ids",stderr); exit (4);}
+    std::cout << "Writing graph to compressed binary file..." << std::endl;
+
+    ofstream outfile;
+    outfile.open(path, ios::binary | ios::out);
+    if(!outfile.is_open()) {fputs ("File error",stderr); exit (1);}
+
+    compressed_graph::header h;
+    memset(&h,0,sizeof(h));
+    h.magic = compressed_graph::MAGIC;
+    h.version = compressed_graph::VERSION;
+    h.symmetric = symmetric;
+    h.num_nodes = num_nodes;
+    h.num_edges = num_edges;
+    h.max_nbrhood_size = max_nbrhood_size;
+
+    //The header is rewritten once all section offsets are known.
+    outfile.write((char*)&h,sizeof(h));
+    size_t position = sizeof(h);
+    const char padding[compressed_graph::ALIGNMENT] = {0};
+    h.id_map = compressed_graph::align(position);
+    outfile.write(padding,h.id_map-position);
+    outfile.write((char*)id_map->data(),sizeof(uint64_t)*num_nodes);
+    position = h.id_map + sizeof(uint64_t)*num_nodes;
+
+    compressed_graph::write_side<I>(outfile,position,h.out,out_neighborhoods,num_threads);
+    if(!symmetric)
+      compressed_graph::write_side<I>(outfile,position,h.in,in_neighborhoods,num_threads);
+    h.file_size = position;
+
+    outfile.seekp(0);
+    outfile.write((char*)&h,sizeof(h));
+    outfile.close();
+  }
+
+  //Loads a compressed binary file, its blocks are decoded in parallel.
+  static BasicMutableGraph* fromCompressedBinary(const string path, const bool symmetric_in,
+    const size_t num_threads) {
+    if(sizeof(I) != sizeof(uint32_t)) {fputs ("Compressed graphs need 32-bit ids",stderr); exit (4);}
+    compressed_graph::header h;
+    uint8_t *base = compressed_graph::map(path,symmetric_in,h);
+
+    const uint64_t *external_ids = (const uint64_t*)(base + h.id_map);
+    vector<uint64_t> *id_map = new vector<uint64_t>(external_ids,external_ids+h.num_nodes);
+    auto read_side = [&](const compressed_graph::section &sec) -> vector< vector<I>* >* {
+      vector< vector<I>* > *neighborhoods = new vector< vector<I>* >(h.num_nodes);
+      compressed_graph::decode_side<I>(base,sec,num_threads,
+        [neighborhoods](size_t i, size_t length) -> I* {
+          neighborhoods->at(i) = new vector<I>(length);
+          return neighborhoods->at(i)->data();
+        });
+      return neighborhoods;
+    };
+    vector< vector<I>* > *out_neighborhoods = read_side(h.out);
+    vector< vector<I>* > *in_neighborhoods = symmetric_in ? out_neighborhoods : read_side(h.in);
+    munmap(base,h.file_size);
+
+    return new BasicMutableGraph(h.num_nodes,h.num_edges,h.max_nbrhood_size,symmetric_in,
+      id_map,NULL,out_neighborhoods,in_neighborhoods,NULL,NULL);
+  }
+
+  //Reads both versions of the binary format and the compressed format.
+  static BasicMutableGraph* undirectedFromBinary(const string path,
+    const size_t num_threads = edge_list::default_num_threads()) {
+    if(graph_binary::is_v2(path))
+      return fromBinaryV2(path,true,num_threads);
+    if(compressed_graph::is_compressed(path))
+      return fromCompressedBinary(path,true,num_threads);
+
+    //The next part of the file is read while the current one is copied out.
+    pipelined_io::stream infile(path);
 
     vector<uint64_t> *id_map = new vector<uint64_t>();
     vector<uint32_t> *id_attributes = NULL;
-    vector< vector<uint32_t>*  > *neighborhoods = new vector< vector<uint32_t>* >();
+    vector< vector<I>*  > *neighborhoods = new vector< vector<I>* >();
     vector< vector<uint32_t>*  > *edge_attributes = NULL;
 
     size_t num_edges = 0;
@@ -327,26 +757,24 @@ struct MutableGraph {
 
     size_t max_nbrhood_size = 0;
 
-    infile.read((char *)&num_nodes, sizeof(num_nodes));
+    infile.read(&num_nodes, sizeof(num_nodes));
+    id_map->reserve(num_nodes);
+    neighborhoods->reserve(num_nodes);
     for(size_t i = 0; i < num_nodes; ++i){
-      uint64_t external_id;
-      infile.read((char *)&external_id, sizeof(uint64_t));
-      id_map->push_back(external_id);
+      id_map->push_back(infile.read<uint64_t>());
 
-      size_t row_size = 0;
-      infile.read((char *)&row_size, sizeof(row_size));
+      const size_t row_size = infile.read<size_t>();
       num_edges += row_size;
 
       if(row_size > max_nbrhood_size)
         max_nbrhood_size = row_size;
 
-      vector<uint32_t> *row = new vector<uint32_t>(row_size);
-      infile.read((char*)(row->data()), sizeof(uint32_t) * row->size());
+      vector<I> *row = new vector<I>(row_size);
+      infile.read(row->data(), sizeof(I) * row->size());
       neighborhoods->push_back(row);
     }
-    infile.close();
 
-    return new MutableGraph(
+    return new BasicMutableGraph(
         neighborhoods->size(),
         num_edges,
         max_nbrhood_size,
@@ -359,92 +787,77 @@ struct MutableGraph {
         edge_attributes);
   }
 
-  static MutableGraph* undirectedFromAttributeList(const string path, const string node_path) {
+  static BasicMutableGraph* undirectedFromAttributeList(const string path, const string node_path) {
     ////////////////////////////////////////////////////////////////////////////////////
     //Place graph into vector of vectors then decide how you want to
     //store the graph.
-    unordered_map<uint64_t,uint32_t> *extern_ids = new unordered_map<uint64_t,uint32_t>();
+    unordered_map<uint64_t,I> *extern_ids = new unordered_map<uint64_t,I>();
     vector<uint64_t> *id_map = new vector<uint64_t>();
-    vector< vector<uint32_t>*  > *neighborhoods = new vector< vector<uint32_t>* >();
+    vector< vector<I>*  > *neighborhoods = new vector< vector<I>* >();
     vector< vector<uint32_t>*  > *edge_attributes = new vector< vector<uint32_t>* >();
 
     cout << path << endl;
-    FILE *pFile = fopen(path.c_str(),"r");
-    if (pFile==NULL) {fputs ("File error",stderr); exit (1);}
-
-    // obtain file size:
-    fseek(pFile,0,SEEK_END);
-    size_t lSize = ftell(pFile);
-    rewind(pFile);
-
-    // allocate memory to contain the whole file:
-    char *buffer = (char*) malloc (sizeof(char)*lSize + 1);
-
-    neighborhoods->reserve(lSize/4);
-    extern_ids->reserve(lSize/4);
-    if (buffer == NULL) {fputs ("Memory error",stderr); exit (2);}
-
-    // copy the file into the buffer:
-    size_t result = fread (buffer,1,lSize,pFile);
-    if (result != lSize) {fputs ("Reading error",stderr); exit (3);}
-    buffer[result] = '\0';
-
-    std::set<pair<uint32_t,uint32_t>> *edge_set = new std::set<pair<uint32_t,uint32_t>>(); 
-    char *test = strtok(buffer," |\t\nA");
-    while(test != NULL){
-      uint64_t src;
-      sscanf(test,"%lu",&src);
-      test = strtok(NULL," |\t\nA");
+    //Parsing overlaps with reading, every buffer ends at a newline.
+    pipelined_io::reader in(path,true);
+
+    neighborhoods->reserve(in.file_size()/4);
+    extern_ids->reserve(in.file_size()/4);
+
+    std::set<pair<I,I>> *edge_set = new std::set<pair<I,I>>(); 
+    while(pipelined_io::buffer *b = in.next()){
+      char *test = strtok(b->data," |\t\nA");
+      while(test != NULL){
+        uint64_t src;
+        sscanf(test,"%lu",&src);
+        test = strtok(NULL," |\t\nA");
       
-      uint64_t dst;
-      sscanf(test,"%lu",&dst);
-      test = strtok(NULL," |\t\nA");
-
-      uint32_t year;
-      sscanf(test,"%u",&year);
-      test = strtok(NULL," -|\t\nA");
+        uint64_t dst;
+        sscanf(test,"%lu",&dst);
+        test = strtok(NULL," |\t\nA");
+
+        uint32_t year;
+        sscanf(test,"%u",&year);
+        test = strtok(NULL," -|\t\nA");
+
+        if(edge_set->find(make_pair(src,dst)) == edge_set->end()){
+          edge_set->insert(make_pair(src,dst));
+          edge_set->insert(make_pair(dst,src));
+
+          vector<I> *src_row;
+          vector<uint32_t> *src_attr;
+          if(extern_ids->find(src) == extern_ids->end()){
+            extern_ids->insert(make_pair(src,extern_ids->size()));
+            id_map->push_back(src);
+            src_row = new vector<I>();
+            neighborhoods->push_back(src_row);
+            src_attr = new vector<uint32_t>();
+            edge_attributes->push_back(src_attr);
+          } else{
+            src_attr = edge_attributes->at(extern_ids->at(src));
+            src_row = neighborhoods->at(extern_ids->at(src));
+          }
 
-      if(edge_set->find(make_pair(src,dst)) == edge_set->end()){
-        edge_set->insert(make_pair(src,dst));
-        edge_set->insert(make_pair(dst,src));
+          vector<I> *dst_row;
+          vector<uint32_t> *dst_attr;
+          if(extern_ids->find(dst) == extern_ids->end()){
+            extern_ids->insert(make_pair(dst,extern_ids->size()));
+            id_map->push_back(dst);
+            dst_row = new vector<I>();
+            neighborhoods->push_back(dst_row);
+            dst_attr = new vector<uint32_t>();
+            edge_attributes->push_back(dst_attr);
+          } else{
+            dst_attr = edge_attributes->at(extern_ids->at(dst));
+            dst_row = neighborhoods->at(extern_ids->at(dst));
+          }
 
-        vector<uint32_t> *src_row;
-        vector<uint32_t> *src_attr;
-        if(extern_ids->find(src) == extern_ids->end()){
-          extern_ids->insert(make_pair(src,extern_ids->size()));
-          id_map->push_back(src);
-          src_row = new vector<uint32_t>();
-          neighborhoods->push_back(src_row);
-          src_attr = new vector<uint32_t>();
-          edge_attributes->push_back(src_attr);
-        } else{
-          src_attr = edge_attributes->at(extern_ids->at(src));
-          src_row = neighborhoods->at(extern_ids->at(src));
+          src_attr->push_back(year);
+          dst_attr->push_back(year);
+          src_row->push_back(extern_ids->at(dst));
+          dst_row->push_back(extern_ids->at(src));
         }
-
-        vector<uint32_t> *dst_row;
-        vector<uint32_t> *dst_attr;
-        if(extern_ids->find(dst) == extern_ids->end()){
-          extern_ids->insert(make_pair(dst,extern_ids->size()));
-          id_map->push_back(dst);
-          dst_row = new vector<uint32_t>();
-          neighborhoods->push_back(dst_row);
-          dst_attr = new vector<uint32_t>();
-          edge_attributes->push_back(dst_attr);
-        } else{
-          dst_attr = edge_attributes->at(extern_ids->at(dst));
-          dst_row = neighborhoods->at(extern_ids->at(dst));
-        }
-
-        src_attr->push_back(year);
-        dst_attr->push_back(year);
-        src_row->push_back(extern_ids->at(dst));
-        dst_row->push_back(extern_ids->at(src));
       }
     }
-    // terminate
-    fclose(pFile);
-    free(buffer);
 
     cout << node_path << endl;
 
@@ -452,150 +865,49 @@ struct MutableGraph {
     vector<uint32_t> *id_attributes = new vector<uint32_t>();
     id_attributes->resize(neighborhoods->size()); 
 
-    FILE *pFile2 = fopen(node_path.c_str(),"r");
-    if (pFile2==NULL) {fputs ("File error",stderr); exit (1);}
-
-    // obtain file size:
-    fseek(pFile2,0,SEEK_END);
-    lSize = ftell(pFile2);
-    rewind(pFile2);
+    pipelined_io::reader in2(node_path,true);
 
-    // allocate memory to contain the whole file:
-    buffer = (char*) malloc (sizeof(char)*lSize + 1);
-    if (buffer == NULL) {fputs ("Memory error",stderr); exit (2);}
+    while(pipelined_io::buffer *b = in2.next()){
+      char *test = strtok(b->data," |\t\nA");
+      while(test != NULL){
+        uint64_t id;
+        sscanf(test,"%lu",&id);
+        test = strtok(NULL," |\t\nA");
 
-    // copy the file into the buffer:
-    result = fread (buffer,1,lSize,pFile2);
-    if (result != lSize) {fputs ("Reading error",stderr); exit (3);}
-    buffer[result] = '\0';
+        uint32_t attr;
+        sscanf(test,"%u",&attr);
+        test = strtok(NULL," |\t\nA");
 
-    test = strtok(buffer," |\t\nA");
-    while(test != NULL){
-      uint64_t id;
-      sscanf(test,"%lu",&id);
-      test = strtok(NULL," |\t\nA");
-
-      uint32_t attr;
-      sscanf(test,"%u",&attr);
-      test = strtok(NULL," |\t\nA");
-
-      if(extern_ids->find(id) != extern_ids->end()){
-        id_attributes->at(extern_ids->at(id)) = attr;
+        if(extern_ids->find(id) != extern_ids->end()){
+          id_attributes->at(extern_ids->at(id)) = attr;
+        }
       }
     }
-    // terminate
-    fclose(pFile2);
-    free(buffer);
     //////////////////////////////////////////////////////////////////////////////
 
     size_t max_nbrhood_size = 0;
-    size_t num_edges = 0;
-    for(size_t i = 0; i < neighborhoods->size(); i++){
-      vector<uint32_t> *row = neighborhoods->at(i);
-      vector<uint32_t> *row_attr = edge_attributes->at(i);
-
-      vector<pair<uint32_t,uint32_t>> *pair_list = new vector<pair<uint32_t,uint32_t>>();
-      for(size_t j = 0; j < row->size(); j++){
-        pair_list->push_back(make_pair(row->at(j),row_attr->at(j)));
-      }
-      std::sort(pair_list->begin(),pair_list->end(),OrderByID());
-      for(size_t j = 0; j < row->size(); j++){
-        row->at(j) = pair_list->at(j).first;
-        row_attr->at(j) = pair_list->at(j).second;
-      }
-      delete pair_list;
+    const size_t num_edges = neighborhood_sort::sort_attributed_neighborhoods<I>(neighborhoods,
+      edge_attributes,edge_list::default_num_threads(),max_nbrhood_size);
 
-      if(row->size() > max_nbrhood_size)
-        max_nbrhood_size = row->size();
-
-      //row->erase(unique(row->begin(),row->begin()+row->size()),row->end());
-      num_edges += row->size();
-    }
-
-    return new MutableGraph(id_map->size(),num_edges,max_nbrhood_size,true,id_map,id_attributes,neighborhoods,neighborhoods,edge_attributes,edge_attributes); 
+    return new BasicMutableGraph(id_map->size(),num_edges,max_nbrhood_size,true,id_map,id_attributes,neighborhoods,neighborhoods,edge_attributes,edge_attributes); 
   } 
-  static MutableGraph* undirectedFromEdgeList(const string path) {
-    ////////////////////////////////////////////////////////////////////////////////////
-    //Place graph into vector of vectors then decide how you want to
-    //store the graph.
-    unordered_map<uint64_t,uint32_t> *extern_ids = new unordered_map<uint64_t,uint32_t>();
+  //Parses the edge list in parallel, see edge_list_parser.hpp.
+  static BasicMutableGraph* undirectedFromEdgeList(const string path,
+    const size_t num_threads = edge_list::default_num_threads()) {
     vector<uint64_t> *id_map = new vector<uint64_t>();
     vector<uint32_t> *id_attributes = NULL;
-    vector< vector<uint32_t>*  > *neighborhoods = new vector< vector<uint32_t>* >();
     vector< vector<uint32_t>*  > *edge_attributes = NULL;
 
     cout << path << endl;
-    FILE *pFile = fopen(path.c_str(),"r");
-    if (pFile==NULL) {fputs ("File error",stderr); exit (1);}
-
-    // obtain file size:
-    fseek(pFile,0,SEEK_END);
-    size_t lSize = ftell(pFile);
-    rewind(pFile);
-
-    // allocate memory to contain the whole file:
-    char *buffer = (char*)malloc(sizeof(char) * lSize + 1);
-    neighborhoods->reserve(lSize/4);
-    extern_ids->reserve(lSize/4);
-    if (buffer == NULL) {fputs ("Memory error",stderr); exit (2);}
-
-    // copy the file into the buffer:
-    size_t result = fread (buffer,1,lSize,pFile);
-    if (result != lSize) {fputs ("Reading error",stderr); exit (3);}
-    buffer[result] = '\0';
-
-    char *test = strtok(buffer," \t\nA");
-    while(test != NULL){
-      uint64_t src;
-      sscanf(test,"%lu",&src);
-      test = strtok(NULL," \t\nA");
-      
-      uint64_t dst;
-      sscanf(test,"%lu",&dst);
-      test = strtok(NULL," \t\nA");
-
-      vector<uint32_t> *src_row;
-      if(extern_ids->find(src) == extern_ids->end()){
-        extern_ids->insert(make_pair(src,extern_ids->size()));
-        id_map->push_back(src);
-        src_row = new vector<uint32_t>();
-        neighborhoods->push_back(src_row);
-      } else{
-        src_row = neighborhoods->at(extern_ids->at(src));
-      }
-
-      vector<uint32_t> *dst_row;
-      if(extern_ids->find(dst) == extern_ids->end()){
-        extern_ids->insert(make_pair(dst,extern_ids->size()));
-        id_map->push_back(dst);
-        dst_row = new vector<uint32_t>();
-        neighborhoods->push_back(dst_row);
-      } else{
-        dst_row = neighborhoods->at(extern_ids->at(dst));
-      }
-
-      src_row->push_back(extern_ids->at(dst));
-      dst_row->push_back(extern_ids->at(src));
-    }
-    // terminate
-    fclose(pFile);
-    free(buffer);
+    vector<edge_list::chunk> *chunks = edge_list::parse<I>(path,num_threads,id_map);
+    vector< vector<I>*  > *neighborhoods = edge_list::new_neighborhoods<I>(id_map->size());
+    edge_list::fill_neighborhoods<I>(*chunks,num_threads,neighborhoods,neighborhoods);
+    delete chunks;
 
     size_t max_nbrhood_size = 0;
-    size_t num_edges = 0;
-    for(size_t i = 0; i < neighborhoods->size(); i++){
-      vector<uint32_t> *row = neighborhoods->at(i);
-      std::sort(row->begin(),row->end());
-
-      if(row->size() > max_nbrhood_size)
-        max_nbrhood_size = row->size();
+    const size_t num_edges = neighborhood_sort::sort_neighborhoods<I>(neighborhoods,num_threads,max_nbrhood_size);
 
-      row->erase(unique(row->begin(),row->begin()+row->size()),row->end());
-      num_edges += row->size();
-    }
-
-    delete extern_ids;
-    return new MutableGraph(neighborhoods->size(),num_edges,max_nbrhood_size,true,id_map,id_attributes,neighborhoods,neighborhoods,edge_attributes,edge_attributes); 
+    return new BasicMutableGraph(neighborhoods->size(),num_edges,max_nbrhood_size,true,id_map,id_attributes,neighborhoods,neighborhoods,edge_attributes,edge_attributes); 
   }
 
   void writeDirectedToLigra(const string path) {
@@ -608,7 +920,7 @@ struct MutableGraph {
     size_t numedges = 0;
     for(size_t i = 0; i < num_nodes; ++i){
       /////////////////////////////////////////////////////////////////////
-      vector<uint32_t> *row = out_neighborhoods->at(i);
+      vector<I> *row = out_neighborhoods->at(i);
       numedges += row->size();
     }
     myfile << numedges << endl;
@@ -619,12 +931,12 @@ struct MutableGraph {
       myfile << index << endl;
 
       /////////////////////////////////////////////////////////////////////
-      vector<uint32_t> *row = out_neighborhoods->at(i);
+      vector<I> *row = out_neighborhoods->at(i);
       size_t rsize = row->size();
       index += rsize;
     }
     for(size_t i = 0; i < num_nodes; ++i){
-      vector<uint32_t> *row = out_neighborhoods->at(i);
+      vector<I> *row = out_neighborhoods->at(i);
       size_t rsize = row->size();
       for(size_t j = 0; j < rsize; j++){
         myfile << row->at(j) << endl;
@@ -642,76 +954,75 @@ struct MutableGraph {
       outfile.write((char*)&id_map->at(i),sizeof(uint64_t));
 
       /////////////////////////////////////////////////////////////////////
-      vector<uint32_t> *row = out_neighborhoods->at(i);
+      vector<I> *row = out_neighborhoods->at(i);
       size_t rsize = row->size();
       outfile.write((char *)&rsize, sizeof(rsize)); 
-      outfile.write((char *)row->data(),sizeof(uint32_t)*rsize);
+      outfile.write((char *)row->data(),sizeof(I)*rsize);
 
       /////////////////////////////////////////////////////////////////////
-      vector<uint32_t> *col = in_neighborhoods->at(i);
+      vector<I> *col = in_neighborhoods->at(i);
       size_t csize = col->size();
       outfile.write((char *)&csize, sizeof(csize)); 
-      outfile.write((char *)col->data(),sizeof(uint32_t)*csize);
+      outfile.write((char *)col->data(),sizeof(I)*csize);
     }
     outfile.close();
   }
-  static MutableGraph* directedFromBinary(const string path) {
-    ifstream infile; 
-    infile.open(path, ios::binary | ios::in); 
+  //Reads both versions of the binary format and the compressed format.
+  static BasicMutableGraph* directedFromBinary(const string path,
+    const size_t num_threads = edge_list::default_num_threads()) {
+    if(graph_binary::is_v2(path))
+      return fromBinaryV2(path,false,num_threads);
+    if(compressed_graph::is_compressed(path))
+      return fromCompressedBinary(path,false,num_threads);
+
+    //The next part of the file is read while the current one is copied out.
+    pipelined_io::stream infile(path);
 
     vector<uint64_t> *id_map = new vector<uint64_t>();
-    vector< vector<uint32_t>*  > *out_neighborhoods = new vector< vector<uint32_t>* >();
-    vector< vector<uint32_t>*  > *in_neighborhoods = new vector< vector<uint32_t>* >();
+    vector< vector<I>*  > *out_neighborhoods = new vector< vector<I>* >();
+    vector< vector<I>*  > *in_neighborhoods = new vector< vector<I>* >();
     vector< vector<uint32_t>*  > *edge_attributes = NULL;
     vector<uint32_t> *id_attributes = NULL;
 
     size_t num_edges = 0;
     size_t num_nodes = 0;
-    infile.read((char *)&num_nodes, sizeof(num_nodes)); 
+    infile.read(&num_nodes, sizeof(num_nodes));
 
     size_t max_nbrhood_size = 0;
 
     cout << "num nodes: " << num_nodes << endl;
+    id_map->reserve(num_nodes);
+    out_neighborhoods->reserve(num_nodes);
+    in_neighborhoods->reserve(num_nodes);
     for(size_t i = 0; i < num_nodes; ++i){
-      uint64_t external_id;
-      infile.read((char *)&external_id, sizeof(uint64_t)); 
-      id_map->push_back(external_id);
+      id_map->push_back(infile.read<uint64_t>());
 
       //////////////////////////////////////////////////////////////////// 
-      size_t row_size = 0;
-      infile.read((char *)&row_size, sizeof(row_size)); 
+      const size_t row_size = infile.read<size_t>();
       num_edges += row_size;
 
       if(row_size > max_nbrhood_size)
         max_nbrhood_size = row_size;
 
-      vector<uint32_t> *row = new vector<uint32_t>();
-      row->reserve(row_size);
-      uint32_t *r_tmp_data = new uint32_t[row_size];
-      infile.read((char *)&r_tmp_data[0], sizeof(uint32_t)*row_size); 
-      row->assign(&r_tmp_data[0],&r_tmp_data[row_size]);
+      vector<I> *row = new vector<I>(row_size);
+      infile.read(row->data(), sizeof(I)*row_size);
       out_neighborhoods->push_back(row);
 
       ////////////////////////////////////////////////////////////////////
-      size_t col_size = 0;
-      infile.read((char *)&col_size, sizeof(col_size)); 
+      const size_t col_size = infile.read<size_t>();
       num_edges += col_size;
 
       if(col_size > max_nbrhood_size)
         max_nbrhood_size = col_size;
 
-      vector<uint32_t> *col = new vector<uint32_t>();
-      col->reserve(col_size);
-      uint32_t *c_tmp_data = new uint32_t[col_size];
-      infile.read((char *)&c_tmp_data[0], sizeof(uint32_t)*col_size); 
-      col->assign(&c_tmp_data[0],&c_tmp_data[col_size]);
+      vector<I> *col = new vector<I>(col_size);
+      infile.read(col->data(), sizeof(I)*col_size);
       in_neighborhoods->push_back(col);
     }
-    infile.close();
 
     std::cout << "Number of edges in file: " << num_edges << std::endl;
 
-    return new MutableGraph(out_neighborhoods->size(),num_edges,max_nbrhood_size,false,id_map,id_attributes,out_neighborhoods,in_neighborhoods,edge_attributes,edge_attributes); 
+    return new BasicMutableGraph(out_neighborhoods->size(),num_edges,max_nbrhood_size,false,id_map,id_attributes,out_neighborhoods,in_neighborhoods,edge_attributes,edge_attributes); 
   } 
   /*
   File format
@@ -721,271 +1032,133 @@ struct MutableGraph {
   ...
 
   */
-  static MutableGraph* directedFromAttributeList(const string path, const string node_path) {  
+  static BasicMutableGraph* directedFromAttributeList(const string path, const string node_path) {  
     //Place graph into vector of vectors then decide how you want to
     //store the graph.
     size_t num_edges = 0;
 
     vector<uint64_t> *id_map = new vector<uint64_t>();
-    unordered_map<uint64_t,uint32_t> *extern_ids = new unordered_map<uint64_t,uint32_t>();
-    vector< vector<uint32_t>*  > *in_neighborhoods = new vector< vector<uint32_t>* >();
-    vector< vector<uint32_t>*  > *out_neighborhoods = new vector< vector<uint32_t>* >();
+    unordered_map<uint64_t,I> *extern_ids = new unordered_map<uint64_t,I>();
+    vector< vector<I>*  > *in_neighborhoods = new vector< vector<I>* >();
+    vector< vector<I>*  > *out_neighborhoods = new vector< vector<I>* >();
     vector< vector<uint32_t>*  > *out_edge_attributes = new vector< vector<uint32_t>* >();
     vector< vector<uint32_t>*  > *in_edge_attributes = new vector< vector<uint32_t>* >();
 
-    FILE *pFile = fopen(path.c_str(),"r");
-    if (pFile==NULL) {fputs ("File error",stderr); exit (1);}
+    //Parsing overlaps with reading, every buffer ends at a newline.
+    pipelined_io::reader in(path,true);
 
-    // obtain file size:
-    fseek(pFile,0,SEEK_END);
-    size_t lSize = ftell(pFile);
-    rewind(pFile);
-
-    // allocate memory to contain the whole file:
-    char *buffer = (char*) malloc (sizeof(char)*lSize + 1);
-    if (buffer == NULL) {fputs ("Memory error",stderr); exit (2);}
-
-    // copy the file into the buffer:
-    size_t result = fread (buffer,1,lSize,pFile);
-    if (result != lSize) {fputs ("Reading error",stderr); exit (3);}
-    buffer[result] = '\0';
-
-    char *test = strtok(buffer," \t\nA");
-    while(test != NULL){
-      uint64_t src;
-      sscanf(test,"%lu",&src);
-      test = strtok(NULL," \t\nA");
+    while(pipelined_io::buffer *b = in.next()){
+      char *test = strtok(b->data," \t\nA");
+      while(test != NULL){
+        uint64_t src;
+        sscanf(test,"%lu",&src);
+        test = strtok(NULL," \t\nA");
       
-      uint64_t dst;
-      sscanf(test,"%lu",&dst);
-      test = strtok(NULL," \t\nA");
-
-      uint32_t year;
-      sscanf(test,"%u",&year);
-      test = strtok(NULL," -|\t\nA");
-
-      num_edges++;
-
-      vector<uint32_t> *src_row;
-      vector<uint32_t> *src_attr;
-      if(extern_ids->find(src) == extern_ids->end()){
-        extern_ids->insert(make_pair(src,extern_ids->size()));
-        id_map->push_back(src);
-        src_row = new vector<uint32_t>();
-        vector<uint32_t> *new_row = new vector<uint32_t>();
-        in_neighborhoods->push_back(new_row);
-        out_neighborhoods->push_back(src_row);
-        src_attr = new vector<uint32_t>();
-        out_edge_attributes->push_back(src_attr);
-        in_edge_attributes->push_back(new vector<uint32_t>());
-      } else{
-        src_attr = out_edge_attributes->at(extern_ids->at(src));
-        src_row = out_neighborhoods->at(extern_ids->at(src));
-      }
+        uint64_t dst;
+        sscanf(test,"%lu",&dst);
+        test = strtok(NULL," \t\nA");
 
-      vector<uint32_t> *dst_row;
-      vector<uint32_t> *dst_attr;
-      if(extern_ids->find(dst) == extern_ids->end()){
-        extern_ids->insert(make_pair(dst,extern_ids->size()));
-        id_map->push_back(dst);
-        dst_row = new vector<uint32_t>();
-        out_neighborhoods->push_back(new vector<uint32_t>());
-        in_neighborhoods->push_back(dst_row);
-        dst_attr = new vector<uint32_t>();
-        in_edge_attributes->push_back(dst_attr);
-        out_edge_attributes->push_back(new vector<uint32_t>());
-      } else{
-        dst_row = in_neighborhoods->at(extern_ids->at(dst));
-        dst_attr = in_edge_attributes->at(extern_ids->at(dst));
+        uint32_t year;
+        sscanf(test,"%u",&year);
+        test = strtok(NULL," -|\t\nA");
+
+        num_edges++;
+
+        vector<I> *src_row;
+        vector<uint32_t> *src_attr;
+        if(extern_ids->find(src) == extern_ids->end()){
+          extern_ids->insert(make_pair(src,extern_ids->size()));
+          id_map->push_back(src);
+          src_row = new vector<I>();
+          vector<I> *new_row = new vector<I>();
+          in_neighborhoods->push_back(new_row);
+          out_neighborhoods->push_back(src_row);
+          src_attr = new vector<uint32_t>();
+          out_edge_attributes->push_back(src_attr);
+          in_edge_attributes->push_back(new vector<uint32_t>());
+        } else{
+          src_attr = out_edge_attributes->at(extern_ids->at(src));
+          src_row = out_neighborhoods->at(extern_ids->at(src));
+        }
+
+        vector<I> *dst_row;
+        vector<uint32_t> *dst_attr;
+        if(extern_ids->find(dst) == extern_ids->end()){
+          extern_ids->insert(make_pair(dst,extern_ids->size()));
+          id_map->push_back(dst);
+          dst_row = new vector<I>();
+          out_neighborhoods->push_back(new vector<I>());
+          in_neighborhoods->push_back(dst_row);
+          dst_attr = new vector<uint32_t>();
+          in_edge_attributes->push_back(dst_attr);
+          out_edge_attributes->push_back(new vector<uint32_t>());
+        } else{
+          dst_row = in_neighborhoods->at(extern_ids->at(dst));
+          dst_attr = in_edge_attributes->at(extern_ids->at(dst));
+        }
+        src_row->push_back(extern_ids->at(dst));
+        src_attr->push_back(year);
+        dst_row->push_back(extern_ids->at(src));
+        dst_attr->push_back(year);
       }
-      src_row->push_back(extern_ids->at(dst));
-      src_attr->push_back(year);
-      dst_row->push_back(extern_ids->at(src));
-      dst_attr->push_back(year);
     }
-    // terminate
-    fclose(pFile);
-    free(buffer);
 
     //////////////////////////////////////////////////////////////////////////////
     vector<uint32_t> *id_attributes = new vector<uint32_t>();
     id_attributes->resize(in_neighborhoods->size()); 
 
-    FILE *pFile2 = fopen(node_path.c_str(),"r");
-    if (pFile2==NULL) {fputs ("File error",stderr); exit (1);}
+    pipelined_io::reader in2(node_path,true);
 
-    // obtain file size:
-    fseek(pFile2,0,SEEK_END);
-    lSize = ftell(pFile2);
-    rewind(pFile2);
+    while(pipelined_io::buffer *b = in2.next()){
+      char *test = strtok(b->data," |\t\nA");
+      while(test != NULL){
+        uint64_t id;
+        sscanf(test,"%lu",&id);
+        test = strtok(NULL," |\t\nA");
 
-    // allocate memory to contain the whole file:
-    buffer = (char*) malloc (sizeof(char)*lSize + 1);
-    if (buffer == NULL) {fputs ("Memory error",stderr); exit (2);}
+        uint32_t attr;
+        sscanf(test,"%u",&attr);
+        test = strtok(NULL," |\t\nA");
 
-    // copy the file into the buffer:
-    result = fread (buffer,1,lSize,pFile2);
-    if (result != lSize) {fputs ("Reading error",stderr); exit (3);}
-    buffer[result] = '\0';
-
-    test = strtok(buffer," |\t\nA");
-    while(test != NULL){
-      uint64_t id;
-      sscanf(test,"%lu",&id);
-      test = strtok(NULL," |\t\nA");
-
-      uint32_t attr;
-      sscanf(test,"%u",&attr);
-      test = strtok(NULL," |\t\nA");
-
-      if(extern_ids->find(id) != extern_ids->end()){
-        id_attributes->at(extern_ids->at(id)) = attr;
+        if(extern_ids->find(id) != extern_ids->end()){
+          id_attributes->at(extern_ids->at(id)) = attr;
+        }
       }
     }
-    // terminate
-    fclose(pFile2);
-    free(buffer);
     //////////////////////////////////////////////////////////////////////////////
     size_t max_nbrhood_size = 0;
-    for(size_t i = 0; i < in_neighborhoods->size(); i++){
-      vector<uint32_t> *row = out_neighborhoods->at(i);
-      vector<uint32_t> *row_attr = out_edge_attributes->at(i);
-
-      if(row->size() > 0){
-        vector<pair<uint32_t,uint32_t>> *pair_list = new vector<pair<uint32_t,uint32_t>>();
-        for(size_t j = 0; j < row->size(); j++){
-          pair_list->push_back(make_pair(row->at(j),row_attr->at(j)));
-        }
-        std::sort(pair_list->begin(),pair_list->end(),OrderByID());
-        for(size_t j = 0; j < row->size(); j++){
-          row->at(j) = pair_list->at(j).first;
-          row_attr->at(j) = pair_list->at(j).second;
-        }
-        delete pair_list;
-
-        if(row->size() > max_nbrhood_size)
-          max_nbrhood_size = row->size();
-      }
-
-      row = in_neighborhoods->at(i);
-      row_attr = in_edge_attributes->at(i);
-      if(row->size() > 0){
-        vector<pair<uint32_t,uint32_t>> *pair_list = new vector<pair<uint32_t,uint32_t>>();
-        for(size_t j = 0; j < row->size(); j++){
-          pair_list->push_back(make_pair(row->at(j),row_attr->at(j)));
-        }
-        std::sort(pair_list->begin(),pair_list->end(),OrderByID());
-        for(size_t j = 0; j < row->size(); j++){
-          row->at(j) = pair_list->at(j).first;
-          row_attr->at(j) = pair_list->at(j).second;
-        }
-        delete pair_list;
-
-        if(row->size() > max_nbrhood_size)
-          max_nbrhood_size = row->size();
-      }
-      //row->erase(unique(row->begin(),row->begin()+row->size()),row->end());
-    }
+    const size_t num_threads = edge_list::default_num_threads();
+    neighborhood_sort::sort_attributed_neighborhoods<I>(out_neighborhoods,out_edge_attributes,
+      num_threads,max_nbrhood_size);
+    neighborhood_sort::sort_attributed_neighborhoods<I>(in_neighborhoods,in_edge_attributes,
+      num_threads,max_nbrhood_size);
 
     delete extern_ids;
-    return new MutableGraph(in_neighborhoods->size(),num_edges,max_nbrhood_size,false,id_map,id_attributes,out_neighborhoods,in_neighborhoods,out_edge_attributes,in_edge_attributes); 
+    return new BasicMutableGraph(in_neighborhoods->size(),num_edges,max_nbrhood_size,false,id_map,id_attributes,out_neighborhoods,in_neighborhoods,out_edge_attributes,in_edge_attributes); 
   }
-  static MutableGraph* directedFromEdgeList(const string path) {  
-    //Place graph into vector of vectors then decide how you want to
-    //store the graph.
-    size_t num_edges = 0;
-
+  //Parses the edge list in parallel, see edge_list_parser.hpp.
+  static BasicMutableGraph* directedFromEdgeList(const string path,
+    const size_t num_threads = edge_list::default_num_threads()) {
     vector<uint64_t> *id_map = new vector<uint64_t>();
-    unordered_map<uint64_t,uint32_t> *extern_ids = new unordered_map<uint64_t,uint32_t>();
-    vector< vector<uint32_t>*  > *in_neighborhoods = new vector< vector<uint32_t>* >();
-    vector< vector<uint32_t>*  > *out_neighborhoods = new vector< vector<uint32_t>* >();
     vector<uint32_t> *id_attributes = NULL;
     vector< vector<uint32_t>*  > *edge_attributes = NULL;
 
-    FILE *pFile = fopen(path.c_str(),"r");
-    if (pFile==NULL) {fputs ("File error",stderr); exit (1);}
-
-    // obtain file size:
-    fseek(pFile,0,SEEK_END);
-    size_t lSize = ftell(pFile);
-    rewind(pFile);
-
-    // allocate memory to contain the whole file:
-    char *buffer = (char*) malloc (sizeof(char)*lSize + 1);
-    if (buffer == NULL) {fputs ("Memory error",stderr); exit (2);}
-
-    // copy the file into the buffer:
-    size_t result = fread (buffer,1,lSize,pFile);
-    if (result != lSize) {fputs ("Reading error",stderr); exit (3);}
-    buffer[result] = '\0';
-
-    char *test = strtok(buffer," \t\nA");
-    while(test != NULL){
-      uint64_t src;
-      sscanf(test,"%lu",&src);
-      test = strtok(NULL," \t\nA");
-      
-      uint64_t dst;
-      sscanf(test,"%lu",&dst);
-      test = strtok(NULL," \t\nA");
-
-      num_edges++;
-
-      vector<uint32_t> *src_row;
-      if(extern_ids->find(src) == extern_ids->end()){
-        extern_ids->insert(make_pair(src,extern_ids->size()));
-        id_map->push_back(src);
-        src_row = new vector<uint32_t>();
-        vector<uint32_t> *new_row = new vector<uint32_t>();
-        in_neighborhoods->push_back(new_row);
-        out_neighborhoods->push_back(src_row);
-      } else{
-        src_row = out_neighborhoods->at(extern_ids->at(src));
-      }
-
-      vector<uint32_t> *dst_row;
-      if(extern_ids->find(dst) == extern_ids->end()){
-        extern_ids->insert(make_pair(dst,extern_ids->size()));
-        id_map->push_back(dst);
-        dst_row = new vector<uint32_t>();
-        vector<uint32_t> *new_row = new vector<uint32_t>();
-        out_neighborhoods->push_back(new_row);
-        in_neighborhoods->push_back(dst_row);
-      } else{
-        dst_row = in_neighborhoods->at(extern_ids->at(dst));
-      }
-      src_row->push_back(extern_ids->at(dst));
-      dst_row->push_back(extern_ids->at(src));
-    }
-    // terminate
-    fclose(pFile);
-    free(buffer);
+    vector<edge_list::chunk> *chunks = edge_list::parse<I>(path,num_threads,id_map);
+    const size_t num_edges = edge_list::num_edges(*chunks);
+    vector< vector<I>*  > *in_neighborhoods = edge_list::new_neighborhoods<I>(id_map->size());
+    vector< vector<I>*  > *out_neighborhoods = edge_list::new_neighborhoods<I>(id_map->size());
+    edge_list::fill_neighborhoods<I>(*chunks,num_threads,out_neighborhoods,in_neighborhoods);
+    delete chunks;
 
     size_t max_nbrhood_size = 0;
-    for(size_t i = 0; i < in_neighborhoods->size(); i++){
-      vector<uint32_t> *row = in_neighborhoods->at(i);
-      std::sort(row->begin(),row->end());
-
-      if(row->size() > max_nbrhood_size)
-        max_nbrhood_size = row->size();
-
-      row->erase(unique(row->begin(),row->begin()+row->size()),row->end());
-    }
-    for(size_t i = 0; i < out_neighborhoods->size(); i++){
-      vector<uint32_t> *row = out_neighborhoods->at(i);
-      std::sort(row->begin(),row->end());
-
-      if(row->size() > max_nbrhood_size)
-        max_nbrhood_size = row->size();
-
-      row->erase(unique(row->begin(),row->begin()+row->size()),row->end());
-    }
+    neighborhood_sort::sort_neighborhoods<I>(in_neighborhoods,num_threads,max_nbrhood_size);
+    neighborhood_sort::sort_neighborhoods<I>(out_neighborhoods,num_threads,max_nbrhood_size);
 
-    delete extern_ids;
-    return new MutableGraph(in_neighborhoods->size(),num_edges,max_nbrhood_size,false,id_map,id_attributes,out_neighborhoods,in_neighborhoods,edge_attributes,edge_attributes); 
+    return new BasicMutableGraph(in_neighborhoods->size(),num_edges,max_nbrhood_size,false,id_map,id_attributes,out_neighborhoods,in_neighborhoods,edge_attributes,edge_attributes); 
   }
 
-
 };
 
+typedef BasicMutableGraph<uint32_t> MutableGraph;
+
 #endif
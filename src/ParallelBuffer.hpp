@@ -8,11 +8,12 @@ class ParallelBuffer{
     size_t size;
     T **data;
 
+    //Buffers come from the slab allocator so that passes and builds reuse them.
     void allocate(size_t tid){
-      data[tid] = new T[size];
+      data[tid] = (T*) slab::allocate(sizeof(T)*size);
     }
     void unallocate(size_t tid){
-      delete[] data[tid];
+      slab::release(data[tid]);
     }
 
     ParallelBuffer(size_t num_threads_in, size_t size_in){
@@ -15,15 +15,30 @@ class Parser{
     long start_node;
     MutableGraph *input_graph;
     string layout;
+    string snapshot_path;
+    //What the matrix is built from, checked against an existing snapshot.
+    snapshot::source snapshot_source;
+
+    //Set when the binary input is streamed into the matrix instead of being
+    //loaded into input_graph.
+    string stream_path;
+    bool stream_symmetric;
+
+    common::orientation orientation;
 
     Parser(int num_threads_in, bool attributes_in,
-      int n_in, size_t start_node_in, MutableGraph *in_graph, string layout_in){
+      int n_in, size_t start_node_in, MutableGraph *in_graph, string layout_in,
+      string snapshot_path_in = ""){
       num_threads = num_threads_in;
       attributes = attributes_in;
       n = n_in;
       start_node = start_node_in;
       input_graph = in_graph;
       layout = layout_in;
+      snapshot_path = snapshot_path_in;
+      memset(&snapshot_source,0,sizeof(snapshot_source));
+      stream_symmetric = true;
+      orientation = common::ID_ORDER;
     }
 };
 
@@ -36,7 +51,14 @@ namespace input_parser {
     cout << "USAGE: ./application <OPTIONS>" << endl;
     cout << "OPTIONS: " << endl;
     cout <<"\tREQUIRED: --graph=<path to graph> --input_type=<\'binary\' or \'text\'> --t=<# of threads>" << endl;
-    cout << "\t\t--layout=<uint,pshort,bs,v,bp,hybrid>" << endl;
+    cout << "\t\t--layout=<uint,pshort,bs,v,bp,hybrid,roaring,runs,bitset_new>" << endl;
+    cout << "\tOPTIONAL: --snapshot=<path> maps the built matrix from path if it exists, otherwise writes it there" << endl;
+    cout << "\t\t(a snapshot is only mapped by the application, layout, orientation and ordering that wrote it, for the same graph)" << endl;
+    cout << "\tOPTIONAL: --orientation=<degree,degeneracy> orients pruned undirected graphs by that order instead of by id" << endl;
+    cout << "\tOPTIONAL: --ordering=<bfs,strong_run,random,shingles,degree,rev_degree,rcm,gorder,rabbit,the_game> relabels the graph" << endl;
+    cout << "\t\tby that ordering, which is cached next to the graph file and reused while the graph is unchanged" << endl;
+    cout << "\tOPTIONAL: --stream packs a binary input straight into the matrix without building the graph in memory" << endl;
+    cout << "\tOPTIONAL: --numa partitions the matrix across NUMA nodes and pins the worker threads" << endl;
     if(app.compare("n_path") == 0){
       cout << "\tOPTIONAL: --start_node=<start node, default is higest degree> --n=<path length, default finds all paths> --asymmetric" << endl;
       cout << "*takes a directed graph as input*" << endl;
@@ -52,6 +74,10 @@ namespace input_parser {
     char* attribute_path = NULL;
     char* input_type = NULL;
     char* layout_type = NULL;
+    char* snapshot_path = NULL;
+    char* ordering = NULL;
+    bool stream = false;
+    common::orientation orientation = common::ID_ORDER;
     int num_threads = 0;
     int n = -1;
     long start_node = -1;
@@ -72,12 +98,17 @@ namespace input_parser {
           {"start_node",required_argument,0,'s'},
           {"input_type",  required_argument, 0, 'f'},
           {"asymmetric",  optional_argument, 0, 'm'},
+          {"snapshot",  required_argument, 0, 'p'},
+          {"numa",  no_argument, 0, 'u'},
+          {"stream",  no_argument, 0, 'r'},
+          {"orientation",  required_argument, 0, 'o'},
+          {"ordering",  required_argument, 0, 'd'},
           {0, 0, 0, 0}
         };
       /* getopt_long stores the option index here. */
       int option_index = 0;
 
-      c = getopt_long (argc, argv, "a:t:g:n:f:s:h:l",long_options, &option_index);
+      c = getopt_long (argc, argv, "a:t:g:n:f:s:h:lp:o:d:",long_options, &option_index);
 
       /* Detect the end of the options. */
       if (c == -1)
@@ -120,6 +151,27 @@ namespace input_parser {
         case 'm':
           g_type = common::DIRECTED;
           break;
+        case 'p':
+          snapshot_path = optarg;
+          break;
+        case 'u':
+          numa_helper::init();
+          break;
+        case 'r':
+          stream = true;
+          break;
+        case 'o':
+          if(string(optarg).compare("degree") == 0){
+            orientation = common::DEGREE_ORDER;
+          } else if(string(optarg).compare("degeneracy") == 0){
+            orientation = common::DEGENERACY_ORDER;
+          } else{
+            help = true;
+          }
+          break;
+        case 'd':
+          ordering = optarg;
+          break;
         case '?':
           /* getopt_long already printed an error message. */
           break;
@@ -128,7 +180,16 @@ namespace input_parser {
           abort ();
         }
     }
-    if(num_threads == 0 || graph_path == NULL || input_type == NULL || help || layout_type == NULL){
+    //An existing snapshot replaces loading the input graph. The graph is
+    //still required, the snapshot must have been built from it.
+    const bool from_snapshot = snapshot_path != NULL && snapshot::exists(snapshot_path);
+    if(num_threads == 0 || help || layout_type == NULL || graph_path == NULL || input_type == NULL){
+      printUsage(app);
+    }
+    //Only binary inputs without attributes can be streamed, and orientations
+    //and orderings need the whole graph up front.
+    if(stream && !from_snapshot && (attribute_path != NULL || string(input_type).compare("binary") != 0 ||
+      orientation != common::ID_ORDER || ordering != NULL)){
       printUsage(app);
     }
 
@@ -141,9 +202,16 @@ namespace input_parser {
     }
 
     std::cout << "VECTORIZE = " << VECTORIZE << std::endl;
+    std::cout << "Set kernels = " << ops::kernels.name << std::endl;
 
-    MutableGraph *inputGraph;
-    if(g_type == common::DIRECTED) {
+    MutableGraph *inputGraph = NULL;
+    if(from_snapshot) {
+      cout << "Using snapshot " << snapshot_path << endl;
+    }
+    else if(stream) {
+      cout << "Streaming graph " << graph_path << endl;
+    }
+    else if(g_type == common::DIRECTED) {
       cout << "Loading a directed graph" << endl;
       if(attribute_path != NULL) {
         #ifndef ATTRIBUTES
@@ -153,10 +221,10 @@ namespace input_parser {
       }
       else {
         if(string(input_type).compare("text") == 0) {
-          inputGraph = MutableGraph::directedFromEdgeList(graph_path);
+          inputGraph = MutableGraph::directedFromEdgeList(graph_path,num_threads);
         }
         else {
-          inputGraph = MutableGraph::directedFromBinary(graph_path);
+          inputGraph = MutableGraph::directedFromBinary(graph_path,num_threads);
         }
       }
     }
@@ -169,13 +237,33 @@ namespace input_parser {
         inputGraph = MutableGraph::undirectedFromAttributeList(graph_path,attribute_path);
       } else {
         if(string(input_type).compare("text") == 0) {
-          inputGraph = MutableGraph::undirectedFromEdgeList(graph_path);
+          inputGraph = MutableGraph::undirectedFromEdgeList(graph_path,num_threads);
         } else {
-          inputGraph = MutableGraph::undirectedFromBinary(graph_path);
+          inputGraph = MutableGraph::undirectedFromBinary(graph_path,num_threads);
         }
       }
     }
 
-    return Parser(num_threads,attribute_path!=NULL,n,start_node,inputGraph,layout_type);
+    if(inputGraph != NULL && ordering != NULL){
+      const double ordering_time = common::startClock();
+      inputGraph->reorder_cached(ordering,graph_path,num_threads);
+      common::stopClock("Ordering " + string(ordering),ordering_time);
+    }
+
+    Parser input_data(num_threads,attribute_path!=NULL,n,start_node,inputGraph,layout_type,
+      (snapshot_path != NULL) ? snapshot_path : "");
+    input_data.orientation = orientation;
+    if(snapshot_path != NULL){
+      uint64_t graph_hash = snapshot::file_hash(graph_path);
+      if(attribute_path != NULL)
+        graph_hash = ordering_cache::mix(graph_hash ^ snapshot::file_hash(attribute_path));
+      input_data.snapshot_source = snapshot::make_source(app,(ordering != NULL) ? ordering : "",
+        orientation,g_type,graph_hash);
+    }
+    if(stream && !from_snapshot){
+      input_data.stream_path = graph_path;
+      input_data.stream_symmetric = (g_type == common::UNDIRECTED);
+    }
+    return input_data;
   }
 }
@@ -8,7 +8,129 @@
 #include "set/ops.hpp"
 #include "ParallelBuffer.hpp"
 
-template<class T,class R>
+/*
+On-disk snapshot of a fully built SparseMatrix. The file is laid out so that
+it can be mmap'd read-only and handed straight to get_row/get_column:
+
+  header | row lengths | row offsets | row ranges | row bytes |
+  (asymmetric only) column lengths | column offsets | column ranges | column bytes |
+  id map | node attributes
+
+Every section starts on a SNAPSHOT_ALIGNMENT boundary. Offsets are uint64_t
+byte offsets into the row (column) byte section, one per row plus a sentinel.
+Lengths and ranges are index_bytes wide, the width of the matrix's index type.
+
+The header also records what the matrix was built from: the application,
+whose node and edge selection it holds, the orientation, the ordering, the
+graph type and a hash of the source graph files. A snapshot is only mapped
+by a run that matches all of them.
+*/
+namespace snapshot {
+  static const uint64_t MAGIC = 0x315041534d534845ULL; // "EHSMSAP1"
+  static const uint32_t VERSION = 3;
+  static const size_t SNAPSHOT_ALIGNMENT = 64;
+  static const size_t MAX_NAME_LENGTH = 32;
+
+  struct section{
+    uint64_t lengths;
+    uint64_t offsets;
+    uint64_t ranges;
+    uint64_t data;
+    uint64_t total_bytes;
+  };
+
+  struct source{
+    char app[MAX_NAME_LENGTH];
+    char ordering[MAX_NAME_LENGTH];
+    uint32_t orientation;
+    uint32_t graph_type;
+    uint64_t graph_hash;
+  };
+
+  struct header{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t layout;
+    uint64_t matrix_size;
+    uint64_t cardinality;
+    uint64_t max_nbrhood_size;
+    uint32_t symmetric;
+    uint32_t has_ranges;
+    uint32_t index_bytes;
+    uint32_t reserved;
+    section row;
+    section column;
+    uint64_t id_map;
+    uint64_t node_attributes;
+    uint64_t file_size;
+    source built_from;
+  };
+
+  inline size_t align(const size_t offset){
+    return (offset + SNAPSHOT_ALIGNMENT - 1) & ~(SNAPSHOT_ALIGNMENT - 1);
+  }
+
+  inline bool exists(const string path){
+    return access(path.c_str(), R_OK) == 0;
+  }
+
+  inline header read_header(const string path){
+    header h;
+    FILE *pFile = fopen(path.c_str(),"r");
+    if (pFile==NULL) {fputs ("Snapshot file error",stderr); exit (1);}
+    if(fread(&h,sizeof(header),1,pFile) != 1) {fputs ("Snapshot reading error",stderr); exit (3);}
+    fclose(pFile);
+    if(h.magic != MAGIC || h.version != VERSION) {fputs ("Snapshot format error",stderr); exit (4);}
+    return h;
+  }
+
+  //Hash of the content of a source graph file.
+  inline uint64_t file_hash(const string path){
+    FILE *pFile = fopen(path.c_str(),"r");
+    if (pFile==NULL) {fputs ("Snapshot source file error",stderr); exit (1);}
+    vector<uint64_t> buffer(1 << 17);
+    uint64_t h = 0;
+    size_t total_bytes = 0;
+    size_t num_read;
+    while((num_read = fread(buffer.data(),1,buffer.size()*sizeof(uint64_t),pFile)) > 0){
+      memset((uint8_t*)buffer.data()+num_read,0,(sizeof(uint64_t)-num_read%sizeof(uint64_t))%sizeof(uint64_t));
+      const size_t num_words = (num_read+sizeof(uint64_t)-1)/sizeof(uint64_t);
+      for(size_t i = 0; i < num_words; i++){
+        h = ordering_cache::mix(h ^ buffer[i]);
+      }
+      total_bytes += num_read;
+    }
+    fclose(pFile);
+    return ordering_cache::mix(h ^ total_bytes);
+  }
+
+  inline source make_source(const string app, const string ordering,
+    const common::orientation orientation, const common::graph_type graph_type,
+    const uint64_t graph_hash){
+    if(app.size() >= MAX_NAME_LENGTH || ordering.size() >= MAX_NAME_LENGTH) {fputs ("Snapshot name too long",stderr); exit (1);}
+    source s;
+    memset(&s,0,sizeof(s));
+    memcpy(s.app,app.data(),app.size());
+    memcpy(s.ordering,ordering.data(),ordering.size());
+    s.orientation = orientation;
+    s.graph_type = graph_type;
+    s.graph_hash = graph_hash;
+    return s;
+  }
+
+  inline bool matches(const header &h, const source &expected){
+    return memcmp(&h.built_from,&expected,sizeof(source)) == 0;
+  }
+}
+
+/*
+I is the index type of the matrix: the width of node ids, row lengths and
+ranges. The default 32-bit matrix is what the applications use; a matrix of
+basic_uinteger<uint64_t> or basic_bitset<uint64_t> rows built from a
+BasicMutableGraph<uint64_t> holds graphs with more than 2^32 nodes. Row
+offsets are 64-bit for every index type.
+*/
+template<class T,class R,class I=uint32_t>
 class SparseMatrix{
   public:
     size_t matrix_size;  //number of nodes, number of columns = number of rows
@@ -18,21 +140,40 @@ class SparseMatrix{
     size_t max_nbrhood_size;
     bool symmetric; //undirected?
 
-
-    // Stores out neighbors.
-    uint32_t *row_lengths;
-    uint8_t **row_arrays;
-    uint32_t *row_ranges;
+    // Stores out neighbors. Row i lives in row_data[row_offsets[i],row_offsets[i+1]).
+    I *row_lengths;
+    uint64_t *row_offsets;
+    uint8_t *row_data;
+    I *row_ranges;
 
     // Stores in neighbors.
-    uint32_t *column_lengths;
-    uint8_t **column_arrays;
-    uint32_t *column_ranges;
+    I *column_lengths;
+    uint64_t *column_offsets;
+    uint8_t *column_data;
+    I *column_ranges;
 
     uint64_t *id_map;
     uint32_t *node_attributes;
-    vector< vector<uint32_t>*  > *out_edge_attributes;
-    vector< vector<uint32_t>*  > *in_edge_attributes;
+    // Edge attributes, one column per side laid out in the order of the rows:
+    // the attribute of the j-th element of get_row(i) is
+    // row_edge_attributes[row_edge_offsets[i]+j]. NULL without attributes.
+    uint64_t *row_edge_offsets;
+    uint32_t *row_edge_attributes;
+    uint64_t *column_edge_offsets;
+    uint32_t *column_edge_attributes;
+
+    // Set when id_map and node_attributes were allocated by the builder and
+    // are freed with the matrix, otherwise they belong to the caller.
+    bool owns_node_arrays;
+
+    // Set when the matrix is backed by a mapped snapshot.
+    uint8_t *mapped_snapshot;
+    size_t mapped_snapshot_size;
+
+    // Open addressing index from external to internal ids, see build_id_index.
+    I *id_index;
+    size_t id_index_mask;
+    std::once_flag id_index_built;
 
     SparseMatrix(size_t matrix_size_in,
       size_t cardinality_in,
@@ -40,16 +181,20 @@ class SparseMatrix{
       size_t col_total_bytes_used_in,
       size_t max_nbrhood_size_in,
       bool symmetric_in, 
-      uint32_t *row_lengths_in,
-      uint8_t **row_arrays_in,
-      uint32_t *row_range_data_in, 
-      uint32_t *column_lengths_in, 
-      uint8_t **column_arrays_in, 
-      uint32_t *column_range_data_in,
+      I *row_lengths_in,
+      uint64_t *row_offsets_in,
+      uint8_t *row_data_in,
+      I *row_range_data_in, 
+      I *column_lengths_in, 
+      uint64_t *column_offsets_in,
+      uint8_t *column_data_in,
+      I *column_range_data_in,
       uint64_t *id_map_in,
       uint32_t *node_attributes_in,
-      vector< vector<uint32_t>*  > *out_edge_attributes_in,
-      vector< vector<uint32_t>*  > *in_edge_attributes_in):
+      uint64_t *row_edge_offsets_in,
+      uint32_t *row_edge_attributes_in,
+      uint64_t *column_edge_offsets_in,
+      uint32_t *column_edge_attributes_in):
         matrix_size(matrix_size_in),
         cardinality(cardinality_in),
         row_total_bytes_used(row_total_bytes_used_in),
@@ -57,83 +202,136 @@ class SparseMatrix{
         max_nbrhood_size(max_nbrhood_size_in),
         symmetric(symmetric_in),
         row_lengths(row_lengths_in),
-        row_arrays(row_arrays_in),
+        row_offsets(row_offsets_in),
+        row_data(row_data_in),
         row_ranges(row_range_data_in),
         column_lengths(column_lengths_in),
-        column_arrays(column_arrays_in),
+        column_offsets(column_offsets_in),
+        column_data(column_data_in),
         column_ranges(column_range_data_in),
         id_map(id_map_in),
         node_attributes(node_attributes_in),
-        out_edge_attributes(out_edge_attributes_in),
-        in_edge_attributes(in_edge_attributes_in){}
+        row_edge_offsets(row_edge_offsets_in),
+        row_edge_attributes(row_edge_attributes_in),
+        column_edge_offsets(column_edge_offsets_in),
+        column_edge_attributes(column_edge_attributes_in),
+        owns_node_arrays(false),
+        mapped_snapshot(NULL),
+        mapped_snapshot_size(0),
+        id_index(NULL),
+        id_index_mask(0){}
 
     ~SparseMatrix(){
-      #pragma omp parallel for default(none)
-      for(size_t i = 0; i < matrix_size; i++){
-        delete[] row_arrays[i];
+      delete[] id_index;
+      if(mapped_snapshot != NULL){
+        munmap(mapped_snapshot,mapped_snapshot_size);
+        return;
       }
-      delete[] row_arrays;
-      delete[] row_lengths;
 
+      if(owns_node_arrays){
+        delete[] id_map;
+        delete[] node_attributes;
+      }
+      slab::release(row_data);
+      delete[] row_offsets;
+      delete[] row_lengths;
+      delete[] row_ranges;
+      delete[] row_edge_offsets;
+      slab::release(row_edge_attributes);
       if(!symmetric){
+        slab::release(column_data);
+        delete[] column_offsets;
         delete[] column_lengths;
-        #pragma omp parallel for default(none)
-        for(size_t i = 0; i < matrix_size; i++){
-          delete[] row_arrays[i];
-        }
+        delete[] column_ranges;
+        delete[] column_edge_offsets;
+        slab::release(column_edge_attributes);
       }
     }
 
     SparseMatrix* clone_on_node(int node);
     void *parallel_constructor(void *);
 
-    static SparseMatrix* build( MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+    static SparseMatrix* build( BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
+      const size_t num_threads,
+      const common::orientation orientation = common::ID_ORDER);
+
+    static SparseMatrix* from_symmetric_graph(BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
       const size_t num_threads);
 
-    static SparseMatrix* from_symmetric_graph(MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+    static SparseMatrix* from_symmetric_noattribute_graph(BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
       const size_t num_threads);
 
-    static SparseMatrix* from_symmetric_noattribute_graph(MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+    static SparseMatrix* from_symmetric_attribute_graph(BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
       const size_t num_threads);
 
-    static SparseMatrix* from_symmetric_attribute_graph(MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+    static SparseMatrix* from_asymmetric_graph(BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection, 
       const size_t num_threads);
 
-    static SparseMatrix* from_asymmetric_graph(MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection, 
+    static SparseMatrix* from_asymmetric_noattribute_graph(BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection, 
       const size_t num_threads);
 
-    static SparseMatrix* from_asymmetric_noattribute_graph(MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection, 
+    static SparseMatrix* from_asymmetric_attribute_graph(BasicMutableGraph<I> *inputGraph,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection, 
       const size_t num_threads);
 
-    static SparseMatrix* from_asymmetric_attribute_graph(MutableGraph *inputGraph,
-      const std::function<bool(uint32_t,uint32_t)> node_selection,
-      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection, 
+    static SparseMatrix* from_binary(const string path, const bool symmetric_in,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
       const size_t num_threads);
 
-    uint32_t get_max_row_id();
-    uint32_t get_internal_id(uint64_t external_id);
-    Set<T> get_row(uint32_t row);
-    Set<T> get_column(uint32_t column);
-    Set<R> get_decoded_row(uint32_t row, uint32_t *decoded_a);
+    static SparseMatrix* from_binary_v2(const string path, const bool symmetric_in,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
+      const size_t num_threads);
+
+    static SparseMatrix* from_compressed_binary(const string path, const bool symmetric_in,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
+      const size_t num_threads);
+
+    static SparseMatrix* from_csr(const size_t matrix_size_in, const bool symmetric_in,
+      const size_t max_nbrhood_size_in, const uint64_t * const row_starts[2], const I * const neighbors[2],
+      const uint64_t *external_ids,
+      const std::function<bool(I,uint32_t)> node_selection,
+      const std::function<bool(I,I,uint32_t)> edge_selection,
+      const size_t num_threads);
+
+    static SparseMatrix* from_snapshot(const string path, const snapshot::source &expected);
+    void write_snapshot(const string path, const snapshot::source &built_from);
+
+    void place_on_numa_nodes();
+
+    I get_max_row_id();
+    I get_internal_id(uint64_t external_id);
+    void get_internal_ids(const uint64_t *external_ids, const size_t num_ids, I *internal_ids,
+      const size_t num_threads);
+    void build_id_index(const size_t num_threads);
+    I find_internal_id(const uint64_t external_id) const;
+    Set<T> get_row(I row);
+    Set<T> get_column(I column);
+    const uint32_t* get_row_attributes(I row) const;
+    const uint32_t* get_column_attributes(I column) const;
+    Set<R> get_decoded_row(I row, uint32_t *decoded_a);
     void print_data(string filename);
 };
 
-template<class T,class R>
-inline uint32_t SparseMatrix<T,R>::get_max_row_id(){
+template<class T,class R,class I>
+inline I SparseMatrix<T,R,I>::get_max_row_id(){
   size_t max = 0;
-  uint32_t max_id = 0;
+  I max_id = 0;
   for(size_t i=0; i<matrix_size; i++){
     if(row_lengths[i] > max){
       max_id = i;
@@ -144,62 +342,133 @@ inline uint32_t SparseMatrix<T,R>::get_max_row_id(){
   return max_id;
 }
 
-template<class T,class R>
-inline uint32_t SparseMatrix<T,R>::get_internal_id(uint64_t external_id){
-  for(size_t i=0; i<matrix_size; i++){
-    if(id_map[i] == external_id)
-      return i;
+/*
+Builds the external to internal id index once, on first use. Slots hold
+internal ids and the external id of a slot is read from id_map, so the index
+costs sizeof(I) bytes per slot at a load factor of at most one half.
+Collisions are resolved by linear probing and ids are inserted in parallel
+with a compare and swap on the slot.
+*/
+template<class T,class R,class I>
+void SparseMatrix<T,R,I>::build_id_index(const size_t num_threads){
+  std::call_once(id_index_built,[this,num_threads](){
+    const I empty = std::numeric_limits<I>::max();
+    size_t capacity = 16;
+    while(capacity < 2*matrix_size)
+      capacity <<= 1;
+    const size_t mask = capacity-1;
+    I *index = new I[capacity];
+    std::fill(index,index+capacity,empty);
+
+    common::par_for_range(num_threads,0,matrix_size,4096,
+      [this,index,mask,empty](size_t tid, size_t i){
+        (void) tid;
+        size_t slot = id_hash(id_map[i]) & mask;
+        while(!__sync_bool_compare_and_swap(&index[slot],empty,(I)i))
+          slot = (slot+1) & mask;
+      });
+    id_index_mask = mask;
+    id_index = index;
+  });
+}
+
+//Internal id of external_id, the largest I if it is not in the matrix.
+template<class T,class R,class I>
+inline I SparseMatrix<T,R,I>::find_internal_id(const uint64_t external_id) const {
+  const I empty = std::numeric_limits<I>::max();
+  size_t slot = id_hash(external_id) & id_index_mask;
+  while(id_index[slot] != empty){
+    if(id_map[id_index[slot]] == external_id)
+      return id_index[slot];
+    slot = (slot+1) & id_index_mask;
   }
-  return 0;
+  return empty;
+}
+
+//Returns 0 for ids that are not in the matrix.
+template<class T,class R,class I>
+inline I SparseMatrix<T,R,I>::get_internal_id(uint64_t external_id){
+  build_id_index(1);
+  const I internal_id = find_internal_id(external_id);
+  return (internal_id == std::numeric_limits<I>::max()) ? 0 : internal_id;
+}
+
+//Resolves a batch of ids in parallel. Ids that are not in the matrix map to the largest I.
+template<class T,class R,class I>
+void SparseMatrix<T,R,I>::get_internal_ids(const uint64_t *external_ids, const size_t num_ids,
+  I *internal_ids, const size_t num_threads){
+  build_id_index(num_threads);
+  common::par_for_range(num_threads,0,num_ids,4096,
+    [this,external_ids,internal_ids](size_t tid, size_t i){
+      (void) tid;
+      internal_ids[i] = find_internal_id(external_ids[i]);
+    });
 }
 
-template<class T,class R>
-inline Set<T> SparseMatrix<T,R>::get_row(uint32_t row){
+template<class T,class R,class I>
+inline Set<T> SparseMatrix<T,R,I>::get_row(I row){
   size_t card = row_lengths[row];
-  return Set<T>::from_flattened(row_arrays[row],card);
+  #ifdef NUMA_STATS
+  if(numa_helper::enabled)
+    numa_helper::count_access(numa_helper::partition_of(row,0,matrix_size),row_offsets[row+1]-row_offsets[row]);
+  #endif
+  return Set<T>::from_flattened(&row_data[row_offsets[row]],card);
 }
-template<class T,class R>
-inline Set<T> SparseMatrix<T,R>::get_column(uint32_t column){
+template<class T,class R,class I>
+inline Set<T> SparseMatrix<T,R,I>::get_column(I column){
   size_t card = column_lengths[column];
-  return Set<T>::from_flattened(column_arrays[column],card);
+  #ifdef NUMA_STATS
+  if(numa_helper::enabled)
+    numa_helper::count_access(numa_helper::partition_of(column,0,matrix_size),column_offsets[column+1]-column_offsets[column]);
+  #endif
+  return Set<T>::from_flattened(&column_data[column_offsets[column]],card);
+}
+//Attributes of the elements of get_row(row), in the order foreach visits them.
+template<class T,class R,class I>
+inline const uint32_t* SparseMatrix<T,R,I>::get_row_attributes(I row) const {
+  return &row_edge_attributes[row_edge_offsets[row]];
+}
+template<class T,class R,class I>
+inline const uint32_t* SparseMatrix<T,R,I>::get_column_attributes(I column) const {
+  return &column_edge_attributes[column_edge_offsets[column]];
 }
 /*
 This function decodes the variant and bitpacked types into UINTEGER arrays.
 This function is not necessary if these types are not used (thus the pragma.)
 */
-template<class T,class R>
-inline Set<R> SparseMatrix<T,R>::get_decoded_row(uint32_t row, uint32_t *buffer){
+template<class T,class R,class I>
+inline Set<R> SparseMatrix<T,R,I>::get_decoded_row(I row, uint32_t *buffer){
   size_t card = row_lengths[row];
   #if COMPRESSION == 1
-  Set<T> row_set = Set<T>::from_flattened(row_arrays[row],card);
+  Set<T> row_set = Set<T>::from_flattened(&row_data[row_offsets[row]],card);
   if(row_set.type == common::VARIANT || row_set.type == common::BITPACKED){
     return row_set.decode(buffer);
   }
   return Set<R>(row_set);
   #else
   (void) buffer;
-  return Set<R>::from_flattened(row_arrays[row],card);
+  return Set<R>::from_flattened(&row_data[row_offsets[row]],card);
   #endif
 }
 
-template<class T, class R>
-void SparseMatrix<T,R>::print_data(string filename){
+template<class T,class R,class I>
+void SparseMatrix<T,R,I>::print_data(string filename){
   ofstream myfile;
   myfile.open(filename);
 
   //Printing out neighbors
   cout << "Writing matrix row_data to file: " << filename << endl;
   for(size_t i = 0; i < matrix_size; i++){
-    size_t card = row_lengths[i];
     myfile << "External ID: " << id_map[i] << " ROW: " << i << " LEN: " << row_lengths[i] << endl;
     if(node_attributes != NULL)
       myfile << "Node Attribute: " << node_attributes[i] << endl;
-    Set<T> row = Set<T>::from_flattened(row_arrays[i],card);
+    Set<T> row = get_row(i);
+    const uint32_t *row_attributes = (row_edge_attributes != NULL) ? get_row_attributes(i) : NULL;
     size_t row_i = 0;
-    row.foreach( [this, &myfile,&row_i,i] (uint32_t data){
+    row.foreach( [&myfile,&row_i,row_attributes] (I data){
       myfile << " DATA: " << data;
-      if(this->out_edge_attributes != NULL)
-        myfile << " Attribute: " << this->out_edge_attributes->at(i)->at(row_i++);
+      if(row_attributes != NULL)
+        myfile << " Attribute: " << row_attributes[row_i++];
       myfile << endl;
     });
   }
@@ -210,13 +479,13 @@ void SparseMatrix<T,R>::print_data(string filename){
       myfile << "External ID: " << id_map[i] << " COLUMN: " << i << " LEN: " << column_lengths[i] << endl;
       if(node_attributes != NULL)
         myfile << "Node Attribute: " << node_attributes[i] << endl;
-      size_t card = column_lengths[i];
-      Set<T> col = Set<T>::from_flattened(column_arrays[i],card);
+      Set<T> col = get_column(i);
+      const uint32_t *col_attributes = (column_edge_attributes != NULL) ? get_column_attributes(i) : NULL;
       size_t col_i = 0;
-      col.foreach( [this,&myfile,&col_i,i] (uint32_t data){
+      col.foreach( [&myfile,&col_i,col_attributes] (I data){
         myfile << " DATA: " << data;
-        if(this->in_edge_attributes != NULL)
-          myfile << " Attribute: " << this->in_edge_attributes->at(i)->at(col_i++);
+        if(col_attributes != NULL)
+          myfile << " Attribute: " << col_attributes[col_i++];
         myfile << endl;
       });
     }
@@ -224,529 +493,904 @@ void SparseMatrix<T,R>::print_data(string filename){
 
   myfile.close();
 }
+
+/*
+Splits the rows into one partition per NUMA node holding roughly the same
+number of bytes and moves each partition to its node. par_for_range workers
+over [0,matrix_size) then start with the rows of their own node.
+*/
+template<class T,class R,class I>
+void SparseMatrix<T,R,I>::place_on_numa_nodes(){
+  const size_t num_nodes = numa_helper::num_nodes();
+  const size_t total_bytes = row_offsets[matrix_size];
+
+  vector<size_t> row_boundaries(num_nodes+1,matrix_size);
+  row_boundaries[0] = 0;
+  size_t k = 1;
+  for(size_t i = 0; i < matrix_size && k < num_nodes; i++){
+    while(k < num_nodes && row_offsets[i] >= (total_bytes*k)/num_nodes)
+      row_boundaries[k++] = i;
+  }
+  for(size_t p = 0; p <= num_nodes; p++){
+    numa_helper::boundaries[p] = (matrix_size > 0) ? (double)row_boundaries[p]/matrix_size : 0.0;
+  }
+
+  size_t local_bytes = 0;
+  size_t remote_bytes = 0;
+  auto place_side = [&](const I *lengths, const uint64_t *offsets, const uint8_t *data){
+    for(size_t p = 0; p < num_nodes; p++){
+      const size_t first = row_boundaries[p];
+      const size_t last = row_boundaries[p+1];
+      const size_t num_bytes = offsets[last]-offsets[first];
+      if(!numa_helper::place(&data[offsets[first]],num_bytes,p)){
+        cout << "WARNING: could not move partition " << p << " to its NUMA node" << endl;
+      }
+      numa_helper::place((const uint8_t*)&lengths[first],sizeof(I)*(last-first),p);
+      numa_helper::place((const uint8_t*)&offsets[first],sizeof(uint64_t)*(last-first),p);
+
+      const size_t on_node = numa_helper::bytes_on_node(&data[offsets[first]],num_bytes,p);
+      local_bytes += on_node;
+      remote_bytes += num_bytes-on_node;
+    }
+  };
+  place_side(row_lengths,row_offsets,row_data);
+  if(!symmetric)
+    place_side(column_lengths,column_offsets,column_data);
+
+  cout << "NUMA partitions: " << num_nodes << endl;
+  cout << "NUMA local row bytes: " << local_bytes << endl;
+  cout << "NUMA remote row bytes: " << remote_bytes << endl;
+}
+
+//Writes the rows (or columns) of the matrix as one contiguous byte section.
+template<class I>
+inline void write_snapshot_section(ofstream &outfile, size_t &position, snapshot::section &sec,
+  const size_t matrix_size, const I *lengths, const uint64_t *offsets,
+  const uint8_t *data, const I *ranges){
+
+  const char padding[snapshot::SNAPSHOT_ALIGNMENT] = {0};
+  auto write_aligned = [&](const char *section_data, const size_t num_bytes) -> uint64_t {
+    const size_t start = snapshot::align(position);
+    outfile.write(padding,start-position);
+    outfile.write(section_data,num_bytes);
+    position = start + num_bytes;
+    return start;
+  };
+
+  sec.total_bytes = offsets[matrix_size];
+  sec.lengths = write_aligned((const char*)lengths,sizeof(I)*matrix_size);
+  sec.offsets = write_aligned((const char*)offsets,sizeof(uint64_t)*(matrix_size+1));
+  sec.ranges = (ranges != NULL) ? write_aligned((const char*)ranges,sizeof(I)*matrix_size) : 0;
+  sec.data = write_aligned((const char*)data,sec.total_bytes);
+}
+
+//Writes a temporary file renamed over path, so a concurrent run never maps a
+//partial snapshot.
+template<class T,class R,class I>
+void SparseMatrix<T,R,I>::write_snapshot(const string path, const snapshot::source &built_from){
+  if(row_edge_attributes != NULL || column_edge_attributes != NULL){
+    fputs ("Snapshots of graphs with edge attributes are not supported",stderr); exit (1);
+  }
+  cout << "Writing matrix snapshot to file: " << path << endl;
+
+  const string temporary_path = path + ".tmp" + to_string(getpid());
+  ofstream outfile;
+  outfile.open(temporary_path, ios::binary | ios::out);
+  if(!outfile.is_open()) {fputs ("Snapshot file error",stderr); exit (1);}
+
+  snapshot::header h;
+  memset(&h,0,sizeof(h));
+  h.magic = snapshot::MAGIC;
+  h.version = snapshot::VERSION;
+  h.layout = T::get_type();
+  h.matrix_size = matrix_size;
+  h.cardinality = cardinality;
+  h.max_nbrhood_size = max_nbrhood_size;
+  h.symmetric = symmetric;
+  h.has_ranges = (row_ranges != NULL);
+  h.index_bytes = sizeof(I);
+  h.built_from = built_from;
+
+  //The header is rewritten once all section offsets are known.
+  outfile.write((char*)&h,sizeof(h));
+  size_t position = sizeof(h);
+
+  write_snapshot_section(outfile,position,h.row,matrix_size,row_lengths,row_offsets,row_data,row_ranges);
+  if(!symmetric)
+    write_snapshot_section(outfile,position,h.column,matrix_size,column_lengths,column_offsets,column_data,column_ranges);
+
+  const char padding[snapshot::SNAPSHOT_ALIGNMENT] = {0};
+  h.id_map = snapshot::align(position);
+  outfile.write(padding,h.id_map-position);
+  outfile.write((char*)id_map,sizeof(uint64_t)*matrix_size);
+  position = h.id_map + sizeof(uint64_t)*matrix_size;
+  if(node_attributes != NULL){
+    h.node_attributes = snapshot::align(position);
+    outfile.write(padding,h.node_attributes-position);
+    outfile.write((char*)node_attributes,sizeof(uint32_t)*matrix_size);
+    position = h.node_attributes + sizeof(uint32_t)*matrix_size;
+  }
+  h.file_size = position;
+
+  outfile.seekp(0);
+  outfile.write((char*)&h,sizeof(h));
+  outfile.close();
+  if(outfile.fail() || rename(temporary_path.c_str(),path.c_str()) != 0){
+    unlink(temporary_path.c_str());
+    fputs ("Snapshot writing error",stderr); exit (3);
+  }
+}
+
+//Maps a snapshot written by write_snapshot. Nothing is copied, every array of
+//the matrix points into the mapping. The snapshot must have been built from
+//expected.
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_snapshot(const string path, const snapshot::source &expected){
+  const snapshot::header h = snapshot::read_header(path);
+  if(h.layout != (uint32_t)T::get_type() || h.index_bytes != sizeof(I)) {fputs ("Snapshot layout does not match",stderr); exit (4);}
+  if(!snapshot::matches(h,expected)) {fputs ("Snapshot was built by another application, orientation, ordering or graph",stderr); exit (4);}
+
+  int fd = open(path.c_str(),O_RDONLY);
+  if (fd == -1) {fputs ("Snapshot file error",stderr); exit (1);}
+  struct stat file_stat;
+  fstat(fd,&file_stat);
+  if((size_t)file_stat.st_size < h.file_size) {fputs ("Snapshot is truncated",stderr); exit (3);}
+
+  uint8_t *base = (uint8_t*) mmap(NULL,h.file_size,PROT_READ,MAP_PRIVATE,fd,0);
+  close(fd);
+  if(base == MAP_FAILED) {fputs ("Snapshot mmap error",stderr); exit (2);}
+
+  const snapshot::section &col = h.symmetric ? h.row : h.column;
+
+  cout << "Mapped snapshot: " << path << endl;
+  cout << "Number of nodes: " << h.matrix_size << endl;
+  cout << "Number of edges: " << h.cardinality << endl;
+
+  SparseMatrix<T,R,I> *matrix = new SparseMatrix(h.matrix_size,h.cardinality,h.row.total_bytes,
+    h.column.total_bytes,h.max_nbrhood_size,h.symmetric,
+    (I*)(base + h.row.lengths),(uint64_t*)(base + h.row.offsets),base + h.row.data,
+    h.has_ranges ? (I*)(base + h.row.ranges) : NULL,
+    (I*)(base + col.lengths),(uint64_t*)(base + col.offsets),base + col.data,
+    h.has_ranges ? (I*)(base + col.ranges) : NULL,
+    (uint64_t*)(base + h.id_map),
+    (h.node_attributes != 0) ? (uint32_t*)(base + h.node_attributes) : NULL,
+    NULL,NULL,NULL,NULL);
+  matrix->mapped_snapshot = base;
+  matrix->mapped_snapshot_size = h.file_size;
+  return matrix;
+}
 /////////////////////////////////////////////////////////////////////////////////////////////
-template<class T>
-inline pair<size_t,size_t> pack_attribute_data(const uint32_t i,
+/*
+Sizing pass of pack_arena over rows [0,num_rows). Flattens every selected
+neighborhood into scratch space and turns the sizes into offsets by an
+exclusive prefix sum that starts at offsets[0]. Returns offsets[num_rows].
+*/
+template<class T,class I>
+inline size_t size_rows(const size_t num_threads, const size_t num_rows,
+  const size_t max_row_length, const size_t universe,
+  const std::function<size_t(size_t,I*,bool)> select_row,
+  I * const lengths, uint64_t * const offsets, I * const ranges){
+
+  //Worst case flattened size of a row: a block per element or a full bitset.
+  const size_t max_row_bytes = max_row_length*(2*sizeof(I)+BLOCK_SIZE/8) +
+    universe/8 + ARENA_PADDING;
+  ParallelBuffer<I> selected_buffer(num_threads,max_row_length+1);
+  ParallelBuffer<uint8_t> sizing_buffer(num_threads,max_row_bytes);
+
+  //build_flattened counts the layouts it picks, only the final pass should count.
+  const size_t layout_counts[] = {common::num_bs,common::num_pshort,common::num_uint,common::num_bp,common::num_v,common::num_runs};
+
+  common::par_for_range(num_threads,0,num_rows,256,
+    [&](size_t tid){
+      selected_buffer.allocate(tid);
+      sizing_buffer.allocate(tid);
+    },
+    [&](size_t tid, size_t i){
+      I * const selected = selected_buffer.data[tid];
+      const size_t length = select_row(i,selected,false);
+      lengths[i] = length;
+      if(ranges != NULL)
+        ranges[i] = (length > 0) ? selected[length-1]-selected[0] : 0;
+      offsets[i+1] = Set<T>::flatten_from_array(sizing_buffer.data[tid],selected,length);
+    },
+    [&](size_t tid){
+      selected_buffer.unallocate(tid);
+      sizing_buffer.unallocate(tid);
+    }
+  );
+
+  common::num_bs = layout_counts[0];
+  common::num_pshort = layout_counts[1];
+  common::num_uint = layout_counts[2];
+  common::num_bp = layout_counts[3];
+  common::num_v = layout_counts[4];
+  common::num_runs = layout_counts[5];
+
+  for(size_t i = 0; i < num_rows; i++){
+    offsets[i+1] += offsets[i];
+  }
+  return offsets[num_rows];
+}
+
+//Packing pass of pack_arena, flattens row i at arena[offsets[i]].
+template<class T,class I>
+inline void pack_rows(const size_t num_threads, const size_t num_rows,
+  const size_t max_row_length,
+  const std::function<size_t(size_t,I*,bool)> select_row,
+  const uint64_t * const offsets, uint8_t * const arena){
+
+  ParallelBuffer<I> selected_buffer(num_threads,max_row_length+1);
+  common::par_for_range(num_threads,0,num_rows,256,
+    [&](size_t tid){
+      selected_buffer.allocate(tid);
+    },
+    [&](size_t tid, size_t i){
+      I * const selected = selected_buffer.data[tid];
+      const size_t length = select_row(i,selected,true);
+      Set<T>::flatten_from_array(&arena[offsets[i]],selected,length);
+    },
+    [&](size_t tid){
+      selected_buffer.unallocate(tid);
+    }
+  );
+}
+
+/*
+Packs one side (rows or columns) of a matrix into a single arena. A sizing
+pass flattens every row into scratch space to learn its size, an exclusive
+prefix sum over the sizes gives the offsets and a second pass flattens every
+row into its final place. select_row(i,selected,final_pass) writes the
+selected neighborhood of row i into selected and returns its length; it is
+called once per pass, so side effects belong in the final pass only.
+before_packing runs between the passes, once lengths are known.
+*/
+template<class T,class I>
+inline uint8_t* pack_arena(const size_t num_threads, const size_t num_rows,
+  const size_t max_row_length, const size_t universe,
+  const std::function<size_t(size_t,I*,bool)> select_row,
+  I * const lengths, uint64_t * const offsets, I * const ranges,
+  const std::function<void()> before_packing = std::function<void()>()){
+
+  offsets[0] = 0;
+  const size_t total_bytes = size_rows<T,I>(num_threads,num_rows,max_row_length,universe,
+    select_row,lengths,offsets,ranges);
+  if(before_packing)
+    before_packing();
+
+  //Set kernels may read a vector past the end of the last row.
+  uint8_t * const arena = common::allocate_arena(total_bytes+ARENA_PADDING);
+  memset(arena+total_bytes,0,ARENA_PADDING);
+
+  pack_rows<T,I>(num_threads,num_rows,max_row_length,select_row,offsets,arena);
+  return arena;
+}
+
+/*
+Lays out the edge attribute column of one side: edge_offsets[i] is the
+exclusive prefix sum of the row lengths, so the attributes of row i start
+where the attributes of row i-1 end.
+*/
+template<class I>
+inline uint32_t* allocate_edge_attributes(const size_t num_rows, const I * const lengths,
+  uint64_t * const edge_offsets){
+  edge_offsets[0] = 0;
+  for(size_t i = 0; i < num_rows; i++){
+    edge_offsets[i+1] = edge_offsets[i] + lengths[i];
+  }
+  return (uint32_t*) slab::allocate(sizeof(uint32_t)*edge_offsets[num_rows]);
+}
+
+//selected_attributes receives the attribute of every selected neighbor (NULL skips them).
+template<class I>
+inline size_t select_attribute_data(const I i,
   const vector<uint32_t> *node_attr, const vector<uint32_t> *edge_attr,
-  const vector<uint32_t> *neighborhood, uint32_t *selected_neighborhood,
-  const uint32_t *old2newids, vector<vector<uint32_t>*> *edge_attributes_in,
-  uint8_t *data, size_t index,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection){
+  const vector<I> *neighborhood, I *selected_neighborhood,
+  const I *old2newids, uint32_t *selected_attributes,
+  const std::function<bool(I,uint32_t)> &node_selection,
+  const std::function<bool(I,I,uint32_t)> &edge_selection){
 
   size_t new_size = 0;
-  vector<uint32_t> *new_edge_attribute = edge_attributes_in->at(old2newids[i]);
   for(size_t j = 0; j < neighborhood->size(); ++j) {
     if(node_selection(neighborhood->at(j),node_attr->at(neighborhood->at(j))) && edge_selection(i,neighborhood->at(j),edge_attr->at(j))){
+      if(selected_attributes != NULL)
+        selected_attributes[new_size] = edge_attr->at(j);
       selected_neighborhood[new_size++] = old2newids[neighborhood->at(j)];
-      new_edge_attribute->push_back(edge_attr->at(j));
     } 
   }
-  index += Set<T>::flatten_from_array(data+index,selected_neighborhood,new_size);
-  return make_pair(index,new_size);
+  return new_size;
 }
 
-template<class T>
-inline pair<size_t,size_t> pack_data(const uint32_t i,
-  const vector<uint32_t> * const neighborhood, uint32_t * const selected_neighborhood, 
-  uint8_t * const data, size_t index,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
-  uint32_t *range_data){
+template<class I>
+inline size_t select_data(const I i,
+  const I * const neighborhood, const size_t neighborhood_size,
+  I * const selected_neighborhood, 
+  const std::function<bool(I,uint32_t)> &node_selection,
+  const std::function<bool(I,I,uint32_t)> &edge_selection){
 
   size_t new_size = 0;
-  for(size_t j = 0; j < neighborhood->size(); ++j) {
-    if(node_selection(neighborhood->at(j),0) && edge_selection(i,neighborhood->at(j),0)){
-      selected_neighborhood[new_size++] = neighborhood->at(j);
+  for(size_t j = 0; j < neighborhood_size; ++j) {
+    if(node_selection(neighborhood[j],0) && edge_selection(i,neighborhood[j],0)){
+      selected_neighborhood[new_size++] = neighborhood[j];
     }
   }
-  range_data[i] = selected_neighborhood[new_size-1]-selected_neighborhood[0];
-  index += Set<T>::flatten_from_array(data+index,selected_neighborhood,new_size);
-  return make_pair(index,new_size);
+  return new_size;
 }
 
-template<class T,class R>
-inline SparseMatrix<T,R>* SparseMatrix<T,R>::build(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
-  const size_t num_threads){
-  if(inputGraph->symmetric) {
-    return SparseMatrix<T,R>::from_symmetric_graph(inputGraph,node_selection,edge_selection,num_threads);
+template<class I>
+inline size_t select_data(const I i,
+  const vector<I> * const neighborhood, I * const selected_neighborhood, 
+  const std::function<bool(I,uint32_t)> &node_selection,
+  const std::function<bool(I,I,uint32_t)> &edge_selection){
+  return select_data<I>(i,neighborhood->data(),neighborhood->size(),selected_neighborhood,
+    node_selection,edge_selection);
+}
+
+/*
+With an orientation other than ID_ORDER the edge selection of a symmetric
+graph is handed the ranks of both endpoints (MutableGraph::orientation_ranks)
+instead of their ids. A pruning selection such as nbr < node then keeps every
+edge pointing towards the higher degree (or later peeled) endpoint, which
+bounds the out-degree independently of how the ids were assigned.
+*/
+template<class T,class R,class I>
+inline SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::build(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
+  const size_t num_threads,
+  const common::orientation orientation){
+  SparseMatrix<T,R,I> *matrix;
+  if(inputGraph->symmetric && orientation != common::ID_ORDER) {
+    const vector<I> ranks = inputGraph->orientation_ranks(orientation);
+    const I *rank = ranks.data();
+    matrix = SparseMatrix<T,R,I>::from_symmetric_graph(inputGraph,node_selection,
+      [rank,&edge_selection](I node, I nbr, uint32_t attribute) -> bool {
+        return edge_selection(rank[node],rank[nbr],attribute);
+      },num_threads);
+  }
+  else if(inputGraph->symmetric) {
+    matrix = SparseMatrix<T,R,I>::from_symmetric_graph(inputGraph,node_selection,edge_selection,num_threads);
   }
   else {
-    return SparseMatrix<T,R>::from_asymmetric_graph(inputGraph,node_selection,edge_selection,num_threads);
+    matrix = SparseMatrix<T,R,I>::from_asymmetric_graph(inputGraph,node_selection,edge_selection,num_threads);
   }
+  slab::trim();
+  return matrix;
 }
 
-template<class T,class R>
-inline SparseMatrix<T,R>* SparseMatrix<T,R>::from_symmetric_graph(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+template<class T,class R,class I>
+inline SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_symmetric_graph(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
   const size_t num_threads){
   if(inputGraph->node_attr == NULL)
-    return SparseMatrix<T,R>::from_symmetric_noattribute_graph(inputGraph,node_selection,edge_selection,num_threads);
+    return SparseMatrix<T,R,I>::from_symmetric_noattribute_graph(inputGraph,node_selection,edge_selection,num_threads);
   else
-    return SparseMatrix<T,R>::from_symmetric_attribute_graph(inputGraph,node_selection,edge_selection,num_threads);
+    return SparseMatrix<T,R,I>::from_symmetric_attribute_graph(inputGraph,node_selection,edge_selection,num_threads);
 }
 //Directed Graph
-template<class T,class R>
-inline SparseMatrix<T,R>* SparseMatrix<T,R>::from_asymmetric_graph(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection, const size_t num_threads){
+template<class T,class R,class I>
+inline SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_asymmetric_graph(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection, const size_t num_threads){
   if(inputGraph->node_attr == NULL)
-    return SparseMatrix<T,R>::from_asymmetric_noattribute_graph(inputGraph,node_selection,edge_selection,num_threads);
+    return SparseMatrix<T,R,I>::from_asymmetric_noattribute_graph(inputGraph,node_selection,edge_selection,num_threads);
   else
-    return SparseMatrix<T,R>::from_asymmetric_attribute_graph(inputGraph,node_selection,edge_selection,num_threads);
+    return SparseMatrix<T,R,I>::from_asymmetric_attribute_graph(inputGraph,node_selection,edge_selection,num_threads);
 }
 //Constructors
-template<class T,class R>
-SparseMatrix<T,R>* SparseMatrix<T,R>::from_symmetric_attribute_graph(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_symmetric_attribute_graph(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
   const size_t num_threads){
 
   const size_t matrix_size_in = inputGraph->num_nodes;
-  const size_t cardinality_in = inputGraph->num_edges;
   const vector<uint32_t> *node_attr = inputGraph->node_attr;
   const vector<vector<uint32_t>*> *edge_attr = inputGraph->out_edge_attributes;
 
   ops::prepare_shuffling_dictionary16();
 
-  uint8_t **row_arrays_in = new uint8_t*[matrix_size_in];
-  uint32_t *row_lengths_in = new uint32_t[matrix_size_in];
-
-  uint32_t *old2newids = new uint32_t[matrix_size_in];
+  I *old2newids = new I[matrix_size_in];
+  I *new2oldids = new I[matrix_size_in];
   size_t new_num_nodes = 0;
 
   // Filter out nodes.
-  vector<vector<uint32_t>*> *edge_attributes_in = new vector<vector<uint32_t>*>();
   for(size_t i = 0; i < matrix_size_in; ++i){
     if(node_selection(i,node_attr->at(i))){
-      edge_attributes_in->push_back(new std::vector<uint32_t>());
+      new2oldids[new_num_nodes] = i;
       old2newids[i] = new_num_nodes++;
     } else{
-      old2newids[i] = 0xFFFFFFFF;
+      old2newids[i] = std::numeric_limits<I>::max();
     }
   }
 
   uint32_t *node_attributes_in = new uint32_t[new_num_nodes];
   uint64_t *new_imap = new uint64_t[new_num_nodes];
-  size_t new_cardinality = 0;
-  size_t total_bytes_used = 0;
-
-  const size_t alloc_size = (cardinality_in*sizeof(int)*ALLOCATOR)/num_threads;
-
-  ParallelBuffer<uint8_t> *row_data_buffer =
-    new ParallelBuffer<uint8_t>(num_threads,alloc_size);
-  ParallelBuffer<uint32_t> *selected_data_buffer =
-    new ParallelBuffer<uint32_t>(num_threads,alloc_size);
+  for(size_t i = 0; i < new_num_nodes; ++i){
+    node_attributes_in[i] = node_attr->at(new2oldids[i]);
+    new_imap[i] = inputGraph->id_map->at(new2oldids[i]);
+  }
 
-  const size_t m = PADDING;
-  size_t *indices = new size_t[num_threads * m];
-  size_t *cardinalities= new size_t[num_threads * m];
-  size_t *tid_alloc_size = new size_t[num_threads * m];
+  I *row_lengths_in = new I[new_num_nodes];
+  uint64_t *row_offsets_in = new uint64_t[new_num_nodes+1];
+  uint64_t *edge_offsets_in = new uint64_t[new_num_nodes+1];
+  uint32_t *edge_attributes_in = NULL;
 
   double parallel_range = common::startClock();
-  common::par_for_range(num_threads,0,matrix_size_in,128,
-    //////////////////////////////////////////////////////////
-    [tid_alloc_size,selected_data_buffer,row_data_buffer,indices,cardinalities](size_t tid){
-      indices[tid * m] = 0;
-      cardinalities[tid * m] = 0;
-      row_data_buffer->allocate(tid);
-      selected_data_buffer->allocate(tid);
-      tid_alloc_size[tid * m] = 0;
+  uint8_t *row_data_in = pack_arena<T,I>(num_threads,new_num_nodes,
+    inputGraph->max_nbrhood_size,new_num_nodes,
+    [&](size_t i, I *selected, bool final_pass) -> size_t {
+      const I old_id = new2oldids[i];
+      return select_attribute_data<I>(old_id,node_attr,edge_attr->at(old_id),
+        inputGraph->out_neighborhoods->at(old_id),selected,old2newids,
+        final_pass ? &edge_attributes_in[edge_offsets_in[i]] : NULL,
+        node_selection,edge_selection);
     },
-    /////////////////////////////////////////////////////////////
-    [alloc_size,tid_alloc_size,node_attributes_in,old2newids,edge_attributes_in,node_attr,new_imap,edge_attr,cardinalities,row_data_buffer,selected_data_buffer,row_arrays_in,indices,row_lengths_in,inputGraph,node_selection,edge_selection]
-    (size_t tid, size_t i) {
-      if(old2newids[i] != 0xFFFFFFFF){
-        uint8_t * const row_data_in = row_data_buffer->data[tid];
-        uint32_t * const selected_data = selected_data_buffer->data[tid];
-        node_attributes_in[old2newids[i]] = node_attr->at(i);
-        new_imap[old2newids[i]] = inputGraph->id_map->at(i);
-        row_arrays_in[old2newids[i]] = &row_data_in[tid_alloc_size[tid*m]];
-        const pair<size_t,size_t> index_size = pack_attribute_data<T>(i,
-          node_attr,edge_attr->at(i),inputGraph->out_neighborhoods->at(i),
-          selected_data,old2newids,edge_attributes_in,
-          row_data_in,tid_alloc_size[tid*m],node_selection,edge_selection); 
-        indices[tid * m] += (index_size.first-tid_alloc_size[tid*m]);
-        tid_alloc_size[tid*m] = index_size.first;
-        row_lengths_in[old2newids[i]] = index_size.second;
-        cardinalities[tid * m] += row_lengths_in[old2newids[i]];
-
-        //realloc to larger size if within 95% of original allocation
-        if(tid_alloc_size[tid*m] > (REALLOC_THRESHOLD*alloc_size)){
-          row_data_buffer->data[tid] = (uint8_t*) realloc((void *) row_data_buffer->data[tid], tid_alloc_size[tid*m]*sizeof(uint8_t));  
-          tid_alloc_size[tid*m] = 0;
-          row_data_buffer->data[tid] = new uint8_t[alloc_size];  
-        }
-      }
-    },
-    /////////////////////////////////////////////////////////////
-    [row_data_buffer,selected_data_buffer,cardinalities,&new_cardinality,&total_bytes_used,indices](size_t tid){
-      selected_data_buffer->unallocate(tid);
-      new_cardinality += cardinalities[tid * m];
-      total_bytes_used += indices[tid * m];
-    }
-  );
-  delete[] indices;
-  delete[] cardinalities;
+    row_lengths_in,row_offsets_in,NULL,
+    [&](){
+      edge_attributes_in = allocate_edge_attributes<I>(new_num_nodes,row_lengths_in,edge_offsets_in);
+    });
   common::stopClock("parallel section",parallel_range);
+  delete[] old2newids;
+  delete[] new2oldids;
+
+  size_t new_cardinality = 0;
+  for(size_t i = 0; i < new_num_nodes; ++i){
+    new_cardinality += row_lengths_in[i];
+  }
+  const size_t total_bytes_used = row_offsets_in[new_num_nodes];
 
   cout << "Number of nodes: " << new_num_nodes << endl;
   cout << "Number of edges: " << new_cardinality << endl;
   cout << "ROW DATA SIZE (Bytes): " << total_bytes_used << endl;
 
-  return new SparseMatrix(new_num_nodes,new_cardinality,
+  SparseMatrix<T,R,I> *matrix = new SparseMatrix(new_num_nodes,new_cardinality,
     total_bytes_used,0,inputGraph->max_nbrhood_size,true,
-    row_lengths_in,row_arrays_in,NULL,row_lengths_in,row_arrays_in,NULL,new_imap,
-    node_attributes_in,edge_attributes_in,edge_attributes_in);
+    row_lengths_in,row_offsets_in,row_data_in,NULL,
+    row_lengths_in,row_offsets_in,row_data_in,NULL,
+    new_imap,node_attributes_in,
+    edge_offsets_in,edge_attributes_in,edge_offsets_in,edge_attributes_in);
+  matrix->owns_node_arrays = true;
+  return matrix;
 }
 //Constructors
-template<class T,class R>
-SparseMatrix<T,R>* SparseMatrix<T,R>::from_symmetric_noattribute_graph(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection,
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_symmetric_noattribute_graph(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
   const size_t num_threads){
   const size_t matrix_size_in = inputGraph->num_nodes;
-  const size_t cardinality_in = inputGraph->num_edges;
 
   ops::prepare_shuffling_dictionary16();
 
-  uint8_t **row_arrays_in = new uint8_t*[matrix_size_in];
-  uint32_t *row_lengths_in = new uint32_t[matrix_size_in];
-  uint32_t *row_range_data = new uint32_t[matrix_size_in];
-
-  size_t new_cardinality = 0;
-  size_t total_bytes_used = 0;
-
-  const size_t alloc_size = (cardinality_in*sizeof(uint32_t)*ALLOCATOR)/num_threads;
-
-  ParallelBuffer<uint8_t> *row_data_buffer = new ParallelBuffer<uint8_t>(num_threads,alloc_size);
-  ParallelBuffer<uint32_t> *selected_data_buffer = new ParallelBuffer<uint32_t>(num_threads,alloc_size);
-
-  const size_t m = PADDING;
-  size_t *indices = new size_t[num_threads * m];
-  size_t *cardinalities= new size_t[num_threads * m];
-  size_t *tid_alloc_size = new size_t[num_threads * m];
+  I *row_lengths_in = new I[matrix_size_in];
+  uint64_t *row_offsets_in = new uint64_t[matrix_size_in+1];
+  I *row_range_data = new I[matrix_size_in];
 
   double parallel_range = common::startClock();
-  common::par_for_range(num_threads,0,matrix_size_in,256,
-    //////////////////////////////////////////////////////////
-    [alloc_size,tid_alloc_size,selected_data_buffer,row_data_buffer,indices,cardinalities](size_t tid){
-      indices[tid * m] = 0;
-      cardinalities[tid * m] = 0;
-      row_data_buffer->allocate(tid);
-      selected_data_buffer->allocate(tid);
-      tid_alloc_size[tid * m] = 0;
+  uint8_t *row_data_in = pack_arena<T,I>(num_threads,matrix_size_in,
+    inputGraph->max_nbrhood_size,matrix_size_in,
+    [&](size_t i, I *selected, bool final_pass) -> size_t {
+      (void) final_pass;
+      return select_data<I>(i,inputGraph->out_neighborhoods->at(i),selected,node_selection,edge_selection);
     },
-    /////////////////////////////////////////////////////////////
-    [&row_range_data,alloc_size,tid_alloc_size,cardinalities,row_data_buffer,selected_data_buffer,row_arrays_in,indices,row_lengths_in,inputGraph,node_selection,edge_selection]
-    (size_t tid, size_t i) {
-      uint8_t * const row_data_in = row_data_buffer->data[tid];
-      uint32_t * const selected_data = selected_data_buffer->data[tid];
-
-      row_arrays_in[i] = &row_data_in[tid_alloc_size[tid*m]];
-      const pair<size_t,size_t> index_size = pack_data<T>(
-        i,
-        inputGraph->out_neighborhoods->at(i),
-        selected_data,
-        row_data_in,
-        tid_alloc_size[tid*m],
-        node_selection, //[](uint32_t n, uint32_t a) -> bool { (void) n; (void) a; return true; },
-        edge_selection, //[](uint32_t n1, uint32_t n2, uint32_t a) -> bool { (void) n1; (void) n2; (void) a; return true; },
-        row_range_data);
-      indices[tid * m] += (index_size.first-tid_alloc_size[tid*m]);
-      tid_alloc_size[tid*m] = index_size.first;
-      row_lengths_in[i] = index_size.second;
-      cardinalities[tid * m] += row_lengths_in[i];
-
-      //realloc to larger size if within 95% of original allocation
-      if(tid_alloc_size[tid*m] > (REALLOC_THRESHOLD*alloc_size)){
-        row_data_buffer->data[tid] = (uint8_t*) realloc((void *) row_data_buffer->data[tid], tid_alloc_size[tid*m]*sizeof(uint8_t));  
-        tid_alloc_size[tid*m] = 0;
-        row_data_buffer->data[tid] = new uint8_t[alloc_size];  
-      }
-    },
-    /////////////////////////////////////////////////////////////
-    [row_data_buffer,selected_data_buffer,cardinalities,&new_cardinality,&total_bytes_used,indices](size_t tid){
-      selected_data_buffer->unallocate(tid);
-      new_cardinality += cardinalities[tid * m];
-      total_bytes_used += indices[tid * m];
-    }
-  );
-  delete[] indices;
-  delete[] cardinalities;
+    row_lengths_in,row_offsets_in,row_range_data);
   common::stopClock("parallel section",parallel_range);
 
+  size_t new_cardinality = 0;
+  for(size_t i = 0; i < matrix_size_in; ++i){
+    new_cardinality += row_lengths_in[i];
+  }
+  const size_t total_bytes_used = row_offsets_in[matrix_size_in];
+
   cout << "Number of nodes: " << matrix_size_in << endl;
   cout << "Number of edges: " << new_cardinality << endl;
   cout << "ROW DATA SIZE (Bytes): " << total_bytes_used << endl;
   common::bits_per_edge = (8.0*(double)total_bytes_used)/new_cardinality;
-  double meta_overhead = 4*(common::num_bs+common::num_pshort+common::num_v+common::num_bp);
+  double meta_overhead = 4*(common::num_bs+common::num_pshort+common::num_v+common::num_bp+common::num_runs);
   common::bits_per_edge_nometa = (8.0*(double)(total_bytes_used-meta_overhead))/new_cardinality;
 
   return new SparseMatrix(matrix_size_in,new_cardinality,total_bytes_used,
     0,inputGraph->max_nbrhood_size,true,
-    row_lengths_in,row_arrays_in,row_range_data,
-    row_lengths_in,row_arrays_in,row_range_data,
-    inputGraph->id_map->data(),NULL,NULL,NULL);
+    row_lengths_in,row_offsets_in,row_data_in,row_range_data,
+    row_lengths_in,row_offsets_in,row_data_in,row_range_data,
+    inputGraph->id_map->data(),NULL,NULL,NULL,NULL,NULL);
 }
 
 //Directed Graph
-template<class T,class R>
-SparseMatrix<T,R>* SparseMatrix<T,R>::from_asymmetric_attribute_graph(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection, const size_t num_threads){
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_asymmetric_attribute_graph(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection, const size_t num_threads){
   
   const size_t matrix_size_in = inputGraph->num_nodes;
   const size_t cardinality_in = inputGraph->num_edges;
 
   cout << "Original nodes: " << matrix_size_in << " " << cardinality_in << endl;
 
- 
   const vector<uint32_t> *node_attr = inputGraph->node_attr;
   const vector<vector<uint32_t>*> *out_edge_attr = inputGraph->out_edge_attributes;
   const vector<vector<uint32_t>*> *in_edge_attr = inputGraph->in_edge_attributes;
 
   ops::prepare_shuffling_dictionary16();
 
-  size_t new_cardinality = 0;
-  size_t row_total_bytes_used = 0;
-  size_t col_total_bytes_used = 0;
-
-  uint32_t *old2newids = new uint32_t[matrix_size_in];
+  I *old2newids = new I[matrix_size_in];
+  I *new2oldids = new I[matrix_size_in];
   size_t new_num_nodes = 0;
 
   //Filter out nodes.
-  vector<vector<uint32_t>*> *out_edge_attributes_in = new vector<vector<uint32_t>*>();
-  vector<vector<uint32_t>*> *in_edge_attributes_in = new vector<vector<uint32_t>*>();
   for(size_t i = 0; i < matrix_size_in; ++i){
     if(node_selection(i,node_attr->at(i))){
-      out_edge_attributes_in->push_back(new std::vector<uint32_t>());
-      in_edge_attributes_in->push_back(new std::vector<uint32_t>());
+      new2oldids[new_num_nodes] = i;
       old2newids[i] = new_num_nodes++;
     } else{
-      old2newids[i] = 0xFFFFFFFF;
+      old2newids[i] = std::numeric_limits<I>::max();
     }
   }
 
   cout << "num nodes: " << new_num_nodes << endl;
 
   uint32_t *node_attributes_in = new uint32_t[new_num_nodes];
-  uint8_t **row_arrays_in = new uint8_t*[new_num_nodes];
-  uint32_t *row_lengths_in = new uint32_t[new_num_nodes];
-  uint8_t **col_arrays_in = new uint8_t*[new_num_nodes];
-  uint32_t *col_lengths_in = new uint32_t[new_num_nodes];
-
   uint64_t *new_imap = new uint64_t[new_num_nodes];  
-  const size_t alloc_size = (cardinality_in*sizeof(uint32_t)*ALLOCATOR)/num_threads;
+  for(size_t i = 0; i < new_num_nodes; ++i){
+    node_attributes_in[i] = node_attr->at(new2oldids[i]);
+    new_imap[i] = inputGraph->id_map->at(new2oldids[i]);
+  }
 
-  ParallelBuffer<uint8_t> *row_data_buffer = new ParallelBuffer<uint8_t>(num_threads,alloc_size);
-  ParallelBuffer<uint8_t> *col_data_buffer = new ParallelBuffer<uint8_t>(num_threads,alloc_size);
-  ParallelBuffer<uint32_t> *selected_data_buffer = new ParallelBuffer<uint32_t>(num_threads,alloc_size);
-  
-  const size_t m = PADDING;  //Don't ask don't tell.
-  size_t *row_indices = new size_t[num_threads*m];
-  size_t *col_indices = new size_t[num_threads*m];
-  size_t *cardinalities= new size_t[num_threads*m];
-  size_t *row_tid_alloc_size = new size_t[num_threads * m];
-  size_t *col_tid_alloc_size = new size_t[num_threads * m];
-
-  common::par_for_range(num_threads,0,matrix_size_in,100,
-    //////////////////////////////////////////////////////////
-    [row_tid_alloc_size,col_tid_alloc_size,&selected_data_buffer,&row_data_buffer,&col_data_buffer,&row_indices,&col_indices,&cardinalities](size_t tid){
-      row_indices[tid*m] = 0;
-      col_indices[tid*m] = 0;
-      cardinalities[tid*m] = 0;
-      row_data_buffer->allocate(tid);
-      col_data_buffer->allocate(tid);
-      selected_data_buffer->allocate(tid);
-      row_tid_alloc_size[tid * m] = 0;
-      col_tid_alloc_size[tid * m] = 0;
+  I *row_lengths_in = new I[new_num_nodes];
+  uint64_t *row_offsets_in = new uint64_t[new_num_nodes+1];
+  I *col_lengths_in = new I[new_num_nodes];
+  uint64_t *col_offsets_in = new uint64_t[new_num_nodes+1];
+  uint64_t *row_edge_offsets_in = new uint64_t[new_num_nodes+1];
+  uint64_t *col_edge_offsets_in = new uint64_t[new_num_nodes+1];
+  uint32_t *row_edge_attributes_in = NULL;
+  uint32_t *col_edge_attributes_in = NULL;
+
+  uint8_t *row_data_in = pack_arena<T,I>(num_threads,new_num_nodes,
+    inputGraph->max_nbrhood_size,new_num_nodes,
+    [&](size_t i, I *selected, bool final_pass) -> size_t {
+      const I old_id = new2oldids[i];
+      return select_attribute_data<I>(old_id,node_attr,out_edge_attr->at(old_id),
+        inputGraph->out_neighborhoods->at(old_id),selected,old2newids,
+        final_pass ? &row_edge_attributes_in[row_edge_offsets_in[i]] : NULL,
+        node_selection,edge_selection);
     },
-    /////////////////////////////////////////////////////////////
-    [alloc_size,row_tid_alloc_size,col_tid_alloc_size,cardinalities,row_data_buffer,col_data_buffer,selected_data_buffer,node_attr,
-      old2newids,new_imap,in_edge_attr,out_edge_attr,in_edge_attributes_in,out_edge_attributes_in,
-      row_arrays_in,col_arrays_in,node_attributes_in,
-      row_indices,col_indices,
-      &row_lengths_in,&col_lengths_in,
-      inputGraph,node_selection,edge_selection]
-    (size_t tid, size_t i) {
-      if(old2newids[i] != 0xFFFFFFFF){
-        new_imap[old2newids[i]] = inputGraph->id_map->at(i);
-
-        //////////////////////////////////////////////////////////////////
-        uint8_t * const row_data_in = row_data_buffer->data[tid];
-        uint32_t * const selected_data = selected_data_buffer->data[tid];
-        node_attributes_in[old2newids[i]] = node_attr->at(i);
-        row_arrays_in[old2newids[i]] = &row_data_in[row_tid_alloc_size[tid*m]];
-        pair<size_t,size_t> index_size = pack_attribute_data<T>(i,
-          node_attr,out_edge_attr->at(i),inputGraph->out_neighborhoods->at(i),
-          selected_data,old2newids,out_edge_attributes_in,
-          row_data_in,row_tid_alloc_size[tid*m],node_selection,edge_selection); 
-        row_indices[tid * m] += (index_size.first-row_tid_alloc_size[tid*m]);
-        row_tid_alloc_size[tid*m] = index_size.first;
-        row_lengths_in[old2newids[i]] = index_size.second;
-        //realloc to larger size if within 95% of original allocation
-        if(row_tid_alloc_size[tid*m] > (REALLOC_THRESHOLD*alloc_size)){
-          row_data_buffer->data[tid] = (uint8_t*) realloc((void *) row_data_buffer->data[tid], row_tid_alloc_size[tid*m]*sizeof(uint8_t));  
-          row_tid_alloc_size[tid*m] = 0;
-          row_data_buffer->data[tid] = new uint8_t[alloc_size];  
-        }
-
-        cardinalities[tid * m] += row_lengths_in[old2newids[i]];
-
-        //////////////////////////////////////////////////////////////////
-        uint8_t * const col_data_in = col_data_buffer->data[tid];
-        col_arrays_in[old2newids[i]] = &col_data_in[col_tid_alloc_size[tid*m]];          
-        index_size = pack_attribute_data<T>(i,
-          node_attr,in_edge_attr->at(i),inputGraph->in_neighborhoods->at(i),
-          selected_data,old2newids,in_edge_attributes_in,
-          col_data_in,col_tid_alloc_size[tid*m],node_selection,edge_selection);
-        col_indices[tid * m] += (index_size.first-col_tid_alloc_size[tid*m]);
-        col_tid_alloc_size[tid*m] = index_size.first;
-        col_lengths_in[old2newids[i]] = index_size.second;
-        //realloc to larger size if within 95% of original allocation
-        if(col_tid_alloc_size[tid*m] > (REALLOC_THRESHOLD*alloc_size)){
-          col_data_buffer->data[tid] = (uint8_t*) realloc((void *) col_data_buffer->data[tid], col_tid_alloc_size[tid*m]*sizeof(uint8_t));  
-          col_tid_alloc_size[tid*m] = 0;
-          col_data_buffer->data[tid] = new uint8_t[alloc_size];  
-        }
-
-        cardinalities[tid*m] += col_lengths_in[old2newids[i]];
-      }
+    row_lengths_in,row_offsets_in,NULL,
+    [&](){
+      row_edge_attributes_in = allocate_edge_attributes<I>(new_num_nodes,row_lengths_in,row_edge_offsets_in);
+    });
+
+  uint8_t *col_data_in = pack_arena<T,I>(num_threads,new_num_nodes,
+    inputGraph->max_nbrhood_size,new_num_nodes,
+    [&](size_t i, I *selected, bool final_pass) -> size_t {
+      const I old_id = new2oldids[i];
+      return select_attribute_data<I>(old_id,node_attr,in_edge_attr->at(old_id),
+        inputGraph->in_neighborhoods->at(old_id),selected,old2newids,
+        final_pass ? &col_edge_attributes_in[col_edge_offsets_in[i]] : NULL,
+        node_selection,edge_selection);
     },
-    ///////////////////////////////////////////////////////////////////////
-    [&row_data_buffer,&col_data_buffer,&selected_data_buffer,&cardinalities,
-      &new_cardinality,&row_total_bytes_used,&col_total_bytes_used,
-      &row_indices,&col_indices]
-    (size_t tid){
-      selected_data_buffer->unallocate(tid);
-      new_cardinality += cardinalities[tid*m];
-      row_total_bytes_used += row_indices[tid*m];
-      col_total_bytes_used += col_indices[tid*m];
-    }
-  );
-  delete[] row_indices;
-  delete[] col_indices;
-  delete[] cardinalities;
+    col_lengths_in,col_offsets_in,NULL,
+    [&](){
+      col_edge_attributes_in = allocate_edge_attributes<I>(new_num_nodes,col_lengths_in,col_edge_offsets_in);
+    });
+  delete[] old2newids;
+  delete[] new2oldids;
+
+  size_t new_cardinality = 0;
+  for(size_t i = 0; i < new_num_nodes; ++i){
+    new_cardinality += row_lengths_in[i] + col_lengths_in[i];
+  }
+  const size_t row_total_bytes_used = row_offsets_in[new_num_nodes];
+  const size_t col_total_bytes_used = col_offsets_in[new_num_nodes];
 
   cout << "Number of edges: " << new_cardinality << endl;
   cout << "ROW DATA SIZE (Bytes): " << row_total_bytes_used << endl;
   cout << "COL DATA SIZE (Bytes): " << col_total_bytes_used << endl;
 
-  return new SparseMatrix(new_num_nodes,new_cardinality,row_total_bytes_used,
+  SparseMatrix<T,R,I> *matrix = new SparseMatrix(new_num_nodes,new_cardinality,row_total_bytes_used,
     col_total_bytes_used,inputGraph->max_nbrhood_size,false,
-    row_lengths_in,row_arrays_in,NULL,
-    col_lengths_in,col_arrays_in,NULL,
-    new_imap,node_attributes_in,out_edge_attributes_in,in_edge_attributes_in);
+    row_lengths_in,row_offsets_in,row_data_in,NULL,
+    col_lengths_in,col_offsets_in,col_data_in,NULL,
+    new_imap,node_attributes_in,
+    row_edge_offsets_in,row_edge_attributes_in,col_edge_offsets_in,col_edge_attributes_in);
+  matrix->owns_node_arrays = true;
+  return matrix;
 }
 
-//Directed Graph
-template<class T,class R>
-SparseMatrix<T,R>* SparseMatrix<T,R>::from_asymmetric_noattribute_graph(MutableGraph* inputGraph,
-  const std::function<bool(uint32_t,uint32_t)> node_selection,
-  const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection, const size_t num_threads){
+/*
+Packs rows held as one contiguous neighbor array per side (row i of side s
+is neighbors[s][row_starts[s][i],row_starts[s][i+1])) without building a
+MutableGraph. Used for the binary formats that are mapped or decoded whole.
+*/
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_csr(const size_t matrix_size_in, const bool symmetric_in,
+  const size_t max_nbrhood_size_in, const uint64_t * const row_starts[2], const I * const neighbors[2],
+  const uint64_t *external_ids,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
+  const size_t num_threads){
 
-  const size_t matrix_size_in = inputGraph->num_nodes;
-  const size_t cardinality_in = inputGraph->num_edges;
+  ops::prepare_shuffling_dictionary16();
+  double stream_time = common::startClock();
+
+  const size_t num_sides = symmetric_in ? 1 : 2;
+  I *lengths[2] = {NULL,NULL};
+  uint64_t *offsets[2] = {NULL,NULL};
+  I *ranges[2] = {NULL,NULL};
+  uint8_t *arenas[2] = {NULL,NULL};
+  for(size_t s = 0; s < num_sides; s++){
+    const uint64_t *starts = row_starts[s];
+    const I *side_neighbors = neighbors[s];
+    lengths[s] = new I[matrix_size_in];
+    offsets[s] = new uint64_t[matrix_size_in+1];
+    ranges[s] = new I[matrix_size_in];
+    arenas[s] = pack_arena<T,I>(num_threads,matrix_size_in,max_nbrhood_size_in,matrix_size_in,
+      [&](size_t i, I *selected, bool final_pass) -> size_t {
+        (void) final_pass;
+        return select_data<I>(i,side_neighbors+starts[i],starts[i+1]-starts[i],
+          selected,node_selection,edge_selection);
+      },
+      lengths[s],offsets[s],ranges[s]);
+  }
+  uint64_t *id_map_in = new uint64_t[matrix_size_in];
+  memcpy(id_map_in,external_ids,sizeof(uint64_t)*matrix_size_in);
+
+  size_t new_cardinality = 0;
+  for(size_t s = 0; s < num_sides; s++){
+    for(size_t i = 0; i < matrix_size_in; ++i){
+      new_cardinality += lengths[s][i];
+    }
+  }
+  const size_t col = num_sides-1;
+  const size_t row_total_bytes_used = offsets[0][matrix_size_in];
+  const size_t col_total_bytes_used = symmetric_in ? 0 : offsets[col][matrix_size_in];
+  common::stopClock("streaming build",stream_time);
+
+  cout << "Number of nodes: " << matrix_size_in << endl;
+  cout << "Number of edges: " << new_cardinality << endl;
+  cout << "ROW DATA SIZE (Bytes): " << row_total_bytes_used << endl;
+  if(!symmetric_in)
+    cout << "COL DATA SIZE (Bytes): " << col_total_bytes_used << endl;
+
+  SparseMatrix<T,R,I> *matrix = new SparseMatrix(matrix_size_in,new_cardinality,row_total_bytes_used,
+    col_total_bytes_used,max_nbrhood_size_in,symmetric_in,
+    lengths[0],offsets[0],arenas[0],ranges[0],
+    lengths[col],offsets[col],arenas[col],ranges[col],
+    id_map_in,NULL,NULL,NULL,NULL,NULL);
+  matrix->owns_node_arrays = true;
+  slab::trim();
+  return matrix;
+}
+
+//Packs a version 2 binary file (see graph_binary) straight out of its mapping.
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_binary_v2(const string path, const bool symmetric_in,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
+  const size_t num_threads){
+
+  graph_binary::header h;
+  uint8_t *base = graph_binary::map(path,sizeof(I),symmetric_in,h);
+  const uint64_t *row_starts[2] = {(const uint64_t*)(base + h.out.offsets),(const uint64_t*)(base + h.in.offsets)};
+  const I *neighbors[2] = {(const I*)(base + h.out.data),(const I*)(base + h.in.data)};
+  SparseMatrix<T,R,I> *matrix = from_csr(h.num_nodes,symmetric_in,h.max_nbrhood_size,
+    row_starts,neighbors,(const uint64_t*)(base + h.id_map),node_selection,edge_selection,num_threads);
+  munmap(base,h.file_size);
+  return matrix;
+}
+
+/*
+Packs a compressed binary file (see compressed_graph). The blocks of every
+side are decoded in parallel into one neighbor array, which is then packed.
+*/
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_compressed_binary(const string path, const bool symmetric_in,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
+  const size_t num_threads){
+
+  if(sizeof(I) != sizeof(uint32_t)) {fputs ("Compressed graphs need 32-bit ids",stderr); exit (4);}
+  compressed_graph::header h;
+  uint8_t *base = compressed_graph::map(path,symmetric_in,h);
+
+  const size_t num_sides = symmetric_in ? 1 : 2;
+  const compressed_graph::section *sections[2] = {&h.out,&h.in};
+  uint64_t *row_starts[2] = {NULL,NULL};
+  I *neighbors[2] = {NULL,NULL};
+  for(size_t s = 0; s < num_sides; s++){
+    uint64_t *starts = new uint64_t[h.num_nodes+1];
+    compressed_graph::read_offsets(base,*sections[s],h.num_nodes,num_threads,starts);
+    I *side_neighbors = new I[starts[h.num_nodes]];
+    compressed_graph::decode_side<I>(base,*sections[s],num_threads,
+      [starts,side_neighbors](size_t i, size_t length) -> I* {
+        (void) length;
+        return side_neighbors + starts[i];
+      });
+    row_starts[s] = starts;
+    neighbors[s] = side_neighbors;
+  }
+  SparseMatrix<T,R,I> *matrix = from_csr(h.num_nodes,symmetric_in,h.max_nbrhood_size,
+    row_starts,neighbors,(const uint64_t*)(base + h.id_map),node_selection,edge_selection,num_threads);
+  munmap(base,h.file_size);
+  for(size_t s = 0; s < num_sides; s++){
+    delete[] row_starts[s];
+    delete[] neighbors[s];
+  }
+  return matrix;
+}
+
+/*
+Streams a file written by writeUndirectedToBinary (symmetric_in) or
+writeDirectedToBinary straight into the packed layout without building a
+MutableGraph. Neighborhoods are buffered in blocks of about
+STREAM_BLOCK_ELEMENTS ids and each block is sized and packed in parallel
+with the selections applied on the fly. As in the builders without
+attributes, node selection only filters neighbors. Files in version 2 of the
+format and compressed files are handed to from_binary_v2 and
+from_compressed_binary.
+*/
+static const size_t STREAM_BLOCK_ELEMENTS = 1 << 24;
+
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_binary(const string path, const bool symmetric_in,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection,
+  const size_t num_threads){
+
+  if(graph_binary::is_v2(path))
+    return from_binary_v2(path,symmetric_in,node_selection,edge_selection,num_threads);
+  if(compressed_graph::is_compressed(path))
+    return from_compressed_binary(path,symmetric_in,node_selection,edge_selection,num_threads);
+
+  //The reader thread fetches the next rows while a block is packed.
+  pipelined_io::stream infile(path);
+  const size_t file_size = infile.file_size();
+  const size_t matrix_size_in = infile.read<size_t>();
 
   ops::prepare_shuffling_dictionary16();
+  double stream_time = common::startClock();
+
+  struct stream_side{
+    I *lengths;
+    uint64_t *offsets;
+    I *ranges;
+    uint8_t *arena;
+    size_t capacity;
+    vector<I> block;
+    vector<size_t> starts;
+    size_t max_length;
+  };
+  const size_t num_sides = symmetric_in ? 1 : 2;
+  stream_side sides[2];
+  for(size_t s = 0; s < num_sides; s++){
+    sides[s].lengths = new I[matrix_size_in];
+    sides[s].offsets = new uint64_t[matrix_size_in+1];
+    sides[s].ranges = new I[matrix_size_in];
+    sides[s].offsets[0] = 0;
+    //The raw neighborhoods are a good first guess for the packed size.
+    sides[s].capacity = file_size/num_sides + ARENA_PADDING;
+    sides[s].arena = common::allocate_arena(sides[s].capacity);
+    sides[s].block.reserve(STREAM_BLOCK_ELEMENTS);
+    sides[s].starts.push_back(0);
+    sides[s].max_length = 0;
+  }
+  uint64_t *id_map_in = new uint64_t[matrix_size_in];
+  size_t max_nbrhood_size_in = 0;
+
+  //Sizes and packs the buffered rows [first,last) of every side.
+  auto flush = [&](const size_t first, const size_t last){
+    for(size_t s = 0; s < num_sides; s++){
+      stream_side &side = sides[s];
+      auto select_row = [&side,first,&node_selection,&edge_selection](size_t i, I *selected, bool final_pass) -> size_t {
+        (void) final_pass;
+        const size_t start = side.starts[i];
+        return select_data<I>(first+i,side.block.data()+start,side.starts[i+1]-start,
+          selected,node_selection,edge_selection);
+      };
+      const size_t end = size_rows<T,I>(num_threads,last-first,side.max_length,matrix_size_in,
+        select_row,&side.lengths[first],&side.offsets[first],&side.ranges[first]);
+      if(end + ARENA_PADDING > side.capacity){
+        side.capacity = max(2*side.capacity,end+ARENA_PADDING);
+        side.arena = slab::reallocate(side.arena,side.offsets[first],side.capacity);
+      }
+      pack_rows<T,I>(num_threads,last-first,side.max_length,select_row,&side.offsets[first],side.arena);
+
+      max_nbrhood_size_in = max(max_nbrhood_size_in,side.max_length);
+      side.block.clear();
+      side.starts.resize(1);
+      side.max_length = 0;
+    }
+  };
 
-  uint8_t **row_arrays_in = new uint8_t*[matrix_size_in];
-  uint32_t *row_lengths_in = new uint32_t[matrix_size_in];
-  uint8_t **col_arrays_in = new uint8_t*[matrix_size_in];
-  uint32_t *col_lengths_in = new uint32_t[matrix_size_in];
-  uint32_t *row_range_data = new uint32_t[matrix_size_in];
-  uint32_t *col_range_data = new uint32_t[matrix_size_in];
+  size_t block_first = 0;
+  for(size_t i = 0; i < matrix_size_in; ++i){
+    id_map_in[i] = infile.read<uint64_t>();
+    size_t block_elements = 0;
+    for(size_t s = 0; s < num_sides; s++){
+      stream_side &side = sides[s];
+      const size_t row_size = infile.read<size_t>();
+      const size_t start = side.block.size();
+      side.block.resize(start+row_size);
+      infile.read(side.block.data()+start,sizeof(I)*row_size);
+      side.starts.push_back(start+row_size);
+      side.max_length = max(side.max_length,row_size);
+      block_elements += side.block.size();
+    }
+    if(block_elements >= STREAM_BLOCK_ELEMENTS){
+      flush(block_first,i+1);
+      block_first = i+1;
+    }
+  }
+  flush(block_first,matrix_size_in);
 
   size_t new_cardinality = 0;
-  size_t row_total_bytes_used = 0;
-  size_t col_total_bytes_used = 0;
+  for(size_t s = 0; s < num_sides; s++){
+    const size_t total_bytes = sides[s].offsets[matrix_size_in];
+    memset(sides[s].arena+total_bytes,0,ARENA_PADDING);
+    for(size_t i = 0; i < matrix_size_in; ++i){
+      new_cardinality += sides[s].lengths[i];
+    }
+  }
+  const stream_side &col = sides[num_sides-1];
+  const size_t row_total_bytes_used = sides[0].offsets[matrix_size_in];
+  const size_t col_total_bytes_used = symmetric_in ? 0 : col.offsets[matrix_size_in];
+  common::stopClock("streaming build",stream_time);
 
-  const size_t alloc_size = (cardinality_in*sizeof(uint32_t)*ALLOCATOR)/num_threads;
+  cout << "Number of nodes: " << matrix_size_in << endl;
+  cout << "Number of edges: " << new_cardinality << endl;
+  cout << "ROW DATA SIZE (Bytes): " << row_total_bytes_used << endl;
+  if(!symmetric_in)
+    cout << "COL DATA SIZE (Bytes): " << col_total_bytes_used << endl;
+
+  SparseMatrix<T,R,I> *matrix = new SparseMatrix(matrix_size_in,new_cardinality,row_total_bytes_used,
+    col_total_bytes_used,max_nbrhood_size_in,symmetric_in,
+    sides[0].lengths,sides[0].offsets,sides[0].arena,sides[0].ranges,
+    col.lengths,col.offsets,col.arena,col.ranges,
+    id_map_in,NULL,NULL,NULL,NULL,NULL);
+  matrix->owns_node_arrays = true;
+  slab::trim();
+  return matrix;
+}
 
-  ParallelBuffer<uint8_t> *row_data_buffer = new ParallelBuffer<uint8_t>(num_threads,alloc_size);
-  ParallelBuffer<uint8_t> *col_data_buffer = new ParallelBuffer<uint8_t>(num_threads,alloc_size);
-  ParallelBuffer<uint32_t> *selected_data_buffer = new ParallelBuffer<uint32_t>(num_threads,alloc_size);
-  
-  const size_t m = PADDING;
-  size_t *row_indices = new size_t[num_threads*m];
-  size_t *col_indices = new size_t[num_threads*m];
-  size_t *cardinalities= new size_t[num_threads*m];
-  size_t *row_tid_alloc_size = new size_t[num_threads * m];
-  size_t *col_tid_alloc_size = new size_t[num_threads * m];
-
-  common::par_for_range(num_threads,0,matrix_size_in,100,
-    //////////////////////////////////////////////////////////
-    [row_tid_alloc_size,col_tid_alloc_size,selected_data_buffer,row_data_buffer,col_data_buffer,row_indices,col_indices,cardinalities](size_t tid){
-      row_indices[tid*m] = 0;
-      col_indices[tid*m] = 0;
-      cardinalities[tid*m] = 0;
-      row_data_buffer->allocate(tid);
-      col_data_buffer->allocate(tid);
-      selected_data_buffer->allocate(tid);
-      row_tid_alloc_size[tid * m] = 0;
-      col_tid_alloc_size[tid * m] = 0;
+//Directed Graph
+template<class T,class R,class I>
+SparseMatrix<T,R,I>* SparseMatrix<T,R,I>::from_asymmetric_noattribute_graph(BasicMutableGraph<I>* inputGraph,
+  const std::function<bool(I,uint32_t)> node_selection,
+  const std::function<bool(I,I,uint32_t)> edge_selection, const size_t num_threads){
+
+  const size_t matrix_size_in = inputGraph->num_nodes;
+
+  ops::prepare_shuffling_dictionary16();
+
+  I *row_lengths_in = new I[matrix_size_in];
+  uint64_t *row_offsets_in = new uint64_t[matrix_size_in+1];
+  I *col_lengths_in = new I[matrix_size_in];
+  uint64_t *col_offsets_in = new uint64_t[matrix_size_in+1];
+  I *row_range_data = new I[matrix_size_in];
+  I *col_range_data = new I[matrix_size_in];
+
+  uint8_t *row_data_in = pack_arena<T,I>(num_threads,matrix_size_in,
+    inputGraph->max_nbrhood_size,matrix_size_in,
+    [&](size_t i, I *selected, bool final_pass) -> size_t {
+      (void) final_pass;
+      return select_data<I>(i,inputGraph->out_neighborhoods->at(i),selected,node_selection,edge_selection);
     },
-    /////////////////////////////////////////////////////////////
-    [alloc_size,row_tid_alloc_size,col_tid_alloc_size,cardinalities,row_data_buffer,col_data_buffer,selected_data_buffer,
-      &row_arrays_in,&col_arrays_in,
-      &row_indices,&col_indices,
-      &row_lengths_in,&col_lengths_in,
-      &inputGraph,&node_selection,&edge_selection,&row_range_data,&col_range_data]
-    (size_t tid, size_t i) {
-      uint32_t * const selected_data = selected_data_buffer->data[tid];
-      uint8_t * const row_data_in = row_data_buffer->data[tid];
-
-      row_arrays_in[i] = &row_data_in[row_tid_alloc_size[tid*m]];  
-      pair<size_t,size_t> index_size = pack_data<T>(i,inputGraph->out_neighborhoods->at(i),
-        selected_data,row_data_in,row_tid_alloc_size[tid*m],node_selection,edge_selection,row_range_data); 
-      //cout << index_size.first << endl;
-      row_indices[tid * m] += (index_size.first-row_tid_alloc_size[tid*m]);
-      row_tid_alloc_size[tid*m] = index_size.first;
-      row_lengths_in[i] = index_size.second;
-      cardinalities[tid*m] += row_lengths_in[i];
-
-      //cout << row_tid_alloc_size[tid*m] << " " << row_indices[tid * m] << endl;
-      //realloc to larger size if within 95% of original allocation
-      if(row_tid_alloc_size[tid*m] > (REALLOC_THRESHOLD*alloc_size)){
-        row_data_buffer->data[tid] = (uint8_t*) realloc((void *) row_data_buffer->data[tid], row_tid_alloc_size[tid*m]*sizeof(uint8_t));  
-        row_tid_alloc_size[tid*m] = 0;
-        row_data_buffer->data[tid] = new uint8_t[alloc_size];  
-      }
+    row_lengths_in,row_offsets_in,row_range_data);
 
-      uint8_t * const col_data_in = col_data_buffer->data[tid];
-      col_arrays_in[i] = &col_data_in[col_tid_alloc_size[tid*m]];  
-      index_size = pack_data<T>(i,inputGraph->in_neighborhoods->at(i),
-        selected_data,col_data_in,col_tid_alloc_size[tid*m],node_selection,edge_selection,col_range_data); 
-      col_indices[tid * m] += (index_size.first-col_tid_alloc_size[tid*m]);
-      col_tid_alloc_size[tid*m] = index_size.first;
-      col_lengths_in[i] = index_size.second;
-      cardinalities[tid*m] += col_lengths_in[i];
-
-      //realloc to larger size if within 95% of original allocation
-      if(col_tid_alloc_size[tid*m] > (REALLOC_THRESHOLD*alloc_size)){
-        col_data_buffer->data[tid] = (uint8_t*) realloc((void *) col_data_buffer->data[tid], col_tid_alloc_size[tid*m]*sizeof(uint8_t));  
-        col_tid_alloc_size[tid*m] = 0;
-        col_data_buffer->data[tid] = new uint8_t[alloc_size];  
-      }
+  uint8_t *col_data_in = pack_arena<T,I>(num_threads,matrix_size_in,
+    inputGraph->max_nbrhood_size,matrix_size_in,
+    [&](size_t i, I *selected, bool final_pass) -> size_t {
+      (void) final_pass;
+      return select_data<I>(i,inputGraph->in_neighborhoods->at(i),selected,node_selection,edge_selection);
     },
-    /////////////////////////////////////////////////////////////
-    [&row_data_buffer,&col_data_buffer,&selected_data_buffer,&cardinalities,
-      &new_cardinality,&row_total_bytes_used,&col_total_bytes_used,
-      &row_indices,&col_indices]
-    (size_t tid){
-      selected_data_buffer->unallocate(tid);
-      new_cardinality += cardinalities[tid*m];
-      row_total_bytes_used += row_indices[tid*m];
-      col_total_bytes_used += col_indices[tid*m];
-    }
-  );
-  delete[] row_indices;
-  delete[] col_indices;
-  delete[] cardinalities;
+    col_lengths_in,col_offsets_in,col_range_data);
+
+  size_t new_cardinality = 0;
+  for(size_t i = 0; i < matrix_size_in; ++i){
+    new_cardinality += row_lengths_in[i] + col_lengths_in[i];
+  }
+  const size_t row_total_bytes_used = row_offsets_in[matrix_size_in];
+  const size_t col_total_bytes_used = col_offsets_in[matrix_size_in];
 
   cout << "Number of edges: " << new_cardinality << endl;
   cout << "ROW DATA SIZE (Bytes): " << row_total_bytes_used << endl;
@@ -754,8 +1398,8 @@ SparseMatrix<T,R>* SparseMatrix<T,R>::from_asymmetric_noattribute_graph(MutableG
 
   return new SparseMatrix(matrix_size_in,new_cardinality,row_total_bytes_used,
     col_total_bytes_used,inputGraph->max_nbrhood_size,false,
-    row_lengths_in,row_arrays_in,row_range_data,
-    col_lengths_in,col_arrays_in,col_range_data,
-    inputGraph->id_map->data(),NULL,NULL,NULL);
+    row_lengths_in,row_offsets_in,row_data_in,row_range_data,
+    col_lengths_in,col_offsets_in,col_data_in,col_range_data,
+    inputGraph->id_map->data(),NULL,NULL,NULL,NULL,NULL);
 }
 #endif
@@ -15,18 +15,24 @@
 #include <algorithm>  // for std::find
 #include <cstring>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <fcntl.h>    /* For O_RDWR */
 #include <unistd.h>   /* For open(), creat() */
 #include <math.h>
 #include <unistd.h>
 #include <thread>
+#include <mutex>
 #include <atomic>
 #include <tuple>
 #include <cstdarg>
 #include <set>
+#include <functional>
 
-static size_t ADDRESS_BITS_PER_BLOCK = 7;
-static size_t BLOCK_SIZE = 128;
+static const size_t ADDRESS_BITS_PER_BLOCK = 8;
+static const size_t BLOCK_SIZE = 256;
+//Most bytes a set operation writes per element of its result: a bitset_new
+//result can hold every element in a block of its own.
+static const size_t MAX_BYTES_PER_ELEMENT = sizeof(uint32_t)+BLOCK_SIZE/8;
 static double BITSET_THRESHOLD = 1.0 / 16.0;
 
 // Experts only! Proceed wih caution!
@@ -36,8 +42,8 @@ static double BITSET_THRESHOLD = 1.0 / 16.0;
 
 //TODO: Replace with new command line arguments.
 
-#define ALLOCATOR 4
-#define REALLOC_THRESHOLD 0.9
+//Slack at the end of packed row arenas for kernels that load whole vectors
+#define ARENA_PADDING 64
 
 //Needed for parallelization, prevents false sharing of cache lines
 #define PADDING 300
@@ -59,6 +65,9 @@ static double BITSET_THRESHOLD = 1.0 / 16.0;
 
 //#define STATS
 
+// Counts local and remote row bytes read in NUMA mode (--numa).
+//#define NUMA_STATS
+
 //CONSTANTS THAT SHOULD NOT CHANGE
 #define SHORTS_PER_REG 8
 #define INTS_PER_REG 4
@@ -67,23 +76,46 @@ static double BITSET_THRESHOLD = 1.0 / 16.0;
 using namespace std;
 using namespace std::placeholders;
 
+#include "numa_helper.hpp"
+#include "slab_allocator.hpp"
+
+//Mixes the bits of an external id (the finalizer of MurmurHash3).
+inline uint64_t id_hash(uint64_t id){
+  id ^= id >> 33;
+  id *= 0xff51afd7ed558ccdULL;
+  id ^= id >> 33;
+  id *= 0xc4ceb9fe1a85ec53ULL;
+  id ^= id >> 33;
+  return id;
+}
+
 namespace common{
   static size_t bitset_length = 0;
   static size_t pshort_requirement = 16;
   static double bitset_req = (1.0/256.0);
+  //Sets with at most this many runs per element are stored as runs.
+  static double runs_req = (1.0/16.0);
 
   static size_t tid = 0;
-  static uint8_t **scratch_space = new uint8_t*[MAX_THREADS];
-  static uint8_t **scratch_space1 = new uint8_t*[MAX_THREADS];
+  static uint8_t **scratch_space = new uint8_t*[MAX_THREADS]();
+  static uint8_t **scratch_space1 = new uint8_t*[MAX_THREADS]();
 
+  //Replaces the scratch space of a previous build.
   static void alloc_scratch_space(size_t alloc_size, size_t num_threads){
     for(size_t i = 0; i < num_threads; i++){
-      scratch_space[i] = new uint8_t[alloc_size];
-      scratch_space1[i] = new uint8_t[alloc_size];
-
+      slab::release(scratch_space[i]);
+      slab::release(scratch_space1[i]);
+      scratch_space[i] = slab::allocate(alloc_size);
+      scratch_space1[i] = slab::allocate(alloc_size);
     }
   }
 
+  //Allocates an arena for packed rows, release with slab::release(). Large
+  //arenas are aligned to and advised for transparent huge pages.
+  static inline uint8_t* allocate_arena(const size_t num_bytes){
+    return slab::allocate(num_bytes);
+  }
+
   static double startClock (){
     return omp_get_wtime();
   }
@@ -158,6 +190,7 @@ namespace common{
   static size_t num_uint = 0;
   static size_t num_bp = 0;
   static size_t num_v = 0;
+  static size_t num_runs = 0;
   static double bits_per_edge = 0;
   static double bits_per_edge_nometa = 0;
 
@@ -177,7 +210,9 @@ namespace common{
     HYBRID = 5,
     KUNLE = 6,
     BITSET_NEW = 7,
-    NEW_TYPE = 8
+    NEW_TYPE = 8,
+    ROARING = 9,
+    RUNS = 10
   };
 
   enum graph_type {
@@ -185,6 +220,13 @@ namespace common{
     UNDIRECTED
   };
 
+  //Order in which pruned symmetric builds compare the endpoints of an edge.
+  enum orientation {
+    ID_ORDER,
+    DEGREE_ORDER,
+    DEGENERACY_ORDER
+  };
+
   static void dump_stats(){
     cout << endl;
     cout << "Num Bitset: " << num_bs << endl;
@@ -193,6 +235,7 @@ namespace common{
     cout << "Num Uint: " << num_uint << endl;
     cout << "Num BP: " << num_bp << endl;
     cout << "Num V: " << num_v << endl;
+    cout << "Num Runs: " << num_runs << endl;
     cout << "Bits per edge (meta): " << bits_per_edge << endl;
     cout << "Bits per edge (no meta): " << bits_per_edge_nometa << endl;
 
@@ -233,22 +276,48 @@ namespace common{
         std::atomic<size_t> next_work;
         next_work = 0;
 
+        //In NUMA mode every node has its own work counter over its partition.
+        const size_t num_partitions = numa_helper::enabled ? numa_helper::num_nodes() : 0;
+        std::atomic<size_t>* next_partition_work = new std::atomic<size_t>[num_partitions];
+        for(size_t p = 0; p < num_partitions; p++) {
+           next_partition_work[p] = numa_helper::partition_start(p,from,to);
+        }
+
         for(size_t k = 0; k < real_num_threads; k++) {
-           threads[k] = thread([&block_size](double t_begin, double* thread_times, int k, std::atomic<size_t>* next_work, size_t offset, size_t range_len, std::function<void(size_t, size_t)> body) -> void {
+           threads[k] = thread([&block_size,&from,&to,&real_num_threads,&num_partitions,&next_partition_work](double t_begin, double* thread_times, int k, std::atomic<size_t>* next_work, size_t offset, size_t range_len, std::function<void(size_t, size_t)> body) -> void {
               size_t local_block_size = block_size;
 
-              while(true) {
-                 size_t work_start = next_work->fetch_add(local_block_size, std::memory_order_relaxed);
-                 if(work_start > range_len)
-                    break;
-
-                 size_t work_end = min(work_start + local_block_size, range_len);
-                 local_block_size = block_size;//100 + (work_start / range_len) * block_size;
-                 for(size_t j = work_start; j < work_end; j++) {
-                     body(k, offset + j);
+              //Drain the partition of the own node first, then help the others.
+              if(num_partitions > 0) {
+                 numa_helper::pin_worker(k,real_num_threads);
+                 for(size_t p = 0; p < num_partitions; p++) {
+                    const size_t partition = (numa_helper::worker_node + p) % num_partitions;
+                    const size_t partition_end = numa_helper::partition_start(partition+1,from,to);
+                    while(true) {
+                       size_t work_start = next_partition_work[partition].fetch_add(block_size, std::memory_order_relaxed);
+                       if(work_start >= partition_end)
+                          break;
+                       size_t work_end = min(work_start + block_size, partition_end);
+                       for(size_t j = work_start; j < work_end; j++) {
+                          body(k, j);
+                       }
+                    }
+                 }
+                 numa_helper::worker_id = -1;
+              }
+              else {
+                 while(true) {
+                    size_t work_start = next_work->fetch_add(local_block_size, std::memory_order_relaxed);
+                    if(work_start > range_len)
+                       break;
+
+                    size_t work_end = min(work_start + local_block_size, range_len);
+                    local_block_size = block_size;//100 + (work_start / range_len) * block_size;
+                    for(size_t j = work_start; j < work_end; j++) {
+                        body(k, offset + j);
+                    }
                  }
               }
-
 
 #ifdef ENABLE_PRINT_THREAD_TIMES
               double t_end = omp_get_wtime();
@@ -263,6 +332,8 @@ namespace common{
         for(size_t k = 0; k < real_num_threads; k++) {
            threads[k].join();
         }
+        delete[] threads;
+        delete[] next_partition_work;
 
 #ifdef ENABLE_PRINT_THREAD_TIMES
         for(size_t k = 0; k < real_num_threads; k++){
@@ -308,10 +379,11 @@ namespace common{
     return real_num_threads;
   }
 
-  static vector<uint32_t> range(uint32_t max) {
-    vector<uint32_t> result;
+  template<class I>
+  static vector<I> range(const size_t max) {
+    vector<I> result;
     result.reserve(max);
-    for(uint32_t i = 0; i < max; i++)
+    for(size_t i = 0; i < max; i++)
       result.push_back(i);
     return result;
   }
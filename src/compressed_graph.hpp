@@ -0,0 +1,244 @@
+#ifndef _COMPRESSED_GRAPH_HPP_
+#define _COMPRESSED_GRAPH_HPP_
+
+/*
+COMPRESSED BINARY GRAPH FORMAT FOR STORAGE WHERE READ BANDWIDTH IS THE LIMIT.
+NEIGHBORHOODS ARE DELTA ENCODED AND BIT PACKED WITH THE BITPACKED LAYOUT AND
+CONSECUTIVE ROWS ARE GROUPED INTO BLOCKS OF ABOUT BLOCK_ELEMENTS NEIGHBORS.
+A BLOCK INDEX GIVES THE FIRST ROW AND BYTE OFFSET OF EVERY BLOCK, SO BLOCKS
+ARE ENCODED AND DECODED INDEPENDENTLY BY THE WORKERS OF PAR_FOR_RANGE.
+
+  header | id map | out block index | out blocks |
+  (directed only) in block index | in blocks
+
+Inside a block every row is its length and its number of encoded bytes (both
+LEB128) followed by the output of bitpacked::build. The block index has a
+sentinel entry, the blocks are followed by DECODE_PADDING zero bytes for the
+vector loads of the decoder. Ids are 32-bit, the width of the encoder.
+*/
+namespace compressed_graph {
+  static const uint64_t MAGIC = 0x4348504152474845ULL; // "EHGRAPHC"
+  static const uint32_t VERSION = 1;
+  static const size_t ALIGNMENT = 64;
+  static const size_t BLOCK_ELEMENTS = 1 << 16;
+  static const size_t DECODE_PADDING = 64;
+
+  struct block{
+    uint64_t first_row;
+    uint64_t offset;
+  };
+
+  struct section{
+    uint64_t num_blocks;
+    uint64_t block_index;
+    uint64_t data;
+    uint64_t data_bytes;
+  };
+
+  struct header{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t symmetric;
+    uint64_t num_nodes;
+    uint64_t num_edges;
+    uint64_t max_nbrhood_size;
+    uint64_t id_map;
+    section out;
+    section in;
+    uint64_t file_size;
+  };
+
+  inline size_t align(const size_t offset){
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  inline bool is_compressed(const string path){
+    uint64_t magic = 0;
+    FILE *pFile = fopen(path.c_str(),"r");
+    if (pFile==NULL) {fputs ("File error",stderr); exit (1);}
+    const bool has_magic = fread(&magic,sizeof(magic),1,pFile) == 1 && magic == MAGIC;
+    fclose(pFile);
+    return has_magic;
+  }
+
+  inline size_t write_varint(uint8_t *out, size_t pos, uint64_t value){
+    while(value >= 0x80){
+      out[pos++] = (uint8_t)(value | 0x80);
+      value >>= 7;
+    }
+    out[pos++] = (uint8_t)value;
+    return pos;
+  }
+
+  inline uint64_t read_varint(const uint8_t *in, size_t &pos){
+    uint64_t value = 0;
+    size_t shift = 0;
+    while(in[pos] & 0x80){
+      value |= (uint64_t)(in[pos++] & 0x7f) << shift;
+      shift += 7;
+    }
+    value |= (uint64_t)in[pos++] << shift;
+    return value;
+  }
+
+  //Upper bound of the encoded size of a row: two varints and a bit packed
+  //set, which is never larger than a varint per element plus its header.
+  inline size_t max_row_bytes(const size_t length){
+    return 2*10 + 1 + 5*length + 16;
+  }
+
+  /*
+  Encodes the rows of one side and writes them and their block index at the
+  next aligned positions. Rows are cut into blocks of about BLOCK_ELEMENTS
+  neighbors and the blocks are encoded in parallel.
+  */
+  template<class I>
+  void write_side(ofstream &outfile, size_t &position, section &sec,
+    const vector< vector<I>* > *neighborhoods, const size_t num_threads){
+
+    const size_t num_nodes = neighborhoods->size();
+    vector<block> blocks;
+    size_t block_elements = BLOCK_ELEMENTS;
+    for(size_t i = 0; i < num_nodes; i++){
+      if(block_elements >= BLOCK_ELEMENTS){
+        block b;
+        b.first_row = i;
+        b.offset = 0;
+        blocks.push_back(b);
+        block_elements = 0;
+      }
+      block_elements += neighborhoods->at(i)->size();
+    }
+    const size_t num_blocks = blocks.size();
+    block sentinel;
+    sentinel.first_row = num_nodes;
+    sentinel.offset = 0;
+    blocks.push_back(sentinel);
+
+    vector< vector<uint8_t> > encoded(num_blocks);
+    common::par_for_range(num_threads,0,num_blocks,1,
+      [&](size_t tid, size_t b){
+        (void) tid;
+        size_t bound = 0;
+        size_t max_length = 0;
+        for(size_t i = blocks[b].first_row; i < blocks[b+1].first_row; i++){
+          bound += max_row_bytes(neighborhoods->at(i)->size());
+          max_length = max(max_length,neighborhoods->at(i)->size());
+        }
+        vector<uint8_t> &out = encoded[b];
+        vector<uint8_t> packed(max_row_bytes(max_length));
+        out.resize(bound);
+        size_t pos = 0;
+        for(size_t i = blocks[b].first_row; i < blocks[b+1].first_row; i++){
+          const vector<I> *row = neighborhoods->at(i);
+          const size_t num_bytes = bitpacked::build(packed.data(),(const uint32_t*)row->data(),row->size());
+          pos = write_varint(out.data(),pos,row->size());
+          pos = write_varint(out.data(),pos,num_bytes);
+          memcpy(out.data()+pos,packed.data(),num_bytes);
+          pos += num_bytes;
+        }
+        out.resize(pos);
+      });
+
+    size_t data_bytes = 0;
+    for(size_t b = 0; b < num_blocks; b++){
+      blocks[b].offset = data_bytes;
+      data_bytes += encoded[b].size();
+    }
+    blocks[num_blocks].offset = data_bytes;
+
+    const char padding[DECODE_PADDING] = {0};
+    auto start_section = [&]() -> uint64_t {
+      const size_t start = align(position);
+      outfile.write(padding,start-position);
+      position = start;
+      return start;
+    };
+    sec.num_blocks = num_blocks;
+    sec.data_bytes = data_bytes;
+    sec.block_index = start_section();
+    outfile.write((char*)blocks.data(),sizeof(block)*(num_blocks+1));
+    position += sizeof(block)*(num_blocks+1);
+    sec.data = start_section();
+    for(size_t b = 0; b < num_blocks; b++){
+      outfile.write((char*)encoded[b].data(),encoded[b].size());
+    }
+    outfile.write(padding,DECODE_PADDING);
+    position += data_bytes + DECODE_PADDING;
+  }
+
+  //Maps a compressed file read-only, release with munmap(base,h.file_size).
+  inline uint8_t* map(const string path, const bool symmetric, header &h){
+    int fd = open(path.c_str(),O_RDONLY);
+    if (fd == -1) {fputs ("File error",stderr); exit (1);}
+    if(read(fd,&h,sizeof(h)) != (ssize_t)sizeof(h)) {fputs ("Reading error",stderr); exit (3);}
+    if(h.magic != MAGIC || h.version != VERSION) {fputs ("Compressed graph format error",stderr); exit (4);}
+    if((h.symmetric != 0) != symmetric) {fputs ("Compressed graph has the wrong direction",stderr); exit (4);}
+    struct stat file_stat;
+    fstat(fd,&file_stat);
+    if((size_t)file_stat.st_size < h.file_size) {fputs ("Compressed graph is truncated",stderr); exit (3);}
+
+    uint8_t *base = (uint8_t*) mmap(NULL,h.file_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(base == MAP_FAILED) {fputs ("Memory error",stderr); exit (2);}
+    //The blocks are decoded out of order, read the whole file ahead.
+    madvise(base,h.file_size,MADV_WILLNEED);
+    return base;
+  }
+
+  /*
+  Decodes the blocks of one side in parallel. destination(row,length) returns
+  where the length neighbors of row are written, it is called once per row
+  from the worker that decodes the row's block.
+  */
+  template<class I>
+  void decode_side(const uint8_t *base, const section &sec, const size_t num_threads,
+    const std::function<I*(size_t,size_t)> destination){
+
+    const block *blocks = (const block*)(base + sec.block_index);
+    const uint8_t *data = base + sec.data;
+    common::par_for_range(num_threads,0,sec.num_blocks,1,
+      [&](size_t tid, size_t b){
+        (void) tid;
+        size_t pos = blocks[b].offset;
+        for(size_t i = blocks[b].first_row; i < blocks[b+1].first_row; i++){
+          const size_t length = read_varint(data,pos);
+          const size_t num_bytes = read_varint(data,pos);
+          I *row = destination(i,length);
+          if(length > 0){
+            size_t j = 0;
+            bitpacked::foreach([row,&j](uint32_t nbr){
+              row[j++] = nbr;
+            },data+pos,length,num_bytes,common::BITPACKED);
+          }
+          pos += num_bytes;
+        }
+      });
+  }
+
+  /*
+  Exclusive prefix sum of the row lengths of one side into offsets (one per
+  row plus a sentinel). Only the row headers are read.
+  */
+  inline void read_offsets(const uint8_t *base, const section &sec, const size_t num_nodes,
+    const size_t num_threads, uint64_t *offsets){
+
+    const block *blocks = (const block*)(base + sec.block_index);
+    const uint8_t *data = base + sec.data;
+    offsets[0] = 0;
+    common::par_for_range(num_threads,0,sec.num_blocks,1,
+      [&](size_t tid, size_t b){
+        (void) tid;
+        size_t pos = blocks[b].offset;
+        for(size_t i = blocks[b].first_row; i < blocks[b+1].first_row; i++){
+          offsets[i+1] = read_varint(data,pos);
+          pos += read_varint(data,pos);
+        }
+      });
+    for(size_t i = 0; i < num_nodes; i++){
+      offsets[i+1] += offsets[i];
+    }
+  }
+}
+
+#endif
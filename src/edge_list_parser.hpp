@@ -0,0 +1,256 @@
+#ifndef _EDGE_LIST_PARSER_HPP_
+#define _EDGE_LIST_PARSER_HPP_
+
+/*
+PARALLEL PARSER FOR TEXT EDGE LISTS ("SRC DST" PER LINE). EVERY BUFFER OF THE
+PIPELINED READER IS CUT INTO CHUNKS AT NEWLINES AND EVERY CHUNK IS PARSED ON
+ITS OWN, INTERNING ITS IDS IN A LOCAL DICTIONARY. THE LOCAL DICTIONARIES ARE
+THEN MERGED INTO A GLOBAL ONE THAT IS PARTITIONED INTO SHARDS BY THE HASH OF
+THE ID, ONE WORKER PER SHARD. CHUNKS ARE MERGED IN FILE ORDER, SO AN ID IS
+NEW IN EXACTLY THE CHUNK OF ITS FIRST APPEARANCE AND INTERNAL IDS FOLLOW THE
+ORDER OF FIRST APPEARANCE IN THE FILE, LIKE THE SEQUENTIAL LOADERS ASSIGN THEM.
+*/
+
+namespace edge_list {
+  //Chunks are cut at newlines and hold at least this many bytes.
+  static const size_t MIN_CHUNK_BYTES = 64*1024;
+  //Shards of the global dictionary per thread.
+  static const size_t SHARDS_PER_THREAD = 4;
+
+  struct chunk {
+    const char *begin;       //text of the chunk while its buffer is held
+    const char *end;
+    vector<uint64_t> ids;    //distinct ids of the chunk in order of first appearance
+    vector<size_t> edges;    //src,dst pairs, indices into ids until translated to internal ids
+    vector<uint8_t> first;   //ids[k] appears in no earlier chunk
+    vector< vector<size_t> > shard_members; //indices into ids per shard
+    size_t id_base;          //internal id of the first new id of the chunk
+  };
+
+  static size_t default_num_threads(){
+    const size_t num_cpus = std::thread::hardware_concurrency();
+    return (num_cpus == 0) ? 1 : min(num_cpus,(size_t)MAX_THREADS);
+  }
+
+  //Parses the next unsigned integer of the current line, false at the end of the line.
+  static inline bool parse_id(const char *&p, const char * const end, uint64_t &id){
+    while(p < end && *p != '\n' && (*p < '0' || *p > '9'))
+      p++;
+    if(p == end || *p == '\n')
+      return false;
+    uint64_t value = 0;
+    while(p < end && *p >= '0' && *p <= '9'){
+      value = value*10 + (*p - '0');
+      p++;
+    }
+    id = value;
+    return true;
+  }
+
+  //Lines starting with # or % are comments, further columns of a line are ignored.
+  static void parse_chunk(chunk &c, const size_t num_shards){
+    unordered_map<uint64_t,size_t> local_ids;
+    auto intern = [&](const uint64_t id) -> size_t {
+      unordered_map<uint64_t,size_t>::iterator it = local_ids.find(id);
+      if(it != local_ids.end())
+        return it->second;
+      const size_t k = c.ids.size();
+      local_ids.insert(make_pair(id,k));
+      c.ids.push_back(id);
+      return k;
+    };
+
+    const char *p = c.begin;
+    while(p < c.end){
+      if(*p != '#' && *p != '%'){
+        uint64_t src;
+        uint64_t dst;
+        if(parse_id(p,c.end,src) && parse_id(p,c.end,dst)){
+          c.edges.push_back(intern(src));
+          c.edges.push_back(intern(dst));
+        }
+      }
+      while(p < c.end && *p != '\n')
+        p++;
+      p++;
+    }
+
+    c.first.assign(c.ids.size(),0);
+    c.shard_members.resize(num_shards);
+    for(size_t k = 0; k < c.ids.size(); k++){
+      c.shard_members[id_hash(c.ids[k]) % num_shards].push_back(k);
+    }
+  }
+
+  /*
+  Parses the edge list at path. Fills id_map (internal to external ids) and
+  returns the chunks, whose edges hold src,dst pairs of internal ids. The file
+  arrives in buffers from a pipelined reader, the chunks of one buffer are
+  parsed while the next buffer is read.
+  */
+  template<class I>
+  static vector<chunk>* parse(const string path, const size_t num_threads, vector<uint64_t> *id_map){
+    const size_t num_shards = num_threads*SHARDS_PER_THREAD;
+    vector<chunk> *chunks = new vector<chunk>();
+    pipelined_io::reader in(path,true);
+    while(const pipelined_io::buffer *b = in.next()){
+      const size_t first_chunk = chunks->size();
+      const size_t num_buffer_chunks = max((size_t)1,min(num_threads,b->size/MIN_CHUNK_BYTES));
+      const char *data = b->data;
+      const char *position = data;
+      for(size_t c = 0; c < num_buffer_chunks; c++){
+        const char *end = data + (b->size*(c+1))/num_buffer_chunks;
+        if(end < position)
+          end = position;
+        while(end < data + b->size && end[-1] != '\n')
+          end++;
+        chunks->push_back(chunk());
+        chunks->back().begin = position;
+        chunks->back().end = end;
+        position = end;
+      }
+
+      common::par_for_range(num_threads,first_chunk,chunks->size(),1,
+        [&](size_t tid, size_t c){
+          (void) tid;
+          parse_chunk(chunks->at(c),num_shards);
+          //The text is gone once the buffer is given back.
+          chunks->at(c).begin = NULL;
+          chunks->at(c).end = NULL;
+        });
+    }
+    const size_t num_chunks = chunks->size();
+
+    //Chunks are merged in file order, so the first insert of an id is its first appearance.
+    vector< unordered_map<uint64_t,I> > dictionary(num_shards);
+    common::par_for_range(num_threads,0,num_shards,1,
+      [&](size_t tid, size_t s){
+        (void) tid;
+        for(size_t c = 0; c < num_chunks; c++){
+          chunk &ch = chunks->at(c);
+          for(size_t j = 0; j < ch.shard_members[s].size(); j++){
+            const size_t k = ch.shard_members[s][j];
+            if(dictionary[s].insert(make_pair(ch.ids[k],(I)0)).second)
+              ch.first[k] = 1;
+          }
+          vector<size_t>().swap(ch.shard_members[s]);
+        }
+      });
+
+    vector<size_t> num_new_ids(num_chunks);
+    common::par_for_range(num_threads,0,num_chunks,1,
+      [&](size_t tid, size_t c){
+        (void) tid;
+        num_new_ids[c] = std::count(chunks->at(c).first.begin(),chunks->at(c).first.end(),1);
+      });
+    size_t num_ids = 0;
+    for(size_t c = 0; c < num_chunks; c++){
+      chunks->at(c).id_base = num_ids;
+      num_ids += num_new_ids[c];
+    }
+    //The largest I marks missing ids.
+    if(num_ids >= (size_t)std::numeric_limits<I>::max()) {fputs ("Too many nodes for the index type",stderr); exit (4);}
+    id_map->resize(num_ids);
+
+    //Every id is new in exactly one chunk, which owns its dictionary entry.
+    common::par_for_range(num_threads,0,num_chunks,1,
+      [&](size_t tid, size_t c){
+        (void) tid;
+        chunk &ch = chunks->at(c);
+        size_t next_id = ch.id_base;
+        for(size_t k = 0; k < ch.ids.size(); k++){
+          if(ch.first[k]){
+            id_map->at(next_id) = ch.ids[k];
+            dictionary[id_hash(ch.ids[k]) % num_shards].find(ch.ids[k])->second = next_id++;
+          }
+        }
+      });
+
+    common::par_for_range(num_threads,0,num_chunks,1,
+      [&](size_t tid, size_t c){
+        (void) tid;
+        chunk &ch = chunks->at(c);
+        vector<size_t> internal_ids(ch.ids.size());
+        for(size_t k = 0; k < ch.ids.size(); k++){
+          internal_ids[k] = dictionary[id_hash(ch.ids[k]) % num_shards].find(ch.ids[k])->second;
+        }
+        for(size_t e = 0; e < ch.edges.size(); e++){
+          ch.edges[e] = internal_ids[ch.edges[e]];
+        }
+        vector<uint64_t>().swap(ch.ids);
+        vector<uint8_t>().swap(ch.first);
+      });
+
+    return chunks;
+  }
+
+  static size_t num_edges(const vector<chunk> &chunks){
+    size_t count = 0;
+    for(size_t c = 0; c < chunks.size(); c++){
+      count += chunks[c].edges.size()/2;
+    }
+    return count;
+  }
+
+  template<class I>
+  static vector< vector<I>* >* new_neighborhoods(const size_t num_nodes){
+    vector< vector<I>* > *neighborhoods = new vector< vector<I>* >(num_nodes);
+    for(size_t i = 0; i < num_nodes; i++){
+      neighborhoods->at(i) = new vector<I>();
+    }
+    return neighborhoods;
+  }
+
+  /*
+  Appends dst to the out neighborhood of src and src to the in neighborhood
+  of dst for every edge. Pass the same neighborhoods twice for an undirected
+  graph. Neighborhoods are sized exactly from counted degrees and filled in
+  parallel, so their order is arbitrary until sort_neighborhoods.
+  */
+  template<class I>
+  static void fill_neighborhoods(const vector<chunk> &chunks, const size_t num_threads,
+    vector< vector<I>* > *out_neighborhoods, vector< vector<I>* > *in_neighborhoods){
+
+    const size_t num_nodes = out_neighborhoods->size();
+    const bool symmetric = (out_neighborhoods == in_neighborhoods);
+    size_t *out_cursor = new size_t[num_nodes]();
+    size_t *in_cursor = symmetric ? out_cursor : new size_t[num_nodes]();
+
+    common::par_for_range(num_threads,0,chunks.size(),1,
+      [&](size_t tid, size_t c){
+        (void) tid;
+        const vector<size_t> &edges = chunks[c].edges;
+        for(size_t e = 0; e < edges.size(); e += 2){
+          __sync_fetch_and_add(&out_cursor[edges[e]],1);
+          __sync_fetch_and_add(&in_cursor[edges[e+1]],1);
+        }
+      });
+    common::par_for_range(num_threads,0,num_nodes,4096,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        out_neighborhoods->at(i)->resize(out_cursor[i]);
+        out_cursor[i] = 0;
+        if(!symmetric){
+          in_neighborhoods->at(i)->resize(in_cursor[i]);
+          in_cursor[i] = 0;
+        }
+      });
+    common::par_for_range(num_threads,0,chunks.size(),1,
+      [&](size_t tid, size_t c){
+        (void) tid;
+        const vector<size_t> &edges = chunks[c].edges;
+        for(size_t e = 0; e < edges.size(); e += 2){
+          const size_t src = edges[e];
+          const size_t dst = edges[e+1];
+          out_neighborhoods->at(src)->at(__sync_fetch_and_add(&out_cursor[src],1)) = dst;
+          in_neighborhoods->at(dst)->at(__sync_fetch_and_add(&in_cursor[dst],1)) = src;
+        }
+      });
+
+    delete[] out_cursor;
+    if(!symmetric)
+      delete[] in_cursor;
+  }
+}
+
+#endif
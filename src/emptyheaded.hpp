@@ -14,6 +14,11 @@ class application{
     string layout;
     size_t query_depth;
     long start_node;
+    string snapshot_path;
+    snapshot::source snapshot_source;
+    string stream_path;
+    bool stream_symmetric;
+    common::orientation orientation;
 
     application(Parser input_data) {
       input_graph = input_data.input_graph; 
@@ -21,6 +26,40 @@ class application{
       layout = input_data.layout;
       query_depth = input_data.n;
       start_node = input_data.start_node;
+      snapshot_path = input_data.snapshot_path;
+      snapshot_source = input_data.snapshot_source;
+      stream_path = input_data.stream_path;
+      stream_symmetric = input_data.stream_symmetric;
+      orientation = input_data.orientation;
+    }
+
+    //Builds the matrix from the input graph, or streams it from a binary file.
+    //With a snapshot path the matrix is mapped from the snapshot when neither
+    //was given, and written out after the build otherwise. A snapshot built
+    //from another source is refused. In NUMA mode the
+    //matrix is then spread across the nodes.
+    SparseMatrix<T,R>* build_graph(
+      const std::function<bool(uint32_t,uint32_t)> node_selection,
+      const std::function<bool(uint32_t,uint32_t,uint32_t)> edge_selection){
+      SparseMatrix<T,R>* matrix;
+      if(!stream_path.empty()){
+        matrix = SparseMatrix<T,R>::from_binary(stream_path,stream_symmetric,node_selection,edge_selection,num_threads);
+      } else if(input_graph == NULL){
+        matrix = SparseMatrix<T,R>::from_snapshot(snapshot_path,snapshot_source);
+      } else{
+        matrix = SparseMatrix<T,R>::build(input_graph,node_selection,edge_selection,num_threads,orientation);
+      }
+      if(!snapshot_path.empty() && (input_graph != NULL || !stream_path.empty())){
+        matrix->write_snapshot(snapshot_path,snapshot_source);
+      }
+      if(numa_helper::enabled){
+        matrix->place_on_numa_nodes();
+      }
+      common::alloc_scratch_space(512 * matrix->max_nbrhood_size * sizeof(uint32_t), num_threads);
+      #ifdef STATS
+      slab::print_stats();
+      #endif
+      return matrix;
     }
 
     virtual void run() = 0;
@@ -39,8 +78,6 @@ int main (int argc, char* argv[]) {
   std::string app = s.substr(s.size()-count,count+1);
 
   Parser input_data = input_parser::parse(argc, argv, app);
-  
-  common::alloc_scratch_space(512 * input_data.input_graph->max_nbrhood_size * sizeof(uint32_t), input_data.num_threads);
 
   if(input_data.layout.compare("uint") == 0){
     application<uinteger,uinteger>* myapp = init_app<uinteger,uinteger>(input_data);
@@ -63,6 +100,12 @@ int main (int argc, char* argv[]) {
   } else if(input_data.layout.compare("bitset_new") == 0){
     application<bitset_new,bitset_new>* myapp = init_app<bitset_new,bitset_new>(input_data);
     myapp->run();
+  } else if(input_data.layout.compare("roaring") == 0){
+    application<roaring,roaring>* myapp = init_app<roaring,roaring>(input_data);
+    myapp->run();
+  } else if(input_data.layout.compare("runs") == 0){
+    application<runs,runs>* myapp = init_app<runs,runs>(input_data);
+    myapp->run();
   }
   #endif
   #if COMPRESSION == 1
@@ -78,6 +121,10 @@ int main (int argc, char* argv[]) {
     cout << "No valid layout entered." << endl;
     exit(0);
   }
+  #ifdef NUMA_STATS
+  if(numa_helper::enabled)
+    numa_helper::print_access_report();
+  #endif
   return 0;
 }
 #endif
@@ -0,0 +1,173 @@
+#ifndef _NEIGHBORHOOD_SORT_HPP_
+#define _NEIGHBORHOOD_SORT_HPP_
+
+/*
+PARALLEL SORT AND DEDUPLICATION OF THE NEIGHBORHOODS OF A LOADED GRAPH. ROWS
+ARE HANDED TO THE WORKERS IN BATCHES, TINY ROWS ARE SORTED BY INSERTION AND
+THE FEW HUB ROWS OF A POWER LAW GRAPH, WHICH WOULD OTHERWISE KEEP ONE WORKER
+BUSY LONG AFTER THE OTHERS FINISHED, ARE SET ASIDE AND SORTED ONE AT A TIME
+BY ALL WORKERS TOGETHER.
+*/
+
+namespace neighborhood_sort {
+  //Rows up to this length are sorted by insertion.
+  static const size_t TINY_ROW_LENGTH = 16;
+  //Rows from this length on are sorted by all workers together.
+  static const size_t HUB_ROW_LENGTH = 1 << 16;
+  //Rows are handed out in batches of this many.
+  static const size_t ROW_BATCH = 256;
+
+  template<class E, class C>
+  static inline void insertion_sort(E *data, const size_t length, const C &less){
+    for(size_t i = 1; i < length; i++){
+      const E value = data[i];
+      size_t j = i;
+      while(j > 0 && less(value,data[j-1])){
+        data[j] = data[j-1];
+        j--;
+      }
+      data[j] = value;
+    }
+  }
+
+  template<class E, class C>
+  static inline void sort_row(E *data, const size_t length, const C &less){
+    if(length <= TINY_ROW_LENGTH)
+      insertion_sort(data,length,less);
+    else
+      std::sort(data,data+length,less);
+  }
+
+  //Sorts one run per worker, then merges neighboring runs in parallel rounds.
+  template<class E, class C>
+  static void parallel_sort(E *data, const size_t length, const size_t num_threads, const C &less){
+    const size_t num_runs = max((size_t)1,min(num_threads,length/HUB_ROW_LENGTH));
+    vector<size_t> run_start(num_runs+1);
+    for(size_t r = 0; r <= num_runs; r++){
+      run_start[r] = (length*r)/num_runs;
+    }
+
+    common::par_for_range(num_threads,0,num_runs,1,
+      [&](size_t tid, size_t r){
+        (void) tid;
+        std::sort(data+run_start[r],data+run_start[r+1],less);
+      });
+    for(size_t width = 1; width < num_runs; width *= 2){
+      const size_t num_merges = (num_runs + 2*width - 1)/(2*width);
+      common::par_for_range(num_threads,0,num_merges,1,
+        [&](size_t tid, size_t m){
+          (void) tid;
+          const size_t first = 2*width*m;
+          const size_t middle = min(first+width,num_runs);
+          const size_t last = min(first+2*width,num_runs);
+          std::inplace_merge(data+run_start[first],data+run_start[middle],data+run_start[last],less);
+        });
+    }
+  }
+
+  /*
+  Sorts every neighborhood with less and hands it to finish_row(row), which
+  runs after the sort. Hub rows are collected during the batched pass and
+  sorted afterwards with parallel_sort.
+  */
+  template<class E, class C>
+  static void sort_rows(vector< vector<E>* > &rows, const size_t num_threads, const C &less,
+    const std::function<void(size_t,size_t)> finish_row){
+
+    vector< vector<size_t> > hubs(num_threads);
+    common::par_for_range(num_threads,0,rows.size(),ROW_BATCH,
+      [&](size_t tid, size_t i){
+        vector<E> *row = rows[i];
+        if(num_threads > 1 && row->size() >= HUB_ROW_LENGTH){
+          hubs[tid].push_back(i);
+          return;
+        }
+        sort_row(row->data(),row->size(),less);
+        finish_row(tid,i);
+      });
+
+    for(size_t t = 0; t < num_threads; t++){
+      for(size_t h = 0; h < hubs[t].size(); h++){
+        vector<E> *row = rows[hubs[t][h]];
+        parallel_sort(row->data(),row->size(),num_threads,less);
+        finish_row(t,hubs[t][h]);
+      }
+    }
+  }
+
+  /*
+  Sorts and deduplicates every neighborhood. max_nbrhood_size is raised to
+  the largest neighborhood before deduplication, the number of neighbors
+  left afterwards is returned.
+  */
+  template<class I>
+  static size_t sort_neighborhoods(vector< vector<I>* > *neighborhoods, const size_t num_threads,
+    size_t &max_nbrhood_size){
+
+    vector<size_t> thread_max(num_threads*PADDING,0);
+    vector<size_t> thread_count(num_threads*PADDING,0);
+    sort_rows(*neighborhoods,num_threads,std::less<I>(),
+      [&](size_t tid, size_t i){
+        vector<I> *row = neighborhoods->at(i);
+        thread_max[tid*PADDING] = max(thread_max[tid*PADDING],row->size());
+        row->erase(unique(row->begin(),row->end()),row->end());
+        thread_count[tid*PADDING] += row->size();
+      });
+
+    size_t count = 0;
+    for(size_t t = 0; t < num_threads; t++){
+      max_nbrhood_size = max(max_nbrhood_size,thread_max[t*PADDING]);
+      count += thread_count[t*PADDING];
+    }
+    return count;
+  }
+
+  /*
+  Sorts every neighborhood together with its edge attributes, keeping
+  duplicates. Returns the number of neighbors and raises max_nbrhood_size
+  like sort_neighborhoods.
+  */
+  template<class I>
+  static size_t sort_attributed_neighborhoods(vector< vector<I>* > *neighborhoods,
+    vector< vector<uint32_t>* > *edge_attributes, const size_t num_threads,
+    size_t &max_nbrhood_size){
+
+    //Every row is paired with its attributes, sorted by id and split again.
+    vector< vector< pair<I,uint32_t> >* > pairs(neighborhoods->size());
+    common::par_for_range(num_threads,0,neighborhoods->size(),ROW_BATCH,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        vector<I> *row = neighborhoods->at(i);
+        vector<uint32_t> *row_attr = edge_attributes->at(i);
+        pairs[i] = new vector< pair<I,uint32_t> >(row->size());
+        for(size_t j = 0; j < row->size(); j++){
+          pairs[i]->at(j) = make_pair(row->at(j),row_attr->at(j));
+        }
+      });
+
+    vector<size_t> thread_max(num_threads*PADDING,0);
+    vector<size_t> thread_count(num_threads*PADDING,0);
+    sort_rows(pairs,num_threads,
+      [](const pair<I,uint32_t> &a, const pair<I,uint32_t> &b){ return a.first < b.first; },
+      [&](size_t tid, size_t i){
+        vector<I> *row = neighborhoods->at(i);
+        vector<uint32_t> *row_attr = edge_attributes->at(i);
+        for(size_t j = 0; j < row->size(); j++){
+          row->at(j) = pairs[i]->at(j).first;
+          row_attr->at(j) = pairs[i]->at(j).second;
+        }
+        delete pairs[i];
+        thread_max[tid*PADDING] = max(thread_max[tid*PADDING],row->size());
+        thread_count[tid*PADDING] += row->size();
+      });
+
+    size_t count = 0;
+    for(size_t t = 0; t < num_threads; t++){
+      max_nbrhood_size = max(max_nbrhood_size,thread_max[t*PADDING]);
+      count += thread_count[t*PADDING];
+    }
+    return count;
+  }
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef _NUMA_HELPER_HPP_
+#define _NUMA_HELPER_HPP_
+
+/*
+NUMA MODE. THE ROWS OF A MATRIX ARE SPLIT INTO ONE CONTIGUOUS PARTITION PER
+NUMA NODE, EACH PARTITION'S BYTES ARE MOVED TO ITS NODE AND THE WORKERS OF
+PAR_FOR_RANGE ARE PINNED TO THE NODES SO THAT THEY FIRST PROCESS THE ROWS OF
+THEIR OWN PARTITION. TOPOLOGY COMES FROM SYSFS AND PLACEMENT USES THE RAW
+SYSCALLS, SO NO LIBNUMA IS NEEDED.
+*/
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1<<1)
+#endif
+
+#define NUMA_MAX_NODES 1024
+
+namespace numa_helper {
+  static bool enabled = false;
+  static std::vector<std::vector<int>> node_cpus;
+
+  //Partition k holds the fraction [boundaries[k],boundaries[k+1]) of a range.
+  static std::vector<double> boundaries;
+
+  //Worker id of the calling thread inside par_for_range, -1 elsewhere.
+  static thread_local int worker_id = -1;
+  static thread_local int worker_node = 0;
+
+  //Bytes of rows read from the local and from a remote partition per worker.
+  static size_t *local_bytes = NULL;
+  static size_t *remote_bytes = NULL;
+
+  static inline size_t num_nodes(){
+    return node_cpus.empty() ? 1 : node_cpus.size();
+  }
+
+  //Parses a sysfs cpu list such as "0-3,8-11".
+  static inline std::vector<int> parse_cpulist(const std::string list){
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while(pos < list.size()){
+      size_t end = list.find(',',pos);
+      if(end == std::string::npos)
+        end = list.size();
+      const std::string item = list.substr(pos,end-pos);
+      const size_t dash = item.find('-');
+      if(!item.empty()){
+        const int first = atoi(item.c_str());
+        const int last = (dash == std::string::npos) ? first : atoi(item.c_str()+dash+1);
+        for(int cpu = first; cpu <= last; cpu++)
+          cpus.push_back(cpu);
+      }
+      pos = end+1;
+    }
+    return cpus;
+  }
+
+  static inline void init(){
+    enabled = true;
+    node_cpus.clear();
+    for(int node = 0; node < NUMA_MAX_NODES; node++){
+      const std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+      std::ifstream cpulist(path);
+      if(!cpulist.is_open())
+        break;
+      std::string list;
+      std::getline(cpulist,list);
+      const std::vector<int> cpus = parse_cpulist(list);
+      //Memory only nodes get no partition.
+      if(!cpus.empty())
+        node_cpus.push_back(cpus);
+    }
+    boundaries.clear();
+    for(size_t k = 0; k <= num_nodes(); k++){
+      boundaries.push_back((double)k/num_nodes());
+    }
+
+    local_bytes = new size_t[MAX_THREADS*PADDING];
+    remote_bytes = new size_t[MAX_THREADS*PADDING];
+    memset(local_bytes,0,sizeof(size_t)*MAX_THREADS*PADDING);
+    memset(remote_bytes,0,sizeof(size_t)*MAX_THREADS*PADDING);
+    std::cout << "NUMA mode with " << num_nodes() << " node(s)" << std::endl;
+  }
+
+  //Workers are split into one contiguous group per node.
+  static inline size_t node_of_worker(const size_t tid, const size_t num_threads){
+    return (tid*num_nodes())/num_threads;
+  }
+
+  static inline size_t partition_of(const size_t i, const size_t from, const size_t to){
+    const double position = (double)(i-from)/(to-from);
+    size_t k = 0;
+    while(k+2 < boundaries.size() && position >= boundaries[k+1])
+      k++;
+    return k;
+  }
+
+  static inline size_t partition_start(const size_t k, const size_t from, const size_t to){
+    return (k+1 == boundaries.size()) ? to : from + (size_t)(boundaries[k]*(to-from) + 0.5);
+  }
+
+  //Pins the calling par_for_range worker to the cpus of its node.
+  static inline void pin_worker(const size_t tid, const size_t num_threads){
+    worker_id = tid;
+    worker_node = node_of_worker(tid,num_threads);
+    if(node_cpus.empty())
+      return;
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for(size_t i = 0; i < node_cpus[worker_node].size(); i++){
+      CPU_SET(node_cpus[worker_node][i],&cpu_set);
+    }
+    pthread_setaffinity_np(pthread_self(),sizeof(cpu_set_t),&cpu_set);
+  }
+
+  //Moves the pages of [data,data+num_bytes) to node (best effort).
+  static inline bool place(const uint8_t *data, const size_t num_bytes, const size_t node){
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t start = ((size_t)data) & ~(page_size-1);
+    const size_t end = ((size_t)data + num_bytes + page_size - 1) & ~(page_size-1);
+    if(num_bytes == 0)
+      return true;
+    unsigned long mask[NUMA_MAX_NODES/(8*sizeof(unsigned long))];
+    memset(mask,0,sizeof(mask));
+    mask[node/(8*sizeof(unsigned long))] |= 1UL << (node%(8*sizeof(unsigned long)));
+    return syscall(SYS_mbind,(void*)start,end-start,MPOL_PREFERRED,mask,NUMA_MAX_NODES+1,MPOL_MF_MOVE) == 0;
+  }
+
+  //Number of bytes of [data,data+num_bytes) that reside on node.
+  static inline size_t bytes_on_node(const uint8_t *data, const size_t num_bytes, const size_t node){
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t start = ((size_t)data) & ~(page_size-1);
+    const size_t batch = 4096;
+    void *pages[batch];
+    int status[batch];
+    size_t on_node = 0;
+    for(size_t page = start; page < (size_t)data + num_bytes; page += batch*page_size){
+      size_t count = 0;
+      for(; count < batch && page + count*page_size < (size_t)data + num_bytes; count++)
+        pages[count] = (void*)(page + count*page_size);
+      if(syscall(SYS_move_pages,0,count,pages,NULL,status,0) != 0)
+        return 0;
+      for(size_t i = 0; i < count; i++){
+        if(status[i] == (int)node)
+          on_node += page_size;
+      }
+    }
+    return min(on_node,num_bytes);
+  }
+
+  static inline void count_access(const size_t partition, const size_t num_bytes){
+    const size_t slot = (worker_id < 0) ? MAX_THREADS-1 : worker_id;
+    if(partition == (size_t)worker_node)
+      local_bytes[slot*PADDING] += num_bytes;
+    else
+      remote_bytes[slot*PADDING] += num_bytes;
+  }
+
+  static inline void print_access_report(){
+    size_t local = 0;
+    size_t remote = 0;
+    for(size_t i = 0; i < MAX_THREADS; i++){
+      local += local_bytes[i*PADDING];
+      remote += remote_bytes[i*PADDING];
+    }
+    std::cout << "NUMA local bytes read: " << local << std::endl;
+    std::cout << "NUMA remote bytes read: " << remote << std::endl;
+  }
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef _ORDERING_CACHE_HPP_
+#define _ORDERING_CACHE_HPP_
+
+/*
+PERSISTED NODE ORDERINGS. A COMPUTED ORDERING (NEW TO OLD IDS) IS WRITTEN NEXT
+TO THE GRAPH FILE IT WAS COMPUTED FOR, NAMED AFTER THE ORDERING, SO LATER RUNS
+RELABEL THE LOADED GRAPH WITHOUT RECOMPUTING IT:
+
+  <graph file>.<ordering>.order = header | new2old ids
+
+The header records the ordering and a hash of the loaded graph (id map and
+neighborhoods, as loaded, before any relabeling). A cache whose hash, index
+width or size does not match the loaded graph is stale and is recomputed
+and overwritten.
+*/
+namespace ordering_cache {
+  static const uint64_t MAGIC = 0x31524544524F4845ULL; // "EHORDER1"
+  static const uint32_t VERSION = 1;
+  static const size_t MAX_NAME_LENGTH = 32;
+
+  struct header{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t index_bytes;
+    uint64_t num_nodes;
+    uint64_t graph_hash;
+    char ordering[MAX_NAME_LENGTH];
+  };
+
+  inline string path(const string graph_path, const string ordering){
+    return graph_path + "." + ordering + ".order";
+  }
+
+  //Finalizer of splitmix64.
+  inline uint64_t mix(uint64_t x){
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+  }
+
+  /*
+  Hash of the graph content. Every row is hashed by one worker, the row
+  hashes are salted with their position and combined by xor, so the result
+  does not depend on the number of threads.
+  */
+  template<class I>
+  static uint64_t graph_hash(const vector<uint64_t> *id_map, const vector< vector<I>* > *out_neighborhoods,
+    const vector< vector<I>* > *in_neighborhoods, const bool symmetric, const size_t num_threads){
+
+    const size_t num_nodes = out_neighborhoods->size();
+    vector<uint64_t> thread_hash(num_threads*PADDING,0);
+    common::par_for_range(num_threads,0,num_nodes,neighborhood_sort::ROW_BATCH,
+      [&](size_t tid, size_t i){
+        uint64_t h = mix(id_map->at(i) + i);
+        for(size_t side = 0; side < (symmetric ? 1 : 2); side++){
+          const vector<I> *row = (side == 0) ? out_neighborhoods->at(i) : in_neighborhoods->at(i);
+          h = mix(h ^ row->size());
+          for(size_t j = 0; j < row->size(); j++){
+            h = mix(h ^ (uint64_t)row->at(j));
+          }
+        }
+        thread_hash[tid*PADDING] ^= mix(h + i);
+      });
+
+    uint64_t h = mix(num_nodes) ^ (symmetric ? 1 : 2);
+    for(size_t t = 0; t < num_threads; t++){
+      h ^= thread_hash[t*PADDING];
+    }
+    return h;
+  }
+
+  //Reads a cached ordering into new2old_ids, false if there is none for this graph.
+  template<class I>
+  static bool load(const string cache_path, const string ordering, const uint64_t graph_hash,
+    const size_t num_nodes, vector<I> &new2old_ids){
+
+    FILE *pFile = fopen(cache_path.c_str(),"r");
+    if(pFile == NULL)
+      return false;
+    header h;
+    bool valid = fread(&h,sizeof(header),1,pFile) == 1 && h.magic == MAGIC && h.version == VERSION &&
+      h.index_bytes == sizeof(I) && h.num_nodes == num_nodes && h.graph_hash == graph_hash &&
+      ordering.size() < MAX_NAME_LENGTH &&
+      ordering.compare(0,string::npos,h.ordering,strnlen(h.ordering,MAX_NAME_LENGTH)) == 0;
+    if(valid){
+      new2old_ids.resize(num_nodes);
+      valid = fread(new2old_ids.data(),sizeof(I),num_nodes,pFile) == num_nodes;
+    }
+    fclose(pFile);
+    return valid;
+  }
+
+  /*
+  Writes an ordering to a temporary file renamed over cache_path, so a
+  concurrent run never reads a partial cache. Returns false if the directory
+  of the graph is not writable or the name of the ordering does not fit the
+  header.
+  */
+  template<class I>
+  static bool save(const string cache_path, const string ordering, const uint64_t graph_hash,
+    const vector<I> &new2old_ids){
+
+    if(ordering.size() >= MAX_NAME_LENGTH)
+      return false;
+
+    header h;
+    memset(&h,0,sizeof(header));
+    h.magic = MAGIC;
+    h.version = VERSION;
+    h.index_bytes = sizeof(I);
+    h.num_nodes = new2old_ids.size();
+    h.graph_hash = graph_hash;
+    memcpy(h.ordering,ordering.data(),ordering.size());
+
+    const string temporary_path = cache_path + ".tmp" + to_string(getpid());
+    FILE *pFile = fopen(temporary_path.c_str(),"w");
+    if(pFile == NULL)
+      return false;
+    const bool written = fwrite(&h,sizeof(header),1,pFile) == 1 &&
+      fwrite(new2old_ids.data(),sizeof(I),new2old_ids.size(),pFile) == new2old_ids.size();
+    const bool closed = fclose(pFile) == 0;
+    if(!written || !closed || rename(temporary_path.c_str(),cache_path.c_str()) != 0){
+      unlink(temporary_path.c_str());
+      return false;
+    }
+    return true;
+  }
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef _PIPELINED_IO_HPP_
+#define _PIPELINED_IO_HPP_
+
+/*
+PIPELINED FILE READER FOR THE LOADERS. A READER THREAD FILLS A RING OF
+NUM_BUFFERS BUFFERS AHEAD OF THE CONSUMER, SO READING THE NEXT PART OF THE
+FILE OVERLAPS WITH PARSING OR PACKING THE CURRENT ONE AND LOAD TIME APPROACHES
+MAX(I/O TIME, PARSE TIME). ONLY THE RING IS RESIDENT, NEVER THE WHOLE RAW FILE.
+
+In line mode every buffer ends at a newline (the partial last line is carried
+over to the next buffer), so text parsers never see a line cut in two. Every
+buffer is followed by a '\0' for strtok and friends. A stream reads records of
+a binary file across buffer boundaries.
+*/
+
+#include <condition_variable>
+
+namespace pipelined_io {
+  static const size_t BUFFER_BYTES = 32*1024*1024;
+  static const size_t NUM_BUFFERS = 3;
+
+  struct buffer{
+    char *data;
+    size_t size;
+    size_t capacity;
+  };
+
+  class reader{
+    int fd;
+    size_t total_bytes;
+    bool lines;
+    buffer buffers[NUM_BUFFERS];
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable changed;
+    size_t num_filled;    //buffers handed over by the reader thread
+    size_t num_released;  //buffers given back by the consumer
+    bool at_end;
+    bool stopped;
+    bool holding;
+
+    void fill(){
+      std::string carry;
+      for(size_t k = 0; ; k++){
+        {
+          std::unique_lock<std::mutex> guard(lock);
+          changed.wait(guard,[&]{ return stopped || k < num_released + NUM_BUFFERS; });
+          if(stopped)
+            return;
+        }
+        buffer &b = buffers[k % NUM_BUFFERS];
+        //A line longer than half a buffer grows the buffer.
+        if(2*carry.size() > b.capacity){
+          b.capacity = 2*carry.size();
+          b.data = (char*) slab::reallocate((uint8_t*)b.data,0,b.capacity+1);
+        }
+        memcpy(b.data,carry.data(),carry.size());
+        b.size = carry.size();
+        carry.clear();
+        bool eof = false;
+        while(b.size < b.capacity){
+          const ssize_t bytes_read = read(fd,b.data+b.size,b.capacity-b.size);
+          if(bytes_read < 0) {fputs ("Reading error",stderr); exit (3);}
+          if(bytes_read == 0){
+            eof = true;
+            break;
+          }
+          b.size += bytes_read;
+        }
+        if(lines && !eof){
+          size_t end = b.size;
+          while(end > 0 && b.data[end-1] != '\n')
+            end--;
+          carry.assign(b.data+end,b.size-end);
+          b.size = end;
+        }
+        b.data[b.size] = '\0';
+
+        std::lock_guard<std::mutex> guard(lock);
+        if(b.size > 0 || !carry.empty())
+          num_filled++;
+        if(eof)
+          at_end = true;
+        changed.notify_all();
+        if(eof)
+          return;
+      }
+    }
+
+  public:
+    reader(const string path, const bool lines_in = false, const size_t buffer_bytes = BUFFER_BYTES){
+      fd = open(path.c_str(),O_RDONLY);
+      if (fd == -1) {fputs ("File error",stderr); exit (1);}
+      struct stat file_stat;
+      fstat(fd,&file_stat);
+      total_bytes = file_stat.st_size;
+      posix_fadvise(fd,0,0,POSIX_FADV_SEQUENTIAL);
+
+      lines = lines_in;
+      const size_t capacity = max((size_t)1,min(buffer_bytes,total_bytes));
+      for(size_t k = 0; k < NUM_BUFFERS; k++){
+        buffers[k].data = (char*) slab::allocate(capacity+1);
+        buffers[k].size = 0;
+        buffers[k].capacity = capacity;
+      }
+      num_filled = 0;
+      num_released = 0;
+      at_end = false;
+      stopped = false;
+      holding = false;
+      thread = std::thread(&reader::fill,this);
+    }
+
+    ~reader(){
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        stopped = true;
+        changed.notify_all();
+      }
+      thread.join();
+      close(fd);
+      for(size_t k = 0; k < NUM_BUFFERS; k++){
+        slab::release(buffers[k].data);
+      }
+    }
+
+    size_t file_size() const {
+      return total_bytes;
+    }
+
+    //Gives back the previous buffer and waits for the next one, NULL at the end of the file.
+    buffer* next(){
+      std::unique_lock<std::mutex> guard(lock);
+      if(holding){
+        num_released++;
+        holding = false;
+        changed.notify_all();
+      }
+      changed.wait(guard,[&]{ return num_released < num_filled || at_end; });
+      if(num_released == num_filled)
+        return NULL;
+      holding = true;
+      return &buffers[num_released % NUM_BUFFERS];
+    }
+  };
+
+  //Reads fixed size records of a binary file, they may span buffers.
+  class stream{
+    reader in;
+    buffer *current;
+    size_t position;
+
+  public:
+    stream(const string path, const size_t buffer_bytes = BUFFER_BYTES):
+      in(path,false,buffer_bytes){
+      current = NULL;
+      position = 0;
+    }
+
+    size_t file_size() const {
+      return in.file_size();
+    }
+
+    void read(void *destination, size_t num_bytes){
+      char *out = (char*)destination;
+      while(num_bytes > 0){
+        if(current == NULL || position == current->size){
+          current = in.next();
+          position = 0;
+          if(current == NULL) {fputs ("Reading error",stderr); exit (3);}
+        }
+        const size_t n = min(num_bytes,current->size-position);
+        memcpy(out,current->data+position,n);
+        out += n;
+        position += n;
+        num_bytes -= n;
+      }
+    }
+
+    template<class T>
+    T read(){
+      T value;
+      read(&value,sizeof(T));
+      return value;
+    }
+  };
+}
+
+#endif
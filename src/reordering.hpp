@@ -0,0 +1,434 @@
+#ifndef _REORDERING_HPP_
+#define _REORDERING_HPP_
+
+/*
+PARALLEL BUILDING BLOCKS OF THE NODE REORDERINGS IN MUTABLEGRAPH. TRAVERSALS
+TRACK VISITED NODES IN A BITMAP AND EXPAND A WHOLE BFS LEVEL AT A TIME. EVERY
+NODE OF THE NEXT LEVEL IS CLAIMED BY THE FIRST NODE OF THE FRONTIER THAT
+REACHES IT (AN ATOMIC MIN OVER FRONTIER POSITIONS), SO THE PARALLEL ORDERS ARE
+EXACTLY THOSE OF A SERIAL TRAVERSAL, WHATEVER THE NUMBER OF THREADS.
+*/
+
+namespace reordering {
+  //Frontier nodes (or rows) are handed to the workers in blocks of this many.
+  static const size_t LEVEL_BLOCK = 256;
+
+  struct bitmap{
+    vector<uint64_t> words;
+
+    bitmap(const size_t num_bits): words((num_bits+63)/64,0){}
+
+    inline bool get(const size_t i) const {
+      return (words[i >> 6] >> (i & 63)) & 1;
+    }
+    inline void set(const size_t i){
+      words[i >> 6] |= (uint64_t)1 << (i & 63);
+    }
+    inline void set_atomic(const size_t i){
+      __sync_fetch_and_or(&words[i >> 6],(uint64_t)1 << (i & 63));
+    }
+  };
+
+  template<class T>
+  static inline void atomic_min(T *target, const T value){
+    T current = *target;
+    while(value < current && !__sync_bool_compare_and_swap(target,current,value))
+      current = *target;
+  }
+
+  /*
+  The orderings below traverse undirected neighborhoods. A directed graph is
+  ordered by the union of the out and in neighborhoods of every node, which
+  this builds (sorted rows, the caller deletes them).
+  */
+  template<class I>
+  static vector< vector<I>* >* undirected_neighborhoods(const vector< vector<I>* > *out_neighborhoods,
+    const vector< vector<I>* > *in_neighborhoods, const size_t num_threads){
+
+    vector< vector<I>* > *neighborhoods = new vector< vector<I>* >(out_neighborhoods->size());
+    common::par_for_range(num_threads,0,out_neighborhoods->size(),LEVEL_BLOCK,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        const vector<I> *out = out_neighborhoods->at(i);
+        const vector<I> *in = in_neighborhoods->at(i);
+        vector<I> *row = new vector<I>(out->size()+in->size());
+        row->erase(std::set_union(out->begin(),out->end(),in->begin(),in->end(),row->begin()),row->end());
+        neighborhoods->at(i) = row;
+      });
+    return neighborhoods;
+  }
+
+  /*
+  Appends the unvisited neighbors of order[level_start,level_end) to order
+  and marks them visited. A node is appended after the frontier node that
+  claimed it, in the order of that node's neighborhood unless order_children
+  reorders the children [begin,end) of every frontier node.
+  */
+  template<class I>
+  static void expand_level(const vector< vector<I>* > *neighborhoods, vector<I> &order,
+    const size_t level_start, const size_t level_end, bitmap &visited, I *claims,
+    const size_t num_threads, const std::function<void(I*,I*)> &order_children){
+
+    const size_t frontier_size = level_end - level_start;
+    common::par_for_range(num_threads,0,frontier_size,LEVEL_BLOCK,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        const vector<I> *hood = neighborhoods->at(order[level_start+i]);
+        for(size_t j = 0; j < hood->size(); j++){
+          if(!visited.get(hood->at(j)))
+            atomic_min(&claims[hood->at(j)],(I)i);
+        }
+      });
+
+    vector<size_t> starts(frontier_size+1,0);
+    common::par_for_range(num_threads,0,frontier_size,LEVEL_BLOCK,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        const vector<I> *hood = neighborhoods->at(order[level_start+i]);
+        size_t count = 0;
+        for(size_t j = 0; j < hood->size(); j++){
+          count += (!visited.get(hood->at(j)) && claims[hood->at(j)] == (I)i);
+        }
+        starts[i+1] = count;
+      });
+    for(size_t i = 0; i < frontier_size; i++){
+      starts[i+1] += starts[i];
+    }
+
+    order.resize(level_end+starts[frontier_size]);
+    I *next = order.data()+level_end;
+    common::par_for_range(num_threads,0,frontier_size,LEVEL_BLOCK,
+      [&](size_t tid, size_t i){
+        (void) tid;
+        const vector<I> *hood = neighborhoods->at(order[level_start+i]);
+        size_t position = starts[i];
+        for(size_t j = 0; j < hood->size(); j++){
+          if(!visited.get(hood->at(j)) && claims[hood->at(j)] == (I)i)
+            next[position++] = hood->at(j);
+        }
+        if(order_children)
+          order_children(next+starts[i],next+position);
+      });
+    common::par_for_range(num_threads,0,starts[frontier_size],LEVEL_BLOCK,
+      [&](size_t tid, size_t k){
+        (void) tid;
+        visited.set_atomic(next[k]);
+      });
+  }
+
+  /*
+  BFS order of all nodes (new to old ids). A new traversal starts from the
+  first unvisited node of seeds whenever a component is exhausted.
+  */
+  template<class I>
+  static vector<I> bfs_order(const vector< vector<I>* > *neighborhoods, const vector<I> &seeds,
+    const size_t num_threads,
+    const std::function<void(I*,I*)> order_children = std::function<void(I*,I*)>()){
+
+    const size_t num_nodes = neighborhoods->size();
+    vector<I> order;
+    order.reserve(num_nodes);
+    bitmap visited(num_nodes);
+    I *claims = new I[num_nodes];
+    std::fill(claims,claims+num_nodes,std::numeric_limits<I>::max());
+
+    size_t seed_i = 0;
+    while(order.size() < num_nodes){
+      while(visited.get(seeds[seed_i]))
+        seed_i++;
+      size_t level_start = order.size();
+      order.push_back(seeds[seed_i]);
+      visited.set(seeds[seed_i]);
+      while(level_start < order.size()){
+        const size_t level_end = order.size();
+        expand_level(neighborhoods,order,level_start,level_end,visited,claims,num_threads,order_children);
+        level_start = level_end;
+      }
+    }
+    delete[] claims;
+    return order;
+  }
+
+  /*
+  Nodes in the order of their first appearance when the neighborhoods of
+  rows are concatenated (new to old ids). Nodes that appear in no
+  neighborhood follow in id order.
+  */
+  template<class I>
+  static vector<I> first_appearance_order(const vector< vector<I>* > *neighborhoods,
+    const vector<I> &rows, const size_t num_threads){
+
+    const size_t num_nodes = neighborhoods->size();
+    vector<uint64_t> row_starts(rows.size()+1,0);
+    for(size_t r = 0; r < rows.size(); r++){
+      row_starts[r+1] = row_starts[r] + neighborhoods->at(rows[r])->size();
+    }
+
+    const uint64_t never = std::numeric_limits<uint64_t>::max();
+    vector<uint64_t> first(num_nodes,never);
+    common::par_for_range(num_threads,0,rows.size(),LEVEL_BLOCK,
+      [&](size_t tid, size_t r){
+        (void) tid;
+        const vector<I> *hood = neighborhoods->at(rows[r]);
+        for(size_t j = 0; j < hood->size(); j++){
+          atomic_min(&first[hood->at(j)],row_starts[r]+j);
+        }
+      });
+
+    vector<I> order = common::range<I>(num_nodes);
+    neighborhood_sort::parallel_sort(order.data(),num_nodes,num_threads,
+      [&first](const I a, const I b){
+        return (first[a] == first[b]) ? a < b : first[a] < first[b];
+      });
+    return order;
+  }
+
+  /*
+  Reverse Cuthill-McKee: a BFS that starts every component at a node of
+  minimum degree and visits the children of a node in increasing degree,
+  reversed at the end. It concentrates the neighbors of a node around it.
+  */
+  template<class I>
+  static vector<I> rcm_order(const vector< vector<I>* > *neighborhoods, const size_t num_threads){
+    const size_t num_nodes = neighborhoods->size();
+    auto by_degree = [neighborhoods](const I a, const I b){
+      const size_t a_size = neighborhoods->at(a)->size();
+      const size_t b_size = neighborhoods->at(b)->size();
+      return (a_size == b_size) ? a < b : a_size < b_size;
+    };
+    vector<I> seeds = common::range<I>(num_nodes);
+    neighborhood_sort::parallel_sort(seeds.data(),num_nodes,num_threads,by_degree);
+
+    vector<I> order = bfs_order<I>(neighborhoods,seeds,num_threads,
+      [&by_degree](I *begin, I *end){ std::sort(begin,end,by_degree); });
+    std::reverse(order.begin(),order.end());
+    return order;
+  }
+
+  /*
+  Priority queue of Gorder with unit steps: nodes sit in doubly linked
+  buckets by key, so raising or lowering a key by one is constant time.
+  */
+  template<class I>
+  struct unit_heap{
+    const I none;
+    vector<size_t> key;
+    vector<I> prev;
+    vector<I> next;
+    vector<I> head;
+    vector<uint8_t> removed;
+    size_t top;
+
+    //Nodes of equal key are popped in the reverse order of insertion.
+    unit_heap(const vector<I> &insertion_order):
+      none(std::numeric_limits<I>::max()),key(insertion_order.size(),0),prev(insertion_order.size(),none),
+      next(insertion_order.size(),none),head(1,none),removed(insertion_order.size(),0),top(0){
+      for(size_t i = 0; i < insertion_order.size(); i++){
+        link(insertion_order[i]);
+      }
+    }
+
+    inline void link(const I v){
+      if(key[v] >= head.size())
+        head.resize(key[v]+1,none);
+      prev[v] = none;
+      next[v] = head[key[v]];
+      if(next[v] != none)
+        prev[next[v]] = v;
+      head[key[v]] = v;
+      top = max(top,key[v]);
+    }
+
+    inline void unlink(const I v){
+      if(prev[v] != none)
+        next[prev[v]] = next[v];
+      else
+        head[key[v]] = next[v];
+      if(next[v] != none)
+        prev[next[v]] = prev[v];
+    }
+
+    inline void increment(const I v){
+      if(removed[v])
+        return;
+      unlink(v);
+      key[v]++;
+      link(v);
+    }
+
+    inline void decrement(const I v){
+      if(removed[v])
+        return;
+      unlink(v);
+      key[v]--;
+      link(v);
+    }
+
+    inline I pop(){
+      while(head[top] == none)
+        top--;
+      const I v = head[top];
+      unlink(v);
+      removed[v] = 1;
+      return v;
+    }
+  };
+
+  /*
+  Gorder (Wei et al., SIGMOD 2016): greedily places next the node with the
+  most neighbors and siblings (shared neighbors) among the last window placed
+  nodes. Siblings are not counted through hubs, rows longer than the square
+  root of the number of nodes, which would touch most of the graph.
+  */
+  template<class I>
+  static vector<I> gorder_order(const vector< vector<I>* > *neighborhoods, const size_t window,
+    const size_t num_threads){
+
+    const size_t num_nodes = neighborhoods->size();
+    const size_t hub_degree = (size_t)sqrt((double)num_nodes);
+    //The first node, and the next one whenever no node is related to the window, has the highest degree.
+    vector<I> insertion_order = common::range<I>(num_nodes);
+    neighborhood_sort::parallel_sort(insertion_order.data(),num_nodes,num_threads,
+      [neighborhoods](const I a, const I b){
+        const size_t a_size = neighborhoods->at(a)->size();
+        const size_t b_size = neighborhoods->at(b)->size();
+        return (a_size == b_size) ? a > b : a_size < b_size;
+      });
+    unit_heap<I> heap(insertion_order);
+
+    auto update = [&](const I v, const bool entering){
+      const vector<I> *hood = neighborhoods->at(v);
+      for(size_t j = 0; j < hood->size(); j++){
+        const I u = hood->at(j);
+        entering ? heap.increment(u) : heap.decrement(u);
+        const vector<I> *siblings = neighborhoods->at(u);
+        if(siblings->size() > hub_degree)
+          continue;
+        for(size_t k = 0; k < siblings->size(); k++){
+          if(siblings->at(k) != v)
+            entering ? heap.increment(siblings->at(k)) : heap.decrement(siblings->at(k));
+        }
+      }
+    };
+
+    vector<I> order(num_nodes);
+    for(size_t i = 0; i < num_nodes; i++){
+      order[i] = heap.pop();
+      update(order[i],true);
+      if(i >= window)
+        update(order[i-window],false);
+    }
+    return order;
+  }
+
+  /*
+  Rabbit Order (Arai et al., IPDPS 2016): nodes are visited in increasing
+  degree and merged into the neighboring community of the largest positive
+  modularity gain. The edges of a community are aggregated lazily, when its
+  root is visited. Nodes are numbered in depth first order of the resulting
+  dendrogram, so every community gets a consecutive range of ids.
+  */
+  template<class I>
+  static vector<I> rabbit_order(const vector< vector<I>* > *neighborhoods, const size_t num_threads){
+    const size_t num_nodes = neighborhoods->size();
+    vector<I> visit_order = common::range<I>(num_nodes);
+    neighborhood_sort::parallel_sort(visit_order.data(),num_nodes,num_threads,
+      [neighborhoods](const I a, const I b){
+        const size_t a_size = neighborhoods->at(a)->size();
+        const size_t b_size = neighborhoods->at(b)->size();
+        return (a_size == b_size) ? a < b : a_size < b_size;
+      });
+
+    double total_weight = 0.0;
+    vector<double> strength(num_nodes);
+    vector< vector< pair<I,double> > > edges(num_nodes);
+    common::par_for_range(num_threads,0,num_nodes,LEVEL_BLOCK,
+      [&](size_t tid, size_t v){
+        (void) tid;
+        const vector<I> *hood = neighborhoods->at(v);
+        strength[v] = hood->size();
+        edges[v].reserve(hood->size());
+        for(size_t j = 0; j < hood->size(); j++){
+          edges[v].push_back(make_pair(hood->at(j),1.0));
+        }
+      });
+    for(size_t v = 0; v < num_nodes; v++){
+      total_weight += strength[v];
+    }
+    if(total_weight == 0.0)
+      return visit_order;
+
+    vector<I> parent = common::range<I>(num_nodes);
+    auto find = [&parent](I v) -> I {
+      while(parent[v] != v){
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+      }
+      return v;
+    };
+    vector< vector<I> > children(num_nodes);
+    vector<I> roots;
+    vector<double> weight_to(num_nodes,0.0);
+    vector<I> touched;
+
+    vector<uint8_t> visited(num_nodes,0);
+    for(size_t k = 0; k < num_nodes; k++){
+      const I v = visit_order[k];
+      visited[v] = 1;
+      //Aggregate the edges of v's community by neighboring community.
+      for(size_t j = 0; j < edges[v].size(); j++){
+        const I u = find(edges[v][j].first);
+        if(u == v)
+          continue;
+        if(weight_to[u] == 0.0)
+          touched.push_back(u);
+        weight_to[u] += edges[v][j].second;
+      }
+      I best = v;
+      double best_gain = 0.0;
+      vector< pair<I,double> > aggregated;
+      aggregated.reserve(touched.size());
+      for(size_t j = 0; j < touched.size(); j++){
+        const I u = touched[j];
+        const double gain = weight_to[u]/total_weight - strength[u]*strength[v]/(total_weight*total_weight);
+        if(gain > best_gain || (gain == best_gain && gain > 0.0 && u < best)){
+          best_gain = gain;
+          best = u;
+        }
+        aggregated.push_back(make_pair(u,weight_to[u]));
+        weight_to[u] = 0.0;
+      }
+      touched.clear();
+
+      //The edges of a community are only read when its root is visited.
+      vector< pair<I,double> >().swap(edges[v]);
+      if(best == v){
+        roots.push_back(v);
+        continue;
+      }
+      parent[v] = best;
+      strength[best] += strength[v];
+      children[best].push_back(v);
+      if(!visited[best])
+        edges[best].insert(edges[best].end(),aggregated.begin(),aggregated.end());
+    }
+
+    vector<I> order;
+    order.reserve(num_nodes);
+    vector<I> stack;
+    for(size_t r = 0; r < roots.size(); r++){
+      stack.push_back(roots[r]);
+      while(!stack.empty()){
+        const I v = stack.back();
+        stack.pop_back();
+        order.push_back(v);
+        for(size_t c = children[v].size(); c > 0; c--){
+          stack.push_back(children[v][c-1]);
+        }
+      }
+    }
+    return order;
+  }
+}
+
+#endif
@@ -11,8 +11,10 @@ FOUND IN STATIC CLASSES IN THE LAYOUT FOLDER.
 
 #include "layouts/hybrid.hpp"
 
+//The hybrid operations cast between Set<hybrid> and the Set of the layout
+//they dispatch to, so sets must not be subject to type-based alias analysis.
 template <class T>
-class Set{ 
+class __attribute__((may_alias)) Set{ 
   public: 
     uint8_t *data;
     size_t cardinality;
@@ -126,9 +128,13 @@ class Set{
     void copy_from(Set<T> src);
 
     //Constructors
-    static Set<T> from_array(uint8_t *set_data, uint32_t *array_data, size_t data_size);
+    //The array type is the index type of the layout (uint32_t unless T is a
+    //basic_uinteger or basic_bitset of another width).
+    template <class I>
+    static Set<T> from_array(uint8_t *set_data, I *array_data, size_t data_size);
     static Set<T> from_flattened(uint8_t *set_data, size_t cardinality_in);
-    static size_t flatten_from_array(uint8_t *set_data, const uint32_t * const array_data, const size_t data_size);
+    template <class I>
+    static size_t flatten_from_array(uint8_t *set_data, const I * const array_data, const size_t data_size);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -158,7 +164,8 @@ inline Set<uinteger> Set<T>::decode(uint32_t *buffer){
 //CREATE A SET FROM AN ARRAY OF UNSIGNED INTEGERS
 ///////////////////////////////////////////////////////////////////////////////
 template <class T>
-inline Set<T> Set<T>::from_array(uint8_t *set_data, uint32_t *array_data, size_t data_size){
+template <class I>
+inline Set<T> Set<T>::from_array(uint8_t *set_data, I *array_data, size_t data_size){
   const double density = ((data_size > 0) ? (double)((array_data[data_size-1]-array_data[0])/data_size) : 0.0);
   const size_t bytes_in = T::build(set_data,array_data,data_size);
   return Set<T>(set_data,data_size,bytes_in,density,T::get_type());
@@ -180,7 +187,8 @@ inline Set<T> Set<T>::from_flattened(uint8_t *set_data, size_t cardinality_in){
 //THIS IS USED FOR A CSR GRAPH IMPLEMENTATION.
 ///////////////////////////////////////////////////////////////////////////////
 template <class T>
-inline size_t Set<T>::flatten_from_array(uint8_t *set_data, const uint32_t * const array_data, const size_t data_size){
+template <class I>
+inline size_t Set<T>::flatten_from_array(uint8_t *set_data, const I * const array_data, const size_t data_size){
   return T::build_flattened(set_data,array_data,data_size);
 }
 
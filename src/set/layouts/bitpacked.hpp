@@ -110,10 +110,10 @@ inline uint32_t bitpacked::produce_deltas(const uint32_t *data_in, size_t length
       //cout << "STORING DELTAS Values[" << i << "]: " << t[0] << " " << t[1] << " " << t[2] << " " << t[3] << endl;
    
       //Find max difference (will tell the # of bits to represent value needed)
-      uint32_t *ot = (uint32_t*) &deltas;
+      //Read back from the stored deltas, not through a pointer into the register.
       for(size_t j = 0; j < INTS_PER_REG; j++){
-        if(ot[j] > max){
-          max = ot[j];
+        if(data[i+j] > max){
+          max = data[i+j];
         }
       }
       //Store the deltas
@@ -134,7 +134,7 @@ inline size_t bitpacked::build(uint8_t *r_in, const uint32_t *A, const size_t s_
     uint32_t *data = new uint32_t[s_a];
     const size_t num_simd_packed = get_num_simd_packed(s_a);
     const uint32_t max = produce_deltas(A,s_a,data,num_simd_packed);
-    const uint8_t bits_used = (uint32_t)log2(max)+1;
+    const uint8_t bits_used = (max == 0) ? 1 : (uint32_t)log2(max)+1;
     r_in[0] = bits_used;
 
     size_t result_i = variant::encode(A,0,1,r_in,1);
@@ -144,6 +144,7 @@ inline size_t bitpacked::build(uint8_t *r_in, const uint32_t *A, const size_t s_
     //cout << "Encoding at: " << result_i << endl;
     result_i = variant::encode(data,num_simd_packed,s_a,r_in,result_i);
 
+    delete[] data;
     return result_i;
   } else{
     return 0;
@@ -1,6 +1,8 @@
 /*
 
 THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH THE BITSET LAYOUT.
+THE INDEX TYPE I IS THE WIDTH OF THE IDS AND OF THE SIZE WORD IN FRONT OF A
+FLATTENED SET, BITSET IS THE 32-BIT LAYOUT.
 
 */
 
@@ -10,15 +12,16 @@ THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH THE BITSET LAYOUT.
 #define ADDRESS_BITS_PER_WORD 6
 #define BYTES_PER_WORD 8
 
-class bitset{
+template<class I>
+class basic_bitset{
   public:
-    static size_t word_index(const uint32_t bit_index);
-    static bool is_set(const uint32_t index, const uint64_t *in_array, const uint64_t start_index);
-    static void set(const uint32_t index, uint64_t *in_array, const uint64_t start_index);
+    static size_t word_index(const I bit_index);
+    static bool is_set(const I index, const uint64_t *in_array, const uint64_t start_index);
+    static void set(const I index, uint64_t *in_array, const uint64_t start_index);
 
     static common::type get_type();
-    static size_t build(uint8_t *r_in, const uint32_t *data, const size_t length);
-    static size_t build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length);
+    static size_t build(uint8_t *r_in, const I *data, const size_t length);
+    static size_t build_flattened(uint8_t *r_in, const I *data, const size_t length);
     static tuple<size_t,size_t,common::type> get_flattened_data(const uint8_t *set_data, const size_t cardinality);
 
     template<typename F>
@@ -46,23 +49,31 @@ class bitset{
       const size_t number_of_bytes,
       const common::type t);
 };
+
+typedef basic_bitset<uint32_t> bitset;
+
 //compute word of data
-inline size_t bitset::word_index(const uint32_t bit_index){
+template<class I>
+inline size_t basic_bitset<I>::word_index(const I bit_index){
   return bit_index >> ADDRESS_BITS_PER_WORD;
 }
 //check if a bit is set
-inline bool bitset::is_set(const uint32_t index, const uint64_t * const in_array, const uint64_t start_index){
+template<class I>
+inline bool basic_bitset<I>::is_set(const I index, const uint64_t * const in_array, const uint64_t start_index){
   return (in_array)[word_index(index)-start_index] & ((uint64_t) 1 << (index%BITS_PER_WORD));
 }
 //check if a bit is set
-inline void bitset::set(const uint32_t index, uint64_t * const in_array, const uint64_t start_index){
+template<class I>
+inline void basic_bitset<I>::set(const I index, uint64_t * const in_array, const uint64_t start_index){
   *(in_array + ((index >> ADDRESS_BITS_PER_WORD)-start_index)) |= ((uint64_t)1 << (index & 0x3F));
 }
-inline common::type bitset::get_type(){
+template<class I>
+inline common::type basic_bitset<I>::get_type(){
   return common::BITSET;
 }
 //Copies data from input array of ints to our set data r_in
-inline size_t bitset::build(uint8_t *R, const uint32_t *A, const size_t s_a){
+template<class I>
+inline size_t basic_bitset<I>::build(uint8_t *R, const I *A, const size_t s_a){
   if(s_a > 0){
     const uint64_t offset = word_index(A[0]);
     ((uint64_t*)R)[0] = offset; 
@@ -74,7 +85,7 @@ inline size_t bitset::build(uint8_t *R, const uint32_t *A, const size_t s_a){
     memset(R64,(uint8_t)0,num_words_to_clear*sizeof(uint64_t));
 
     while(i < s_a){
-      uint32_t cur = A[i];
+      I cur = A[i];
       //std::cout << cur << std::endl;
       word = word_index(cur);
       uint64_t set_value = (uint64_t) 1 << (cur % BITS_PER_WORD);
@@ -96,30 +107,33 @@ inline size_t bitset::build(uint8_t *R, const uint32_t *A, const size_t s_a){
 }
 //Nothing is different about build flattened here. The number of bytes
 //can be infered from the type. This gives us back a true CSR representation.
-inline size_t bitset::build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length){
+template<class I>
+inline size_t basic_bitset<I>::build_flattened(uint8_t *r_in, const I *data, const size_t length){
   if(length > 0){
     common::num_bs++;
-    uint32_t *size_ptr = (uint32_t*) r_in;
-    size_t num_bytes = build(r_in+sizeof(uint32_t),data,length);
-    size_ptr[0] = (uint32_t)num_bytes;
-    return num_bytes+sizeof(uint32_t);
+    I *size_ptr = (I*) r_in;
+    size_t num_bytes = build(r_in+sizeof(I),data,length);
+    size_ptr[0] = (I)num_bytes;
+    return num_bytes+sizeof(I);
   } else{
     return 0;
   }
 }
 
-inline tuple<size_t,size_t,common::type> bitset::get_flattened_data(const uint8_t *set_data, const size_t cardinality){
+template<class I>
+inline tuple<size_t,size_t,common::type> basic_bitset<I>::get_flattened_data(const uint8_t *set_data, const size_t cardinality){
   if(cardinality > 0){
-    const uint32_t *size_ptr = (uint32_t*) set_data;
-    return make_tuple(sizeof(uint32_t),(size_t)size_ptr[0],common::BITSET);
+    const I *size_ptr = (I*) set_data;
+    return make_tuple(sizeof(I),(size_t)size_ptr[0],common::BITSET);
   } else{
     return make_tuple(0,0,common::BITSET);
   }
 }
 
 //Iterates over set applying a lambda.
+template<class I>
 template<typename F>
-inline void bitset::foreach_until(
+inline void basic_bitset<I>::foreach_until(
     F f,
     const uint8_t *A,
     const size_t cardinality,
@@ -144,8 +158,9 @@ inline void bitset::foreach_until(
 }
 
 //Iterates over set applying a lambda.
+template<class I>
 template<typename F>
-inline void bitset::foreach(
+inline void basic_bitset<I>::foreach(
     F f,
     const uint8_t * const A,
     const size_t cardinality,
@@ -173,8 +188,9 @@ inline void bitset::foreach(
 }
 
 // Iterates over set applying a lambda in parallel.
+template<class I>
 template<typename F>
-inline size_t bitset::par_foreach(
+inline size_t basic_bitset<I>::par_foreach(
       F f,
       const size_t num_threads,
       const uint8_t* A,
@@ -192,7 +208,7 @@ inline size_t bitset::par_foreach(
               const uint64_t cur_word = A64[i];
               if(cur_word != 0) {
                 for(size_t j = 0; j < BITS_PER_WORD; j++){
-                  const uint32_t curr_nb = BITS_PER_WORD*(i+offset) + j;
+                  const I curr_nb = BITS_PER_WORD*(i+offset) + j;
                   if((cur_word >> j) % 2) {
                     f(tid, curr_nb);
                   }
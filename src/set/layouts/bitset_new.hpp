@@ -1,6 +1,10 @@
 /*
 
-THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH THE BITSET LAYOUT.
+THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH THE BLOCK-SPARSE BITSET
+LAYOUT. ONLY THE NON-EMPTY BLOCKS OF BLOCK_SIZE BITS ARE STORED, A SET IS
+THE SORTED IDS OF ITS BLOCKS (id/BLOCK_SIZE) FOLLOWED BY THE BLOCKS:
+
+  block_id[0] ... block_id[n-1] | block[0] ... block[n-1]
 
 */
 
@@ -17,6 +21,9 @@ class bitset_new{
     static bool is_set(const uint32_t index, const uint64_t *in_array, const uint64_t start_index);
     static void set(const uint32_t index, uint64_t *in_array, const uint64_t start_index);
 
+    static size_t num_blocks(const size_t number_of_bytes);
+    static const uint64_t* blocks(const uint8_t *data, const size_t num_blocks);
+
     static common::type get_type();
     static size_t build(uint8_t *r_in, const uint32_t *data, const size_t length);
     static size_t build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length);
@@ -59,6 +66,12 @@ inline bool bitset_new::is_set(const uint32_t index, const uint64_t * const in_a
 inline void bitset_new::set(const uint32_t index, uint64_t * const in_array, const uint64_t start_index){
   *(in_array + ((index >> ADDRESS_BITS_PER_WORD)-start_index)) |= ((uint64_t)1 << (index & 0x3F));
 }
+inline size_t bitset_new::num_blocks(const size_t number_of_bytes){
+  return number_of_bytes/(sizeof(uint32_t)+(BLOCK_SIZE/8));
+}
+inline const uint64_t* bitset_new::blocks(const uint8_t *data, const size_t num_blocks){
+  return (const uint64_t*)(data+num_blocks*sizeof(uint32_t));
+}
 inline common::type bitset_new::get_type(){
   return common::BITSET_NEW;
 }
@@ -131,47 +144,46 @@ inline tuple<size_t,size_t,common::type> bitset_new::get_flattened_data(const ui
   }
 }
 
-//Iterates over set applying a lambda.
+//Applies f to the ids in one block until it returns true, true if it did.
+template<typename F>
+inline bool decode_block(
+  F f,
+  const uint32_t block_id,
+  const uint64_t *data){
+
+  const size_t words_per_block = BLOCK_SIZE/BITS_PER_WORD;
+  for(size_t i = 0; i < words_per_block; i++){
+    uint64_t cur_word = data[i];
+    while(cur_word != 0){
+      const uint32_t bit = __builtin_ctzll(cur_word);
+      if(f(block_id*BLOCK_SIZE + i*BITS_PER_WORD + bit))
+        return true;
+      cur_word &= (cur_word-1);
+    }
+  }
+  return false;
+}
+
+//Iterates over set applying a lambda until it returns true.
 template<typename F>
 inline void bitset_new::foreach_until(
     F f,
-    const uint8_t *A,
+    const uint8_t * const A,
     const size_t cardinality,
     const size_t number_of_bytes,
     const common::type type) {
   (void) cardinality; (void) type;
 
-  if(number_of_bytes > 0){
-    const size_t num_data_words = ((number_of_bytes-sizeof(uint64_t))/sizeof(uint64_t));
-    const uint64_t offset = ((uint64_t*)A)[0];
-    const uint64_t* A64 = (uint64_t*)(A+sizeof(uint64_t));
-    for(size_t i = 0; i < num_data_words; i++){
-      const uint64_t cur_word = A64[i];
-      for(size_t j = 0; j < BITS_PER_WORD; j++){
-        if((cur_word >> j) % 2){
-          if(f(BITS_PER_WORD*(i+offset) + j))
-            break;
-        }
-      }
-    }
+  const size_t words_per_block = BLOCK_SIZE/BITS_PER_WORD;
+  const size_t A_num_blocks = num_blocks(number_of_bytes);
+  const uint64_t *A_data = blocks(A,A_num_blocks);
+  const uint32_t *A_block_ids = (const uint32_t*)A;
+  for(size_t i = 0; i < A_num_blocks; i++){
+    if(decode_block(f,A_block_ids[i],&A_data[i*words_per_block]))
+      break;
   }
 }
 
-template<typename F>
-inline void decode_block(
-  F f,
-  uint32_t offset,
-  uint64_t* data){
-
-  for(size_t i = 0; i < BLOCK_SIZE; i++){
-    const size_t word = i / BITS_PER_WORD;
-    const size_t bit = i % BITS_PER_WORD;
-    if((data[word] >> bit) % 2) {
-      f(offset*BLOCK_SIZE + i);
-    }
-  }
-} 
-
 //Iterates over set applying a lambda.
 template<typename F>
 inline void bitset_new::foreach(
@@ -182,19 +194,19 @@ inline void bitset_new::foreach(
     const common::type type) {
   (void) cardinality; (void) type;
 
-  if(number_of_bytes > 0){
-    const size_t words_per_block = ((BLOCK_SIZE)/8)/sizeof(uint64_t);
-
-    size_t A_num_blocks = number_of_bytes/(sizeof(uint32_t)+(BLOCK_SIZE/8));
-    uint64_t *A_data = (uint64_t*)(A+(A_num_blocks*sizeof(uint32_t)));
-    uint32_t *A_offset_pointer = (uint32_t*)A;
-    for(size_t i = 0; i < A_num_blocks; i++){
-      decode_block(f,A_offset_pointer[i],&A_data[i*words_per_block]);
-    }
+  const size_t words_per_block = BLOCK_SIZE/BITS_PER_WORD;
+  const size_t A_num_blocks = num_blocks(number_of_bytes);
+  const uint64_t *A_data = blocks(A,A_num_blocks);
+  const uint32_t *A_block_ids = (const uint32_t*)A;
+  for(size_t i = 0; i < A_num_blocks; i++){
+    decode_block([&f](uint32_t cur){
+      f(cur);
+      return false;
+    },A_block_ids[i],&A_data[i*words_per_block]);
   }
 }
 
-// Iterates over set applying a lambda in parallel.
+// Iterates over set applying a lambda in parallel, one block at a time.
 template<typename F>
 inline size_t bitset_new::par_foreach(
       F f,
@@ -203,25 +215,17 @@ inline size_t bitset_new::par_foreach(
       const size_t cardinality,
       const size_t number_of_bytes,
       const common::type t) {
-   (void) number_of_bytes; (void) t; (void) cardinality;
-
-  if(number_of_bytes > 0){
-    const size_t num_data_words = ((number_of_bytes-sizeof(uint64_t))/sizeof(uint64_t));
-    const uint64_t offset = ((uint64_t*)A)[0];
-    const uint64_t* A64 = (uint64_t*)(A+sizeof(uint64_t));
-    return common::par_for_range(num_threads, 0, num_data_words, 512,
-           [&f, &A64, cardinality,offset](size_t tid, size_t i) {
-              const uint64_t cur_word = A64[i];
-              if(cur_word != 0) {
-                for(size_t j = 0; j < BITS_PER_WORD; j++){
-                  const uint32_t curr_nb = BITS_PER_WORD*(i+offset) + j;
-                  if((cur_word >> j) % 2) {
-                    f(tid, curr_nb);
-                  }
-                }
-              }
-           });
-  }
-
-  return 1;
+  (void) cardinality; (void) t;
+
+  const size_t words_per_block = BLOCK_SIZE/BITS_PER_WORD;
+  const size_t A_num_blocks = num_blocks(number_of_bytes);
+  const uint64_t *A_data = blocks(A,A_num_blocks);
+  const uint32_t *A_block_ids = (const uint32_t*)A;
+  return common::par_for_range(num_threads, 0, A_num_blocks, 16,
+    [&f, A_data, A_block_ids, words_per_block](size_t tid, size_t i) {
+      decode_block([&f,tid](uint32_t cur){
+        f(tid,cur);
+        return false;
+      },A_block_ids[i],&A_data[i*words_per_block]);
+    });
 }
@@ -13,6 +13,8 @@ RUN THE CORRESPONDING SET MEHTODS.
 #include "pshort.hpp"
 #include "bitset.hpp"
 #include "bitpacked.hpp" //this file includes variant.hpp
+#include "roaring.hpp"
+#include "runs.hpp"
 
 class hybrid{
   public:
@@ -79,6 +81,11 @@ inline common::type hybrid::get_type(const uint32_t *data, const size_t length){
     if(range > 0){
       double density = (double) length / range;
      // double c = compressibility(data, length);
+      #ifndef NEW_BITSET
+      if(runs::count_runs(data,length) <= length*common::runs_req){
+        return common::RUNS;
+      }
+      #endif
       if(density > ((double)common::bitset_req) && length > common::bitset_length) {
         #ifdef NEW_BITSET
         return common::BITSET_NEW;
@@ -112,6 +119,9 @@ inline size_t hybrid::build(uint8_t *r_in, const uint32_t *data, const size_t le
     case common::BITSET_NEW :
       return bitset_new::build(r_in,data,length);
     break;
+    case common::RUNS :
+      return runs::build(r_in,data,length);
+    break;
     /*
     case common::PSHORT :
       return pshort::build(r_in,data,length);
@@ -146,6 +156,9 @@ inline size_t hybrid::build_flattened(uint8_t *r_in, const uint32_t *data, const
     case common::BITSET_NEW :
       set_size = bitset_new::build_flattened(r_in, data, length);
       break;
+    case common::RUNS :
+      set_size = runs::build_flattened(r_in, data, length);
+      break;
       /*
     case common::PSHORT :
       set_size = pshort::build_flattened(r_in, data, length);
@@ -180,6 +193,9 @@ inline tuple<size_t,size_t,common::type> hybrid::get_flattened_data(const uint8_
     case common::BITSET_NEW :
       mytup = bitset_new::get_flattened_data(set_data,cardinality);
       break;
+    case common::RUNS :
+      mytup = runs::get_flattened_data(set_data,cardinality);
+      break;
       /*
     case common::PSHORT :
       mytup = pshort::get_flattened_data(set_data, cardinality);
@@ -216,7 +232,10 @@ inline void hybrid::foreach_until(
       bitset::foreach(f,data_in,cardinality,number_of_bytes,common::BITSET);
       break;
     case common::BITSET_NEW:
-      bitset_new::foreach(f,data_in,cardinality,number_of_bytes,common::BITSET_NEW);
+      bitset_new::foreach_until(f,data_in,cardinality,number_of_bytes,common::BITSET_NEW);
+      break;
+    case common::RUNS:
+      runs::foreach_until(f,data_in,cardinality,number_of_bytes,common::RUNS);
       break;
       /*
     case common::PSHORT:
@@ -252,6 +271,9 @@ inline void hybrid::foreach(
     case common::BITSET_NEW :
       bitset_new::foreach(f,data_in,cardinality,number_of_bytes,common::BITSET_NEW);
       break;
+    case common::RUNS :
+      runs::foreach(f,data_in,cardinality,number_of_bytes,common::RUNS);
+      break;
       /*
     case common::PSHORT :
       pshort::foreach(f,data_in,cardinality,number_of_bytes,common::PSHORT);
@@ -298,9 +320,10 @@ inline size_t hybrid::par_foreach(
       // bitpacked::par_foreach(num_threads,f,data_in,cardinality,number_of_bytes,common::BITPACKED);
       break;
     case common::BITSET_NEW :
-      std::cout << "Parallel foreach for BITSET_NEW is not implemented" << std::endl;
-      exit(EXIT_FAILURE);
-      // bitpacked::par_foreach(num_threads,f,data_in,cardinality,number_of_bytes,common::BITPACKED);
+      return bitset_new::par_foreach(f,num_threads,data_in,cardinality,number_of_bytes,common::BITSET_NEW);
+      break;
+    case common::RUNS :
+      return runs::par_foreach(f,num_threads,data_in,cardinality,number_of_bytes,common::RUNS);
       break;
     default:
       break;
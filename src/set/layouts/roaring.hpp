@@ -0,0 +1,310 @@
+#ifndef _ROARING_H_
+#define _ROARING_H_
+/*
+
+THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH THE ROARING LAYOUT.
+THE IDS ARE SPLIT INTO CHUNKS OF 2^16 BY THEIR UPPER 16 BITS AND EVERY
+NON-EMPTY CHUNK IS STORED IN A CONTAINER OF ITS OWN TYPE, WHICHEVER IS
+SMALLEST:
+
+  ARRAY:  THE SORTED LOWER 16 BITS OF THE IDS
+  BITMAP: THE 64-BIT WORDS OF THE CHUNK FROM ITS FIRST TO ITS LAST SET WORD
+  RUNS:   (FIRST,LAST) PAIRS OF THE LOWER 16 BITS OF CONSECUTIVE IDS
+
+A SET IS num_containers | DIRECTORY | PAYLOADS, THE DIRECTORY HOLDS ONE
+roaring::container PER CHUNK SORTED BY KEY.
+
+*/
+
+#include "common.hpp"
+
+class roaring{
+  public:
+    enum container_type: uint8_t {
+      ARRAY = 0,
+      BITMAP = 1,
+      RUNS = 2
+    };
+
+    struct container{
+      uint16_t key; //upper 16 bits of the ids
+      uint8_t type;
+      uint8_t unused;
+      uint32_t cardinality;
+      uint32_t offset; //of the payload, from the end of the directory
+      uint16_t first_word; //BITMAP: chunk word of the first payload word
+      uint16_t length; //BITMAP: number of words, RUNS: number of runs
+    };
+
+    static const size_t WORDS_PER_CHUNK = 1024;
+
+    static common::type get_type();
+    static size_t build(uint8_t *r_in, const uint32_t *data, const size_t length);
+    static size_t build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length);
+    static tuple<size_t,size_t,common::type> get_flattened_data(const uint8_t *set_data, const size_t cardinality);
+
+    static size_t num_containers(const uint8_t *data, const size_t number_of_bytes);
+    static const container* directory(const uint8_t *data);
+    static const uint8_t* payloads(const uint8_t *data, const size_t num_containers);
+    static size_t payload_bytes(const container &c);
+    static size_t build_container(uint8_t *payload, container *c, const uint32_t *data, const size_t length);
+
+    template<typename F>
+    static bool foreach_in_container(F f, const container &c, const uint8_t *payload);
+
+    template<typename F>
+    static void foreach(
+        F f,
+        const uint8_t *data_in,
+        const size_t cardinality,
+        const size_t number_of_bytes,
+        const common::type t);
+
+    template<typename F>
+    static void foreach_until(
+        F f,
+        const uint8_t *data_in,
+        const size_t cardinality,
+        const size_t number_of_bytes,
+        const common::type t);
+
+    template<typename F>
+    static size_t par_foreach(
+      F f,
+      const size_t num_threads,
+      const uint8_t *data_in,
+      const size_t cardinality,
+      const size_t number_of_bytes,
+      const common::type t);
+};
+
+inline common::type roaring::get_type(){
+  return common::ROARING;
+}
+
+inline size_t roaring::num_containers(const uint8_t *data, const size_t number_of_bytes){
+  return (number_of_bytes > 0) ? ((uint32_t*)data)[0] : 0;
+}
+inline const roaring::container* roaring::directory(const uint8_t *data){
+  return (const container*)(data+sizeof(uint32_t));
+}
+inline const uint8_t* roaring::payloads(const uint8_t *data, const size_t num_containers){
+  return data+sizeof(uint32_t)+num_containers*sizeof(container);
+}
+inline size_t roaring::payload_bytes(const container &c){
+  switch(c.type){
+    case ARRAY:
+      return c.cardinality*sizeof(uint16_t);
+    case BITMAP:
+      return c.length*sizeof(uint64_t);
+    default:
+      return c.length*2*sizeof(uint16_t);
+  }
+}
+
+//Writes the ids of one chunk as the smallest of the three containers.
+inline size_t roaring::build_container(uint8_t *payload, container *c, const uint32_t *data, const size_t length){
+  size_t num_runs = 1;
+  for(size_t i = 1; i < length; i++){
+    num_runs += (data[i] != data[i-1]+1);
+  }
+  const size_t first_word = (data[0] & 0xFFFF) >> ADDRESS_BITS_PER_WORD;
+  const size_t num_words = ((data[length-1] & 0xFFFF) >> ADDRESS_BITS_PER_WORD) - first_word + 1;
+
+  const size_t array_bytes = length*sizeof(uint16_t);
+  const size_t bitmap_bytes = num_words*sizeof(uint64_t);
+  const size_t runs_bytes = num_runs*2*sizeof(uint16_t);
+
+  c->key = data[0] >> 16;
+  c->unused = 0;
+  c->cardinality = length;
+  c->first_word = 0;
+  c->length = 0;
+  if(runs_bytes < array_bytes && runs_bytes < bitmap_bytes){
+    c->type = RUNS;
+    c->length = num_runs;
+    uint16_t *R = (uint16_t*)payload;
+    size_t r = 0;
+    R[0] = data[0];
+    for(size_t i = 1; i < length; i++){
+      if(data[i] != data[i-1]+1){
+        R[2*r+1] = data[i-1];
+        r++;
+        R[2*r] = data[i];
+      }
+    }
+    R[2*r+1] = data[length-1];
+    return runs_bytes;
+  } else if(bitmap_bytes <= array_bytes){
+    c->type = BITMAP;
+    c->first_word = first_word;
+    c->length = num_words;
+    uint64_t *R = (uint64_t*)payload;
+    memset(R,(uint8_t)0,bitmap_bytes);
+    for(size_t i = 0; i < length; i++){
+      const uint32_t low = data[i] & 0xFFFF;
+      R[(low >> ADDRESS_BITS_PER_WORD)-first_word] |= ((uint64_t) 1 << (low % BITS_PER_WORD));
+    }
+    return bitmap_bytes;
+  } else{
+    c->type = ARRAY;
+    uint16_t *R = (uint16_t*)payload;
+    for(size_t i = 0; i < length; i++){
+      R[i] = data[i];
+    }
+    return array_bytes;
+  }
+}
+
+//Copies data from input array of ints to our set data r_in
+inline size_t roaring::build(uint8_t *R, const uint32_t *A, const size_t s_a){
+  if(s_a == 0)
+    return 0;
+
+  uint32_t count = 1;
+  for(size_t i = 1; i < s_a; i++){
+    count += ((A[i] >> 16) != (A[i-1] >> 16));
+  }
+  ((uint32_t*)R)[0] = count;
+  container *dir = (container*)(R+sizeof(uint32_t));
+  uint8_t *payload = R+sizeof(uint32_t)+count*sizeof(container);
+
+  size_t offset = 0;
+  size_t i = 0;
+  for(size_t c = 0; c < count; c++){
+    const size_t start = i;
+    const uint32_t key = A[i] >> 16;
+    while(i < s_a && (A[i] >> 16) == key){
+      i++;
+    }
+    dir[c].offset = offset;
+    offset += build_container(payload+offset,&dir[c],&A[start],i-start);
+  }
+  return sizeof(uint32_t)+count*sizeof(container)+offset;
+}
+
+//The number of bytes is stored in front of the set like in the bitset.
+inline size_t roaring::build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length){
+  if(length > 0){
+    uint32_t *size_ptr = (uint32_t*) r_in;
+    size_t num_bytes = build(r_in+sizeof(uint32_t),data,length);
+    size_ptr[0] = (uint32_t)num_bytes;
+    return num_bytes+sizeof(uint32_t);
+  } else{
+    return 0;
+  }
+}
+
+inline tuple<size_t,size_t,common::type> roaring::get_flattened_data(const uint8_t *set_data, const size_t cardinality){
+  if(cardinality > 0){
+    const uint32_t *size_ptr = (uint32_t*) set_data;
+    return make_tuple(sizeof(uint32_t),(size_t)size_ptr[0],common::ROARING);
+  } else{
+    return make_tuple(0,0,common::ROARING);
+  }
+}
+
+//Applies f to the ids of one container until it returns true, true if it did.
+template<typename F>
+inline bool roaring::foreach_in_container(F f, const container &c, const uint8_t *payload){
+  const uint32_t prefix = ((uint32_t)c.key) << 16;
+  switch(c.type){
+    case ARRAY: {
+      const uint16_t *A16 = (const uint16_t*)payload;
+      for(size_t i = 0; i < c.cardinality; i++){
+        if(f(prefix | A16[i]))
+          return true;
+      }
+      break;
+    }
+    case BITMAP: {
+      const uint64_t *A64 = (const uint64_t*)payload;
+      for(size_t i = 0; i < c.length; i++){
+        uint64_t cur_word = A64[i];
+        while(cur_word != 0){
+          const uint32_t bit = __builtin_ctzll(cur_word);
+          if(f(prefix | ((c.first_word+i)*BITS_PER_WORD + bit)))
+            return true;
+          cur_word &= (cur_word-1);
+        }
+      }
+      break;
+    }
+    default: {
+      const uint16_t *R = (const uint16_t*)payload;
+      for(size_t r = 0; r < c.length; r++){
+        for(uint32_t cur = R[2*r]; cur <= R[2*r+1]; cur++){
+          if(f(prefix | cur))
+            return true;
+        }
+      }
+      break;
+    }
+  }
+  return false;
+}
+
+//Iterates over set applying a lambda.
+template<typename F>
+inline void roaring::foreach(
+    F f,
+    const uint8_t *A,
+    const size_t cardinality,
+    const size_t number_of_bytes,
+    const common::type type) {
+  (void) cardinality; (void) type;
+
+  const size_t n = num_containers(A,number_of_bytes);
+  const container *dir = directory(A);
+  const uint8_t *payload = payloads(A,n);
+  for(size_t c = 0; c < n; c++){
+    foreach_in_container([&f](uint32_t cur){
+      f(cur);
+      return false;
+    },dir[c],payload+dir[c].offset);
+  }
+}
+
+//Iterates over set applying a lambda until it returns true.
+template<typename F>
+inline void roaring::foreach_until(
+    F f,
+    const uint8_t *A,
+    const size_t cardinality,
+    const size_t number_of_bytes,
+    const common::type type) {
+  (void) cardinality; (void) type;
+
+  const size_t n = num_containers(A,number_of_bytes);
+  const container *dir = directory(A);
+  const uint8_t *payload = payloads(A,n);
+  for(size_t c = 0; c < n; c++){
+    if(foreach_in_container(f,dir[c],payload+dir[c].offset))
+      break;
+  }
+}
+
+// Iterates over set applying a lambda in parallel, one container at a time.
+template<typename F>
+inline size_t roaring::par_foreach(
+      F f,
+      const size_t num_threads,
+      const uint8_t *A,
+      const size_t cardinality,
+      const size_t number_of_bytes,
+      const common::type t) {
+  (void) cardinality; (void) t;
+
+  const size_t n = num_containers(A,number_of_bytes);
+  const container *dir = directory(A);
+  const uint8_t *payload = payloads(A,n);
+  return common::par_for_range(num_threads, 0, n, 1,
+    [&f, dir, payload](size_t tid, size_t c) {
+      foreach_in_container([&f,tid](uint32_t cur){
+        f(tid,cur);
+        return false;
+      },dir[c],payload+dir[c].offset);
+    });
+}
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef _RUNS_H_
+#define _RUNS_H_
+/*
+
+THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH THE RUNS LAYOUT.
+THE SET IS STORED AS (START,LENGTH) PAIRS OF 32-BIT INTEGERS, ONE FOR EVERY
+MAXIMAL RANGE OF CONSECUTIVE IDS, WHICH IS SMALL AFTER ORDERINGS (BFS, RCM)
+THAT GIVE NEIGHBORS CONSECUTIVE IDS.
+
+*/
+
+#include "common.hpp"
+
+class runs{
+  public:
+    static common::type get_type();
+    static size_t count_runs(const uint32_t *data, const size_t length);
+    static size_t build(uint8_t *r_in, const uint32_t *data, const size_t length);
+    static size_t build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length);
+    static tuple<size_t,size_t,common::type> get_flattened_data(const uint8_t *set_data, const size_t cardinality);
+
+    template<typename F>
+    static void foreach(
+        F f,
+        const uint8_t *data_in,
+        const size_t cardinality,
+        const size_t number_of_bytes,
+        const common::type t);
+
+    template<typename F>
+    static void foreach_until(
+        F f,
+        const uint8_t *data_in,
+        const size_t cardinality,
+        const size_t number_of_bytes,
+        const common::type t);
+
+    template<typename F>
+    static size_t par_foreach(
+      F f,
+      const size_t num_threads,
+      const uint8_t *data_in,
+      const size_t cardinality,
+      const size_t number_of_bytes,
+      const common::type t);
+};
+
+inline common::type runs::get_type(){
+  return common::RUNS;
+}
+
+inline size_t runs::count_runs(const uint32_t *data, const size_t length){
+  size_t num_runs = (length > 0);
+  for(size_t i = 1; i < length; i++){
+    num_runs += (data[i] != data[i-1]+1);
+  }
+  return num_runs;
+}
+
+//Copies data from input array of ints to our set data r_in
+inline size_t runs::build(uint8_t *r_in, const uint32_t *data, const size_t length){
+  if(length == 0)
+    return 0;
+
+  uint32_t *R = (uint32_t*) r_in;
+  size_t num_runs = 0;
+  R[0] = data[0];
+  for(size_t i = 1; i < length; i++){
+    if(data[i] != data[i-1]+1){
+      R[2*num_runs+1] = data[i-1]-R[2*num_runs]+1;
+      num_runs++;
+      R[2*num_runs] = data[i];
+    }
+  }
+  R[2*num_runs+1] = data[length-1]-R[2*num_runs]+1;
+  num_runs++;
+  return num_runs*2*sizeof(uint32_t);
+}
+
+//The number of bytes is stored in front of the set like in the bitset.
+inline size_t runs::build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length){
+  if(length > 0){
+    common::num_runs++;
+    uint32_t *size_ptr = (uint32_t*) r_in;
+    size_t num_bytes = build(r_in+sizeof(uint32_t),data,length);
+    size_ptr[0] = (uint32_t)num_bytes;
+    return num_bytes+sizeof(uint32_t);
+  } else{
+    return 0;
+  }
+}
+
+inline tuple<size_t,size_t,common::type> runs::get_flattened_data(const uint8_t *set_data, const size_t cardinality){
+  if(cardinality > 0){
+    const uint32_t *size_ptr = (uint32_t*) set_data;
+    return make_tuple(sizeof(uint32_t),(size_t)size_ptr[0],common::RUNS);
+  } else{
+    return make_tuple(0,0,common::RUNS);
+  }
+}
+
+//Iterates over set applying a lambda.
+template<typename F>
+inline void runs::foreach(
+    F f,
+    const uint8_t *data_in,
+    const size_t cardinality,
+    const size_t number_of_bytes,
+    const common::type t) {
+  (void) cardinality; (void) t;
+
+  const uint32_t *R = (const uint32_t*) data_in;
+  const size_t num_runs = number_of_bytes/(2*sizeof(uint32_t));
+  for(size_t r = 0; r < num_runs; r++){
+    const uint32_t end = R[2*r]+R[2*r+1];
+    for(uint32_t cur = R[2*r]; cur != end; cur++){
+      f(cur);
+    }
+  }
+}
+
+//Iterates over set applying a lambda until it returns true.
+template<typename F>
+inline void runs::foreach_until(
+    F f,
+    const uint8_t *data_in,
+    const size_t cardinality,
+    const size_t number_of_bytes,
+    const common::type t) {
+  (void) cardinality; (void) t;
+
+  const uint32_t *R = (const uint32_t*) data_in;
+  const size_t num_runs = number_of_bytes/(2*sizeof(uint32_t));
+  for(size_t r = 0; r < num_runs; r++){
+    const uint32_t end = R[2*r]+R[2*r+1];
+    for(uint32_t cur = R[2*r]; cur != end; cur++){
+      if(f(cur))
+        return;
+    }
+  }
+}
+
+/*
+Iterates over set applying a lambda in parallel. The ids are handed out in
+blocks of equal size, so a single long run is split across the threads.
+*/
+template<typename F>
+inline size_t runs::par_foreach(
+      F f,
+      const size_t num_threads,
+      const uint8_t *data_in,
+      const size_t cardinality,
+      const size_t number_of_bytes,
+      const common::type t) {
+  (void) cardinality; (void) t;
+
+  const uint32_t *R = (const uint32_t*) data_in;
+  const size_t num_runs = number_of_bytes/(2*sizeof(uint32_t));
+  //Position of the end of every run in the sequence of all ids.
+  vector<size_t> run_ends(num_runs);
+  size_t total = 0;
+  for(size_t r = 0; r < num_runs; r++){
+    total += R[2*r+1];
+    run_ends[r] = total;
+  }
+
+  const size_t block_size = 1024;
+  return common::par_for_range(num_threads, 0, (total+block_size-1)/block_size, 1,
+    [&f, &run_ends, R, total, block_size](size_t tid, size_t block) {
+      size_t position = block*block_size;
+      const size_t end = std::min(position+block_size,total);
+      size_t r = std::upper_bound(run_ends.begin(),run_ends.end(),position)-run_ends.begin();
+      for(; position < end; position++){
+        if(position == run_ends[r])
+          r++;
+        f(tid, (uint32_t)(R[2*r]+(position-(run_ends[r]-R[2*r+1]))));
+      }
+    });
+}
+
+#endif
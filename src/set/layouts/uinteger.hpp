@@ -2,16 +2,18 @@
 
 THIS CLASS IMPLEMENTS THE FUNCTIONS ASSOCIATED WITH AN UNCOMPRESSED SET LAYOUT.
 QUITE SIMPLE THE LAYOUT JUST CONTAINS UNSIGNED INTEGERS IN THE SET.
+THE WIDTH OF THE INTEGERS IS THE INDEX TYPE I, UINTEGER IS THE 32-BIT LAYOUT.
 
 */
 
 #include "common.hpp"
 
-class uinteger{
+template<class I>
+class basic_uinteger{
   public:
     static common::type get_type();
-    static size_t build(uint8_t *r_in, const uint32_t *data, const size_t length);
-    static size_t build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length);
+    static size_t build(uint8_t *r_in, const I *data, const size_t length);
+    static size_t build_flattened(uint8_t *r_in, const I *data, const size_t length);
     static tuple<size_t,size_t,common::type> get_flattened_data(const uint8_t *set_data, const size_t cardinality);
 
     template<typename F>
@@ -42,30 +44,37 @@ class uinteger{
     static tuple<size_t,size_t,common::type> intersect(uint8_t *C_in, const uint8_t *A_in, const uint8_t *B_in, const size_t A_cardinality, const size_t B_cardinality, const size_t A_num_bytes, const size_t B_num_bytes, const common::type a_t, const common::type b_t);
 };
 
-inline common::type uinteger::get_type(){
+typedef basic_uinteger<uint32_t> uinteger;
+
+template<class I>
+inline common::type basic_uinteger<I>::get_type(){
   return common::UINTEGER;
 }
 //Copies data from input array of ints to our set data r_in
-inline size_t uinteger::build(uint8_t *r_in, const uint32_t *data, const size_t length){
-  uint32_t *r = (uint32_t*) r_in;
+template<class I>
+inline size_t basic_uinteger<I>::build(uint8_t *r_in, const I *data, const size_t length){
+  I *r = (I*) r_in;
   std::copy(data,data+length,r);
-  return length*sizeof(uint32_t);
+  return length*sizeof(I);
 }
 //Nothing is different about build flattened here. The number of bytes
 //can be infered from the type. This gives us back a true CSR representation.
-inline size_t uinteger::build_flattened(uint8_t *r_in, const uint32_t *data, const size_t length){
+template<class I>
+inline size_t basic_uinteger<I>::build_flattened(uint8_t *r_in, const I *data, const size_t length){
   common::num_uint++;
   return build(r_in,data,length);
 }
 
-inline tuple<size_t,size_t,common::type> uinteger::get_flattened_data(const uint8_t *set_data, const size_t cardinality){
+template<class I>
+inline tuple<size_t,size_t,common::type> basic_uinteger<I>::get_flattened_data(const uint8_t *set_data, const size_t cardinality){
   (void) set_data;
-  return make_tuple(0,cardinality*sizeof(uint32_t),common::UINTEGER);
+  return make_tuple(0,cardinality*sizeof(I),common::UINTEGER);
 }
 
 //Iterates over set applying a lambda.
+template<class I>
 template<typename F>
-inline void uinteger::foreach(
+inline void basic_uinteger<I>::foreach(
     F f,
     const uint8_t *data_in,
     const size_t cardinality,
@@ -73,15 +82,16 @@ inline void uinteger::foreach(
     const common::type t) {
  (void) number_of_bytes; (void) t;
 
- uint32_t *data = (uint32_t*) data_in;
+ const I *data = (const I*) data_in;
  for(size_t i=0; i<cardinality;i++){
   f(data[i]);
  }
 }
 
 //Iterates over set applying a lambda.
+template<class I>
 template<typename F>
-inline void uinteger::foreach_until(
+inline void basic_uinteger<I>::foreach_until(
     F f,
     const uint8_t *data_in,
     const size_t cardinality,
@@ -89,7 +99,7 @@ inline void uinteger::foreach_until(
     const common::type t) {
  (void) number_of_bytes; (void) t;
 
-  uint32_t *data = (uint32_t*) data_in;
+  const I *data = (const I*) data_in;
   for(size_t i=0; i<cardinality;i++){
     if(f(data[i]))
       break;
@@ -97,8 +107,9 @@ inline void uinteger::foreach_until(
 }
 
 // Iterates over set applying a lambda in parallel.
+template<class I>
 template<typename F>
-inline size_t uinteger::par_foreach(
+inline size_t basic_uinteger<I>::par_foreach(
       F f,
       const size_t num_threads,
       const uint8_t *data_in,
@@ -107,7 +118,7 @@ inline size_t uinteger::par_foreach(
       const common::type t) {
    (void) number_of_bytes; (void) t;
 
-   uint32_t* data = (uint32_t*) data_in;
+   const I* data = (const I*) data_in;
    return common::par_for_range(num_threads, 0, cardinality, (cardinality/num_threads)+1,
      [&f, &data](size_t tid, size_t i) {
         f(tid, data[i]);
@@ -54,8 +54,8 @@ inline size_t variant::encode(const uint32_t *data, size_t data_i, const size_t
   while(data_i < length){
     uint32_t cur = data[data_i++];
     //cout << "data_i: " << data_i-1 << " cur: " << cur << endl;
-    uint32_t bytes_needed = ceil((log2(cur)+1)/7); //1 bit is reserved for continue
-    if(bytes_needed == 0) bytes_needed = 1;
+    //1 bit is reserved for continue, a zero still takes one byte (log2(0) is -inf).
+    uint32_t bytes_needed = (cur == 0) ? 1 : (uint32_t)ceil((log2(cur)+1)/7);
     //cout << "Bytes needed: " << bytes_needed << " " << (uint32_t)log2(cur) << " " << cur << " " << data_i-1 << endl;
     size_t bytes_set = 0;
     while(bytes_set < bytes_needed){
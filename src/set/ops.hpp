@@ -3,6 +3,9 @@
 
 #include "Set.hpp"
 #include "ops/sse_masks.hpp"
+#include "ops/wide_intersection.hpp"
+#include "ops/wide_bitset.hpp"
+#include "ops/dispatch.hpp"
 #include "ops/intersection.hpp"
 #include "ops/union.hpp"
 #include "ops/difference.hpp"
@@ -28,15 +28,11 @@ namespace ops{
       //4 longs
       size_t i = 0;
       #if VECTORIZE == 1
-      uint64_t tmp[4];
-      for(; (i+3) < total_size; i += 4){
-        const __m256 a1 = _mm256_loadu_ps((const float*)&A[i+a_start_index]);
-        const __m256 a2 = _mm256_loadu_ps((const float*)&B[i+b_start_index]);
-        const __m256 r = _mm256_andnot_ps(a2, a1);
+      uint64_t tmp[64];
+      for(; (i+63) < total_size; i += 64){
+        kernels.andnot_words(tmp,&A[i+a_start_index],&B[i+b_start_index],64);
 
-        _mm256_storeu_ps((float*)&tmp, r);
-
-        for(size_t offset = 0; offset < 4; offset++){
+        for(size_t offset = 0; offset < 64; offset++){
           if(tmp[offset] != 0){
             for(size_t j = 0; j < BITS_PER_WORD; j++){
               if((tmp[offset] >> j) % 2){
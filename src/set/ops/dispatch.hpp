@@ -0,0 +1,120 @@
+#ifndef _DISPATCH_H_
+#define _DISPATCH_H_
+
+/*
+RUNTIME SELECTION OF THE SET KERNELS. THE BINARIES ARE BUILT FOR SSE4.2 AND
+THE WIDER KERNELS OF wide_intersection.hpp AND wide_bitset.hpp ARE COMPILED
+FOR THEIR OWN TARGETS. AT STARTUP THE WIDEST VARIANT THE CPU (AND THE OS)
+SUPPORTS IS READ WITH CPUID AND ITS KERNELS ARE STORED IN ops::kernels:
+
+  sse4.2        128-bit loops of intersection.hpp only
+  avx2          256-bit block loops
+  avx512        512-bit block loops
+  avx512vbmi2   avx512 with the 16-bit compress for pshort
+
+The set operations call the kernels through the wide_* functions below.
+*/
+namespace ops{
+  enum isa {
+    SSE42 = 0,
+    AVX2 = 1,
+    AVX512 = 2,
+    AVX512VBMI2 = 3
+  };
+
+  struct kernel_table{
+    isa level;
+    const char *name;
+    //NULL if the 128-bit loops are the widest.
+    size_t (*intersect_vector32)(uint32_t *C, const uint32_t *A, const uint32_t *B,
+      const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b);
+    size_t (*intersect_vector16)(uint16_t *C, const uint16_t *A, const uint16_t *B,
+      const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b);
+    size_t (*intersect_partition)(uint32_t *C, const uint32_t *A, const uint16_t *B,
+      const size_t s_a, const size_t s_b, const uint32_t prefix, size_t &i_a, size_t &i_b);
+    size_t (*and_words)(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n);
+    void (*or_words)(uint64_t *A, const uint64_t *B, const size_t n);
+    void (*andnot_words)(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n);
+  };
+
+  inline isa detect_isa(){
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")){
+      if(__builtin_cpu_supports("avx512vbmi2"))
+        return AVX512VBMI2;
+      return AVX512;
+    }
+    if(__builtin_cpu_supports("avx2"))
+      return AVX2;
+    return SSE42;
+  }
+
+  inline kernel_table make_kernel_table(const isa level){
+    kernel_table table;
+    table.level = level;
+    switch(level){
+      case AVX512VBMI2:
+      case AVX512:
+        table.name = (level == AVX512VBMI2) ? "avx512vbmi2" : "avx512";
+        table.intersect_vector32 = &avx512_intersect_vector32;
+        table.intersect_vector16 = (level == AVX512VBMI2) ? &avx512vbmi2_intersect_vector16 : &avx512_intersect_vector16;
+        table.intersect_partition = &avx512_intersect_partition;
+        table.and_words = &avx512_and_words;
+        table.or_words = &avx512_or_words;
+        table.andnot_words = &avx512_andnot_words;
+        break;
+      case AVX2:
+        table.name = "avx2";
+        table.intersect_vector32 = &avx2_intersect_vector32;
+        table.intersect_vector16 = &avx2_intersect_vector16;
+        table.intersect_partition = &avx2_intersect_partition;
+        table.and_words = &avx2_and_words;
+        table.or_words = &avx2_or_words;
+        table.andnot_words = &avx2_andnot_words;
+        break;
+      default:
+        table.name = "sse4.2";
+        table.intersect_vector32 = NULL;
+        table.intersect_vector16 = NULL;
+        table.intersect_partition = NULL;
+        table.and_words = &sse_and_words;
+        table.or_words = &sse_or_words;
+        table.andnot_words = &sse_andnot_words;
+        break;
+    }
+    return table;
+  }
+
+  static kernel_table kernels = make_kernel_table(detect_isa());
+
+  //Switches to the kernels of a narrower ISA, false if the CPU lacks it.
+  inline bool use_isa(const isa level){
+    if(level > detect_isa())
+      return false;
+    kernels = make_kernel_table(level);
+    return true;
+  }
+
+  inline size_t wide_intersect_vector32(uint32_t *C, const uint32_t *A, const uint32_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    if(kernels.intersect_vector32 == NULL)
+      return 0;
+    return kernels.intersect_vector32(C,A,B,s_a,s_b,i_a,i_b);
+  }
+
+  inline size_t wide_intersect_vector16(uint16_t *C, const uint16_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    if(kernels.intersect_vector16 == NULL)
+      return 0;
+    return kernels.intersect_vector16(C,A,B,s_a,s_b,i_a,i_b);
+  }
+
+  inline size_t wide_intersect_partition(uint32_t *C, const uint32_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, const uint32_t prefix, size_t &i_a, size_t &i_b){
+    if(kernels.intersect_partition == NULL)
+      return 0;
+    return kernels.intersect_partition(C,A,B,s_a,s_b,prefix,i_a,i_b);
+  }
+}
+
+#endif
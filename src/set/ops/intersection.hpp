@@ -705,6 +705,7 @@ namespace ops{
 
     // trim lengths to be a multiple of 4
     #if VECTORIZE == 1
+    count += wide_intersect_vector32(C,A,B,s_a,s_b,i_a,i_b);
     size_t st_a = (s_a / 4) * 4;
     size_t st_b = (s_b / 4) * 4;
 
@@ -779,6 +780,7 @@ namespace ops{
     size_t i_a = 0, i_b = 0;
 
     #if VECTORIZE == 1
+    count += wide_intersect_vector16(C,A,B,s_a,s_b,i_a,i_b);
     size_t st_a = (s_a / SHORTS_PER_REG) * SHORTS_PER_REG;
     size_t st_b = (s_b / SHORTS_PER_REG) * SHORTS_PER_REG;
 
@@ -914,24 +916,8 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
       #endif
 
       #if VECTORIZE == 1
-      uint64_t tmp[4];
-      while((i+3) < total_size){
-        const __m256 a1 = _mm256_loadu_ps((const float*)(A + i + a_start_index));
-        const __m256 a2 = _mm256_loadu_ps((const float*)(B + i + b_start_index));
-        const __m256 r = _mm256_and_ps(a2, a1);
-
-        #if WRITE_VECTOR == 1
-        _mm256_storeu_ps((float*)(C + i), r);
-        #endif
-
-        _mm256_storeu_ps((float*)tmp, r);
-        count += _mm_popcnt_u64(tmp[0]);
-        count += _mm_popcnt_u64(tmp[1]);
-        count += _mm_popcnt_u64(tmp[2]);
-        count += _mm_popcnt_u64(tmp[3]);
-
-        i += 4;
-      }
+      count += kernels.and_words(C,A+a_start_index,B+b_start_index,total_size);
+      i = total_size;
       #endif
 
       for(; i < total_size; i++){
@@ -1059,6 +1045,82 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
   inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<bitset> *A_in,const Set<uinteger> *B_in){
     return set_intersect(C_in,B_in,A_in);
   }
+  /*
+  Intersects the ids of A from a_i on that start with prefix (their upper 16
+  bits) with the s_b sorted lower halves in B, advancing a_i over the ids it
+  consumed. This is a partition of a pshort or an array container of a
+  roaring set.
+  */
+  inline size_t intersect_partition(uint32_t *C, const uint32_t *A, const size_t s_a, size_t &a_i,
+    const uint32_t prefix, const uint16_t *B, const size_t s_b){
+    #if WRITE_VECTOR == 0
+    (void)C;
+    #endif
+    size_t count = 0;
+    size_t i_b = 0;
+
+    #if VECTORIZE == 1
+    count += wide_intersect_partition(&C[count],A,B,s_a,s_b,prefix,a_i,i_b);
+    bool a_continue = (a_i+SHORTS_PER_REG) < s_a && (A[a_i+SHORTS_PER_REG-1] & 0xFFFF0000) == prefix;
+    size_t st_b = (s_b / SHORTS_PER_REG) * SHORTS_PER_REG;
+    while(a_continue && i_b < st_b) {
+      __m128i v_a_1_32 = _mm_loadu_si128((__m128i*)&A[a_i]);
+      __m128i v_a_2_32 = _mm_loadu_si128((__m128i*)&A[a_i+(SHORTS_PER_REG/2)]);
+
+      __m128i v_a_1 = _mm_shuffle_epi8(v_a_1_32,_mm_set_epi8(uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x0D),uint8_t(0x0C),uint8_t(0x09),uint8_t(0x08),uint8_t(0x05),uint8_t(0x04),uint8_t(0x01),uint8_t(0x0)));
+      __m128i v_a_2 = _mm_shuffle_epi8(v_a_2_32,_mm_set_epi8(uint8_t(0x0D),uint8_t(0x0C),uint8_t(0x09),uint8_t(0x08),uint8_t(0x05),uint8_t(0x04),uint8_t(0x01),uint8_t(0x0),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80)));
+      
+      __m128i v_a = _mm_or_si128(v_a_1,v_a_2);
+        
+      //uint16_t *t = (uint16_t*) &v_a;
+      //cout << "Data: " << t[0] << " " << t[1] << " " << t[2] << " " << t[3] << " " << t[4] << " " << t[5] << " " << t[6] << " " << t[7] << endl;
+
+      __m128i v_b = _mm_loadu_si128((__m128i*)&B[i_b]);    
+
+      uint16_t a_max = _mm_extract_epi16(v_a, SHORTS_PER_REG-1);
+      uint16_t b_max = _mm_extract_epi16(v_b, SHORTS_PER_REG-1);
+      
+      __m128i res_v = _mm_cmpestrm(v_b, SHORTS_PER_REG, v_a, SHORTS_PER_REG,
+              _SIDD_UWORD_OPS|_SIDD_CMP_EQUAL_ANY|_SIDD_BIT_MASK);
+      uint32_t r = _mm_extract_epi32(res_v, 0);
+
+      #if WRITE_VECTOR == 1
+      uint32_t r_lower = r & 0x0F;
+      uint32_t r_upper = (r & 0xF0) >> 4;
+      __m128i p = _mm_shuffle_epi8(v_a_1_32,shuffle_mask32[r_lower]);
+      _mm_storeu_si128((__m128i*)&C[count], p);
+      
+      //uint32_t *t = (uint32_t*) &p;
+      //cout << "Data: " << t[0] << " " << t[1] << " " << t[2] << " " << t[3] << endl;
+
+      p = _mm_shuffle_epi8(v_a_2_32,shuffle_mask32[r_upper]);
+      _mm_storeu_si128((__m128i*)&C[count+_mm_popcnt_u32(r_lower)], p);
+      #endif
+
+      count += _mm_popcnt_u32(r);
+      a_i += (a_max <= b_max) * SHORTS_PER_REG;
+      a_continue = (a_i+SHORTS_PER_REG) < s_a && (A[a_i+SHORTS_PER_REG-1] & 0xFFFF0000) == prefix;
+      i_b += (a_max >= b_max) * SHORTS_PER_REG;
+    }
+    #endif
+
+    bool notFinished = a_i < s_a  && i_b < s_b && (A[a_i] & 0xFFFF0000) == prefix;
+    while(notFinished){
+      while(notFinished && (uint32_t)(prefix | B[i_b]) < A[a_i]){
+        ++i_b;
+        notFinished = i_b < s_b;
+      }
+      if(notFinished && A[a_i] == (uint32_t)(prefix | B[i_b])){
+        #if WRITE_VECTOR == 1
+        C[count] = A[a_i];
+        #endif
+        ++count;
+      }
+      ++a_i;
+      notFinished = notFinished && a_i < s_a && (A[a_i] & 0xFFFF0000) == prefix;
+    }
+    return count;
+  }
   inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<uinteger> *A_in,const Set<pshort> *B_in){
     uint32_t * const C = (uint32_t*)C_in->data;
     const uint32_t * const A = (uint32_t*)A_in->data;
@@ -1095,68 +1157,7 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
       } else{
         //cout << "3" << endl;
         b_i += 2;
-        size_t i_b = 0;
-
-        #if VECTORIZE == 1
-        bool a_continue = (a_i+SHORTS_PER_REG) < s_a && (A[a_i+SHORTS_PER_REG-1] & 0xFFFF0000) == prefix;
-        size_t st_b = (b_inner_size / SHORTS_PER_REG) * SHORTS_PER_REG;
-        while(a_continue && i_b < st_b) {
-          __m128i v_a_1_32 = _mm_loadu_si128((__m128i*)&A[a_i]);
-          __m128i v_a_2_32 = _mm_loadu_si128((__m128i*)&A[a_i+(SHORTS_PER_REG/2)]);
-
-          __m128i v_a_1 = _mm_shuffle_epi8(v_a_1_32,_mm_set_epi8(uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x0D),uint8_t(0x0C),uint8_t(0x09),uint8_t(0x08),uint8_t(0x05),uint8_t(0x04),uint8_t(0x01),uint8_t(0x0)));
-          __m128i v_a_2 = _mm_shuffle_epi8(v_a_2_32,_mm_set_epi8(uint8_t(0x0D),uint8_t(0x0C),uint8_t(0x09),uint8_t(0x08),uint8_t(0x05),uint8_t(0x04),uint8_t(0x01),uint8_t(0x0),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80),uint8_t(0x80)));
-          
-          __m128i v_a = _mm_or_si128(v_a_1,v_a_2);
-            
-          //uint16_t *t = (uint16_t*) &v_a;
-          //cout << "Data: " << t[0] << " " << t[1] << " " << t[2] << " " << t[3] << " " << t[4] << " " << t[5] << " " << t[6] << " " << t[7] << endl;
-
-          __m128i v_b = _mm_loadu_si128((__m128i*)&B[b_i+i_b]);    
-
-          uint16_t a_max = _mm_extract_epi16(v_a, SHORTS_PER_REG-1);
-          uint16_t b_max = _mm_extract_epi16(v_b, SHORTS_PER_REG-1);
-          
-          __m128i res_v = _mm_cmpestrm(v_b, SHORTS_PER_REG, v_a, SHORTS_PER_REG,
-                  _SIDD_UWORD_OPS|_SIDD_CMP_EQUAL_ANY|_SIDD_BIT_MASK);
-          uint32_t r = _mm_extract_epi32(res_v, 0);
-
-          #if WRITE_VECTOR == 1
-          uint32_t r_lower = r & 0x0F;
-          uint32_t r_upper = (r & 0xF0) >> 4;
-          __m128i p = _mm_shuffle_epi8(v_a_1_32,shuffle_mask32[r_lower]);
-          _mm_storeu_si128((__m128i*)&C[count], p);
-          
-          //uint32_t *t = (uint32_t*) &p;
-          //cout << "Data: " << t[0] << " " << t[1] << " " << t[2] << " " << t[3] << endl;
-
-          p = _mm_shuffle_epi8(v_a_2_32,shuffle_mask32[r_upper]);
-          _mm_storeu_si128((__m128i*)&C[count+_mm_popcnt_u32(r_lower)], p);
-          C[count] = A[a_i];
-          #endif
-
-          count += _mm_popcnt_u32(r);
-          a_i += (a_max <= b_max) * SHORTS_PER_REG;
-          a_continue = (a_i+SHORTS_PER_REG) < s_a && (A[a_i+SHORTS_PER_REG-1] & 0xFFFF0000) == prefix;
-          i_b += (a_max >= b_max) * SHORTS_PER_REG;
-        }
-        #endif
-
-        bool notFinished = a_i < s_a  && i_b < b_inner_size && (A[a_i] & 0xFFFF0000) == prefix;
-        while(notFinished){
-          while(notFinished && (uint32_t)(prefix | B[i_b+b_i]) < A[a_i]){
-            ++i_b;
-            notFinished = i_b < b_inner_size;
-          }
-          if(notFinished && A[a_i] == (uint32_t)(prefix | B[i_b+b_i])){
-            #if WRITE_VECTOR == 1
-            C[count] = A[a_i];
-            #endif
-            ++count;
-          }
-          ++a_i;
-          notFinished = notFinished && a_i < s_a && (A[a_i] & 0xFFFF0000) == prefix;
-        }
+        count += intersect_partition(&C[count],A,s_a,a_i,prefix,&B[b_i],b_inner_size);
         b_i = inner_end;
         not_finished = a_i < s_a && b_i < s_b;
       }
@@ -1171,333 +1172,758 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
 
     return C_in;
   }
-  inline size_t simd_intersect_offsets(
-    uint32_t *C, 
-    uint32_t *position_data_A, 
-    uint32_t *position_data_B, 
-    uint32_t *A, 
-    size_t s_a,
-    uint32_t *B, 
-    size_t s_b,
-    uint64_t *A_data,
-    uint64_t *B_data){    
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<pshort> *A_in,const Set<uinteger> *B_in){
+    return set_intersect(C_in,B_in,A_in);
+  }
 
-    const size_t bytes_per_block = (BLOCK_SIZE/8);
-    const size_t words_per_block = bytes_per_block/sizeof(uint64_t);
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in, const Set<uinteger> *A_in, const Set<uinteger> *B_in) {
+    const Set<uinteger> *rare = (A_in->cardinality > B_in->cardinality) ? B_in:A_in;
+    const Set<uinteger> *freq = (A_in->cardinality > B_in->cardinality) ? A_in:B_in;
+    const unsigned long min_size = 1;
 
-    size_t count = 0;
-    size_t i_a = 0, i_b = 0;
+    //return set_intersect_standard(C_in, rare, freq);
 
-    // trim lengths to be a multiple of 4
-    #if VECTORIZE == 1
-    size_t st_a = (s_a / 4) * 4;
-    size_t st_b = (s_b / 4) * 4;
-    uint32_t offset[] = {0,1,2,3};
-    const __m128i offset_reg = _mm_loadu_si128((__m128i*)&offset);
+    if(std::max(A_in->cardinality,B_in->cardinality) / std::max(min_size, std::min(A_in->cardinality,B_in->cardinality)) > 32)
+      return set_intersect_galloping(C_in, rare, freq);
+    else
+      return set_intersect_standard(C_in, rare, freq);
+  }
 
-    while(i_a < st_a && i_b < st_b) {
-      //[ load segments of four 32-bit elements
-      __m128i v_a = _mm_loadu_si128((__m128i*)&A[i_a]);
-      __m128i v_b = _mm_loadu_si128((__m128i*)&B[i_b]);
-      //]
+  inline size_t intersect_block(uint64_t *result_data, const uint64_t *A, const uint64_t *B){
+    //BLOCK SIZE HAS TO BE A MULTIPLE OF 64
+    return kernels.and_words(result_data,A,B,BLOCK_SIZE/64);
+  }
+  /*
+  Merges the block ids of A and B four at a time and ANDs the blocks whose
+  ids match straight into the result. Blocks that come out empty are
+  dropped so the result stays block-sparse. The directory is written for
+  min(s_a,s_b) blocks, the most there can be, and the blocks are moved down
+  behind it at the end. Every block holds at least one element of the
+  smaller input, so C_in needs at most MAX_BYTES_PER_ELEMENT bytes per
+  element of it.
+  */
+  inline Set<bitset_new>* set_intersect(Set<bitset_new> *C_in,const Set<bitset_new> *A_in,const Set<bitset_new> *B_in){
+    if(A_in->number_of_bytes == 0 || B_in->number_of_bytes == 0){
+      C_in->cardinality = 0;
+      C_in->number_of_bytes = 0;
+      C_in->density = 0.0;
+      C_in->type= common::BITSET_NEW;
+      return C_in;
+    }
+
+    const size_t bytes_per_block = (BLOCK_SIZE/8);
+    const size_t words_per_block = bytes_per_block/sizeof(uint64_t);
 
-      const __m128i a_offset = _mm_set1_epi32(i_a);
+    const size_t s_a = bitset_new::num_blocks(A_in->number_of_bytes);
+    const size_t s_b = bitset_new::num_blocks(B_in->number_of_bytes);
+    const uint32_t * const A = (uint32_t*)A_in->data;
+    const uint32_t * const B = (uint32_t*)B_in->data;
+    const uint64_t * const A_data = bitset_new::blocks(A_in->data,s_a);
+    const uint64_t * const B_data = bitset_new::blocks(B_in->data,s_b);
 
-      //[ move pointers
-      uint32_t a_max = A[i_a+3];
-      uint32_t b_max = B[i_b+3];
-      //]
+    const size_t capacity = std::min(s_a,s_b);
+    uint32_t * const C = (uint32_t*)C_in->data;
+    uint64_t * const C_data = (uint64_t*)(C_in->data+capacity*sizeof(uint32_t));
 
-      //[ compute mask of common elements
-      uint32_t right_cyclic_shift = _MM_SHUFFLE(0,3,2,1);
-      __m128i cmp_mask1 = _mm_cmpeq_epi32(v_a, v_b);    // pairwise comparison
-      v_b = _mm_shuffle_epi32(v_b, right_cyclic_shift);       // shuffling
-      __m128i cmp_mask2 = _mm_cmpeq_epi32(v_a, v_b);    // again...
-      v_b = _mm_shuffle_epi32(v_b, right_cyclic_shift);
-      __m128i cmp_mask3 = _mm_cmpeq_epi32(v_a, v_b);    // and again...
-      v_b = _mm_shuffle_epi32(v_b, right_cyclic_shift);
-      __m128i cmp_mask4 = _mm_cmpeq_epi32(v_a, v_b);    // and again.
-      __m128i cmp_mask = _mm_or_si128(
-              _mm_or_si128(cmp_mask1, cmp_mask2),
-              _mm_or_si128(cmp_mask3, cmp_mask4)
-      ); // OR-ing of comparison masks
-      // convert the 128-bit mask to the 4-bit mask
-      uint32_t mask = _mm_movemask_ps((__m128)cmp_mask);
-      //]
-      //[ copy out common elements
-      //#if WRITE_VECTOR == 1
-      __m128i r = _mm_shuffle_epi8(v_a, shuffle_mask32[mask]);
-      _mm_storeu_si128((__m128i*)&C[count], r);
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
 
-      const __m128i p1 = _mm_shuffle_epi8(offset_reg, shuffle_mask32[mask]);
-      _mm_storeu_si128((__m128i*)&position_data_A[count], _mm_add_epi32(p1,a_offset));
+    size_t count = 0;
+    size_t n_c = 0;
+    size_t i_a = 0, i_b = 0;
 
-      //const __m128i p2 = _mm_shuffle_epi8(offset_reg, shuffle_mask32[mask]);
-      //_mm_storeu_si128((__m128i*)&position_data_B[count], _mm_add_epi32(p2,b_offset));
+    #if VECTORIZE == 1
+    const size_t st_a = (s_a / INTS_PER_REG) * INTS_PER_REG;
+    const size_t st_b = (s_b / INTS_PER_REG) * INTS_PER_REG;
+    while(i_a < st_a && i_b < st_b){
+      const __m128i v_a = _mm_loadu_si128((__m128i*)&A[i_a]);
+      __m128i v_b = _mm_loadu_si128((__m128i*)&B[i_b]);
 
-      const size_t tmp_count = _mm_popcnt_u32(mask);;
-      size_t b_index = 0;
-      for(size_t i = count; i < (tmp_count+count); i ++){
-        while(B[i_b+b_index] < C[i]){
-          b_index++;
+      const uint32_t a_max = A[i_a+INTS_PER_REG-1];
+      const uint32_t b_max = B[i_b+INTS_PER_REG-1];
+
+      //Lane j of the k-th compare holds A[i_a+j] == B[i_b+(j+k)%4].
+      const uint32_t right_cyclic_shift = _MM_SHUFFLE(0,3,2,1);
+      const uint32_t m1 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v_a,v_b)));
+      v_b = _mm_shuffle_epi32(v_b,right_cyclic_shift);
+      const uint32_t m2 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v_a,v_b)));
+      v_b = _mm_shuffle_epi32(v_b,right_cyclic_shift);
+      const uint32_t m3 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v_a,v_b)));
+      v_b = _mm_shuffle_epi32(v_b,right_cyclic_shift);
+      const uint32_t m4 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v_a,v_b)));
+
+      uint32_t mask_a = m1 | m2 | m3 | m4;
+      uint32_t mask_b = (m1 | (m2 << 1) | (m2 >> 3) | (m3 << 2) | (m3 >> 2) | (m4 << 3) | (m4 >> 1)) & 0x0F;
+      while(mask_a != 0){
+        const size_t j_a = i_a+__builtin_ctz(mask_a);
+        const size_t j_b = i_b+__builtin_ctz(mask_b);
+        const size_t matches = intersect_block(C_data+n_c*words_per_block,
+          A_data+j_a*words_per_block,B_data+j_b*words_per_block);
+        if(matches > 0){
+          #if WRITE_VECTOR == 1
+          C[n_c] = A[j_a];
+          #endif
+          n_c++;
+          count += matches;
         }
-        position_data_B[i] = b_index+i_b;
-        _mm_prefetch(&A_data[position_data_A[i]*words_per_block],_MM_HINT_T1);
-        _mm_prefetch(&B_data[position_data_B[i]*words_per_block],_MM_HINT_T1);
+        mask_a &= (mask_a-1);
+        mask_b &= (mask_b-1);
       }
-      //cout << "C[" << count << "]: " << C[count] << endl;
 
-      //#endif
-
-      i_a += (a_max <= b_max) * 4;
-      i_b += (a_max >= b_max) * 4;
-      count += tmp_count;
-       // a number of elements is a weight of the mask
-      //]
+      i_a += (a_max <= b_max) * INTS_PER_REG;
+      i_b += (a_max >= b_max) * INTS_PER_REG;
     }
     #endif
 
-  // intersect the tail using scalar intersection
-    bool notFinished = i_a < s_a  && i_b < s_b;
-    while(notFinished){
-      while(notFinished && B[i_b] < A[i_a]){
-        ++i_b;
-        notFinished = i_b < s_b;
-      }
-      if(notFinished && A[i_a] == B[i_b]){
-        C[count] = A[i_a];
-        position_data_A[count] = i_a;
-        position_data_B[count] = i_b;
-        _mm_prefetch(&A_data[i_a*words_per_block],_MM_HINT_T1);
-        _mm_prefetch(&B_data[i_b*words_per_block],_MM_HINT_T1);
-        ++count;
+    while(i_a < s_a && i_b < s_b){
+      if(A[i_a] < B[i_b]){
+        i_a++;
+      } else if(B[i_b] < A[i_a]){
+        i_b++;
+      } else{
+        const size_t matches = intersect_block(C_data+n_c*words_per_block,
+          A_data+i_a*words_per_block,B_data+i_b*words_per_block);
+        if(matches > 0){
+          #if WRITE_VECTOR == 1
+          C[n_c] = A[i_a];
+          #endif
+          n_c++;
+          count += matches;
+        }
+        i_a++;
+        i_b++;
       }
-      ++i_a;
-      notFinished = notFinished && i_a < s_a;
     }
 
-    #if WRITE_VECTOR == 0
-    (void) C;
+    #if WRITE_VECTOR == 1
+    if(n_c < capacity){
+      memmove(C_in->data+n_c*sizeof(uint32_t),C_data,n_c*bytes_per_block);
+    }
     #endif
 
-    return count;  
+    C_in->cardinality = count;
+    C_in->number_of_bytes = n_c*(sizeof(uint32_t)+bytes_per_block);
+    C_in->density = 0.0;
+    C_in->type= common::BITSET_NEW;
+
+    return C_in;
+  }
+  inline size_t probe_block(
+    uint32_t *result,
+    uint32_t value,
+    const uint64_t *block){
+    const uint32_t probe_value = value % BLOCK_SIZE;
+    const size_t word_to_check = probe_value / BITS_PER_WORD;
+    const size_t bit_to_check = probe_value % BITS_PER_WORD;
+    if((block[word_to_check] >> bit_to_check) % 2){
+      #if WRITE_VECTOR == 1
+      result[0] = value;
+      #else
+      (void) result;
+      #endif
+      return 1;
+    } 
+    return 0;
   }
-  inline size_t intersect_offsets(
-    uint32_t *C, 
-    uint32_t *position_data_A, 
-    uint32_t *position_data_B, 
-    uint32_t *A, 
-    size_t s_a,
-    uint32_t *B, 
-    size_t s_b,
-    uint64_t *A_data,
-    uint64_t *B_data){
 
-    const size_t bytes_per_block = (BLOCK_SIZE/8);
-    const size_t words_per_block = bytes_per_block/sizeof(uint64_t);
+  //Every id of A is probed in the block of B with its block id, if B has one.
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<uinteger> *A_in,const Set<bitset_new> *B_in){
+    if(A_in->number_of_bytes == 0 || B_in->number_of_bytes == 0){
+      C_in->cardinality = 0;
+      C_in->number_of_bytes = 0;
+      C_in->density = 0.0;
+      C_in->type= common::UINTEGER;
+      return C_in;
+    }
+
+    const size_t words_per_block = (BLOCK_SIZE/8)/sizeof(uint64_t);
+    const size_t s_a = A_in->cardinality;
+    const size_t s_b = bitset_new::num_blocks(B_in->number_of_bytes);
+    const uint32_t * const A = (uint32_t*)A_in->data;
+    const uint32_t * const B = (uint32_t*)B_in->data;
+    const uint64_t * const B_data = bitset_new::blocks(B_in->data,s_b);
+    uint32_t * const C = (uint32_t*)C_in->data;
 
     size_t count = 0;
-    uint32_t i_a = 0;
-    uint32_t i_b = 0;
-    bool notFinished = i_a < s_a  && i_b < s_b;
-    while(notFinished){
-      while(notFinished && B[i_b] < A[i_a]){
-        ++i_b;
-        notFinished = i_b < s_b;
+    size_t i_b = 0;
+    for(size_t i_a = 0; i_a < s_a; i_a++){
+      const uint32_t block_id = A[i_a] >> ADDRESS_BITS_PER_BLOCK;
+      while(i_b < s_b && B[i_b] < block_id){
+        i_b++;
       }
-      if(notFinished && A[i_a] == B[i_b]){
-        C[count] = A[i_a];
-        position_data_A[count] = i_a;
-        position_data_B[count] = i_b;
-        _mm_prefetch(&A_data[i_a*words_per_block],_MM_HINT_T1);
-        _mm_prefetch(&B_data[i_b*words_per_block],_MM_HINT_T1);
-        ++count;
+      if(i_b == s_b)
+        break;
+      if(B[i_b] == block_id){
+        count += probe_block(C+count,A[i_a],B_data+i_b*words_per_block);
       }
-      ++i_a;
-      notFinished = notFinished && i_a < s_a;
     }
-    return count;
+
+    C_in->cardinality = count;
+    C_in->number_of_bytes = count*sizeof(uint32_t);
+    C_in->density = 0.0;
+    C_in->type= common::UINTEGER;
+
+    return C_in;
   }
-  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<pshort> *A_in,const Set<uinteger> *B_in){
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<bitset_new> *A_in,const Set<uinteger> *B_in){
     return set_intersect(C_in,B_in,A_in);
   }
 
-  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in, const Set<uinteger> *A_in, const Set<uinteger> *B_in) {
-    const Set<uinteger> *rare = (A_in->cardinality > B_in->cardinality) ? B_in:A_in;
-    const Set<uinteger> *freq = (A_in->cardinality > B_in->cardinality) ? A_in:B_in;
-    const unsigned long min_size = 1;
+  inline void distinct_merge_three_way(
+    const size_t count,
+    uint32_t *result, 
+    const uint32_t *A, const size_t lenA, 
+    const uint32_t *B, const size_t lenB,
+    const uint32_t *C, const size_t lenC){
 
-    //return set_intersect_standard(C_in, rare, freq);
+    size_t i_a = 0;
+    size_t i_b = 0;
+    size_t i_c = 0;
+    for(size_t i=0; i < count; i++){
+      if(i_a < lenA && i_b < lenB && i_c < lenC){
+        if(A[i_a] <= B[i_b] && A[i_a] <= C[i_c]){
+          result[i] = A[i_a++];
+        } else if(B[i_b] <= A[i_a] && B[i_b] <= C[i_c]){
+          result[i] = B[i_b++];
+        } else{
+          result[i] = C[i_c++];
+        }
+      } else if(i_b < lenB && i_c < lenC){
+        if(B[i_b] <= C[i_c]){
+          result[i] = B[i_b++];
+        } else{
+          result[i] = C[i_c++];
+        }
+      } else if(i_a < lenA && i_c < lenC){
+        if(A[i_a] <= C[i_c]){
+          result[i] = A[i_a++];
+        } else{
+          result[i] = C[i_c++];
+        }
+      } else if(i_a < lenA && i_b < lenB){
+        if(A[i_a] <= B[i_b]){
+          result[i] = A[i_a++];
+        } else{
+          result[i] = B[i_b++];
+        }
+      } else if(i_a < lenA){
+        result[i] = A[i_a++];
+      } else if(i_b < lenB){
+        result[i] = B[i_b++];
+      } else{
+        result[i] = C[i_c++];
+      }
+    }
+  }
 
-    if(std::max(A_in->cardinality,B_in->cardinality) / std::max(min_size, std::min(A_in->cardinality,B_in->cardinality)) > 32)
-      return set_intersect_galloping(C_in, rare, freq);
-    else
-      return set_intersect_standard(C_in, rare, freq);
+  inline Set<new_type>* set_intersect(Set<new_type> *C_in,const Set<new_type> *A_in,const Set<new_type> *B_in){
+    if(A_in->number_of_bytes == 0 || B_in->number_of_bytes == 0){
+      C_in->cardinality = 0;
+      C_in->number_of_bytes = 0;
+      C_in->density = 0.0;
+      C_in->type= common::UINTEGER;
+      return C_in;
+    }
+
+    const size_t A_num_uint_bytes = ((size_t*)A_in->data)[0];
+    uint8_t * A_uinteger_data = A_in->data+sizeof(size_t);
+    uint8_t * A_new_bs_data = A_in->data+sizeof(size_t)+A_num_uint_bytes;
+    const size_t A_num_bs_bytes = A_in->number_of_bytes-(sizeof(size_t)+A_num_uint_bytes);
+    const size_t A_uint_card = A_num_uint_bytes/sizeof(uint32_t);
+
+    const size_t B_num_uint_bytes = ((size_t*)B_in->data)[0];
+    uint8_t * B_uinteger_data = B_in->data+sizeof(size_t);
+    uint8_t * B_new_bs_data = B_in->data+sizeof(size_t)+B_num_uint_bytes;
+    const size_t B_num_bs_bytes = B_in->number_of_bytes-(sizeof(size_t)+B_num_uint_bytes);
+    const size_t B_uint_card = B_num_uint_bytes/sizeof(uint32_t);
+
+    //do all three uintegers then merge then intersect the bs
+    const size_t scratch1_space = A_num_uint_bytes;
+    uint8_t *scratch1 = common::scratch_space1[common::tid];
+    const size_t scratch2_space = A_num_uint_bytes;
+    uint8_t *scratch2 = scratch1+scratch1_space;    
+    uint8_t *scratch3 = scratch2+scratch2_space; 
+    //C_in->data += (scratch1_space+scratch2_space+scratch3_space);  
+
+    const Set<uinteger>A_I(A_uinteger_data,A_uint_card,A_num_uint_bytes,common::UINTEGER);
+    const Set<uinteger>B_I(B_uinteger_data,B_uint_card,B_num_uint_bytes,common::UINTEGER);
+
+    const Set<bitset_new>A_BS(A_new_bs_data,A_in->cardinality-A_uint_card,A_num_bs_bytes,common::BITSET_NEW);
+    const Set<bitset_new>B_BS(B_new_bs_data,B_in->cardinality-B_uint_card,B_num_bs_bytes,common::BITSET_NEW);
+
+    size_t count = 0;
+    
+    uint8_t *C_pointer = C_in->data+sizeof(size_t);
+    if( (A_I.number_of_bytes != 0 || B_I.number_of_bytes != 0) &&
+      (A_BS.number_of_bytes != 0 || B_BS.number_of_bytes != 0)){
+      
+      Set<uinteger>UU(scratch1);
+      Set<uinteger>UBS(scratch2);
+      Set<uinteger>BSU(scratch3);
+
+      UU = ops::set_intersect(&UU,&A_I,&B_I);
+      count += UU.cardinality;
+
+      UBS = ops::set_intersect(&UBS,&A_I,&B_BS);
+      count += UBS.cardinality;
+
+      BSU = ops::set_intersect(&BSU,&B_I,&A_BS);
+      count += BSU.cardinality;
+
+      #if WRITE_VECTOR == 1
+      distinct_merge_three_way(
+        count,
+        (uint32_t*)(C_pointer),
+        (uint32_t*)UU.data,UU.cardinality, 
+        (uint32_t*)UBS.data,UBS.cardinality,
+        (uint32_t*)BSU.data,BSU.cardinality);
+      #endif
+    } else if(A_BS.number_of_bytes == 0 && B_BS.number_of_bytes == 0){
+      Set<uinteger>UU(C_pointer);
+      UU = ops::set_intersect(&UU,&A_I,&B_I);
+      count += UU.cardinality;
+
+      ((size_t*)C_in->data)[0] = (count*sizeof(uint32_t));
+      C_in->cardinality = count;
+      C_in->number_of_bytes = sizeof(size_t)+(count*sizeof(uint32_t));
+      C_in->density = 0.0;
+      C_in->type= common::NEW_TYPE;
+
+      return C_in;
+    }
+    
+    const size_t num_uint = count;
+    ((size_t*)C_in->data)[0] = (num_uint*sizeof(uint32_t));
+    C_pointer += (num_uint*sizeof(uint32_t));
+
+    Set<bitset_new>BSBS(C_pointer);
+    BSBS = ops::set_intersect(&BSBS,&A_BS,&B_BS);
+    count += BSBS.cardinality;
+
+    C_in->cardinality = count;
+    C_in->number_of_bytes = sizeof(size_t)+(num_uint*sizeof(uint32_t))+BSBS.number_of_bytes;
+    C_in->density = 0.0;
+    C_in->type= common::NEW_TYPE;
+
+    return C_in;
+  }
+  /*
+  Container kernels of the roaring layout. Each intersects two containers
+  with equal keys, returns the number of common ids and, with WRITE_VECTOR,
+  writes the payload of the result to C.
+  */
+  inline size_t intersect_array_bitmap(uint16_t *C, const uint16_t *A, const size_t s_a,
+    const uint64_t *B, const size_t first_word, const size_t num_words){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    for(size_t i = 0; i < s_a; i++){
+      const size_t word = A[i] >> ADDRESS_BITS_PER_WORD;
+      if(word < first_word)
+        continue;
+      if(word >= first_word+num_words)
+        break;
+      if((B[word-first_word] >> (A[i] % BITS_PER_WORD)) & 1){
+        #if WRITE_VECTOR == 1
+        C[count] = A[i];
+        #endif
+        count++;
+      }
+    }
+    return count;
   }
 
-  inline size_t intersect_block(uint64_t *result_data, uint64_t *A, uint64_t *B){
-    //BLOCK SIZE HAS TO BE A MULTIPLE OF 256
+  inline size_t intersect_array_runs(uint16_t *C, const uint16_t *A, const size_t s_a,
+    const uint16_t *R, const size_t num_runs){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
     size_t count = 0;
-    if(BLOCK_SIZE >= 256){
-      for(size_t i = 0; i < BLOCK_SIZE; i+=256){
-        const size_t vector_index = (i/64);
-        const __m256 m1 = _mm256_loadu_ps((float*)(A + vector_index));
-        const __m256 m2 = _mm256_loadu_ps((float*)(B + vector_index));
-        const __m256 r = _mm256_and_ps(m1, m2);
-        _mm256_storeu_ps((float*)(result_data+vector_index), r);
-        count += _mm_popcnt_u64(result_data[vector_index]);
-        count += _mm_popcnt_u64(result_data[vector_index+1]);
-        count += _mm_popcnt_u64(result_data[vector_index+2]);
-        count += _mm_popcnt_u64(result_data[vector_index+3]);
+    size_t r = 0;
+    for(size_t i = 0; i < s_a && r < num_runs; i++){
+      while(r < num_runs && R[2*r+1] < A[i])
+        r++;
+      if(r < num_runs && R[2*r] <= A[i]){
+        #if WRITE_VECTOR == 1
+        C[count] = A[i];
+        #endif
+        count++;
       }
-    } else{
-      for(size_t i = 0; i < BLOCK_SIZE; i+=64){
-        const uint64_t r = A[i/64] & B[i/64]; 
+    }
+    return count;
+  }
+
+  //The result keeps the words of the bitmap and clears the bits outside the runs.
+  inline size_t intersect_bitmap_runs(uint64_t *C, const uint64_t *A, const size_t first_word,
+    const size_t num_words, const uint16_t *R, const size_t num_runs){
+    #if WRITE_VECTOR == 1
+    memset(C,(uint8_t)0,num_words*sizeof(uint64_t));
+    #else
+    (void) C;
+    #endif
+    const size_t first_bit = first_word*BITS_PER_WORD;
+    const size_t end_bit = (first_word+num_words)*BITS_PER_WORD;
+    size_t count = 0;
+    for(size_t r = 0; r < num_runs && R[2*r] < end_bit; r++){
+      const size_t start = std::max((size_t)R[2*r],first_bit);
+      const size_t last = std::min((size_t)R[2*r+1],end_bit-1);
+      for(size_t word = (start >> ADDRESS_BITS_PER_WORD); start <= last && word <= (last >> ADDRESS_BITS_PER_WORD); word++){
+        uint64_t mask = ~(uint64_t)0;
+        if(word == (start >> ADDRESS_BITS_PER_WORD))
+          mask &= (~(uint64_t)0) << (start % BITS_PER_WORD);
+        if(word == (last >> ADDRESS_BITS_PER_WORD))
+          mask &= (~(uint64_t)0) >> (BITS_PER_WORD-1-(last % BITS_PER_WORD));
+        const uint64_t result = A[word-first_word] & mask;
         #if WRITE_VECTOR == 1
-        result_data[i/64] = r;
+        C[word-first_word] |= result;
         #endif
-        count += _mm_popcnt_u64(r);
+        count += _mm_popcnt_u64(result);
       }
     }
+    return count;
+  }
 
+  inline size_t intersect_runs(uint16_t *C, size_t &num_runs, const uint16_t *A, const size_t s_a,
+    const uint16_t *B, const size_t s_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    size_t i_a = 0, i_b = 0;
+    num_runs = 0;
+    while(i_a < s_a && i_b < s_b){
+      const uint16_t start = std::max(A[2*i_a],B[2*i_b]);
+      const uint16_t last = std::min(A[2*i_a+1],B[2*i_b+1]);
+      if(start <= last){
+        #if WRITE_VECTOR == 1
+        C[2*num_runs] = start;
+        C[2*num_runs+1] = last;
+        #endif
+        num_runs++;
+        count += (last-start)+1;
+      }
+      if(A[2*i_a+1] < B[2*i_b+1])
+        i_a++;
+      else
+        i_b++;
+    }
     return count;
   }
-  inline Set<bitset_new>* set_intersect(Set<bitset_new> *C_in,const Set<bitset_new> *A_in,const Set<bitset_new> *B_in){
-    if(A_in->number_of_bytes == 0 || B_in->number_of_bytes == 0){
-      C_in->cardinality = 0;
-      C_in->number_of_bytes = 0;
-      C_in->density = 0.0;
-      C_in->type= common::UINTEGER;
-      return C_in;
+
+  /*
+  Intersects two containers with equal keys and fills the directory entry c
+  of the result. The result is an array if either side is one, otherwise a
+  bitmap if either side is one and runs if both are.
+  */
+  inline size_t intersect_containers(uint8_t *C, roaring::container *c,
+    const roaring::container *a, const uint8_t *A, const roaring::container *b, const uint8_t *B){
+    if(a->type > b->type){
+      std::swap(a,b);
+      std::swap(A,B);
+    }
+    c->key = a->key;
+    c->unused = 0;
+    c->first_word = 0;
+    c->length = 0;
+
+    size_t count = 0;
+    if(a->type == roaring::ARRAY){
+      c->type = roaring::ARRAY;
+      if(b->type == roaring::ARRAY){
+        count = simd_intersect_vector16((uint16_t*)C,(const uint16_t*)A,(const uint16_t*)B,a->cardinality,b->cardinality);
+      } else if(b->type == roaring::BITMAP){
+        count = intersect_array_bitmap((uint16_t*)C,(const uint16_t*)A,a->cardinality,(const uint64_t*)B,b->first_word,b->length);
+      } else{
+        count = intersect_array_runs((uint16_t*)C,(const uint16_t*)A,a->cardinality,(const uint16_t*)B,b->length);
+      }
+    } else if(a->type == roaring::BITMAP){
+      c->type = roaring::BITMAP;
+      if(b->type == roaring::BITMAP){
+        const size_t first_word = std::max(a->first_word,b->first_word);
+        const size_t end_word = std::min(a->first_word+a->length,b->first_word+b->length);
+        if(first_word < end_word){
+          count = kernels.and_words((uint64_t*)C,(const uint64_t*)A+(first_word-a->first_word),
+            (const uint64_t*)B+(first_word-b->first_word),end_word-first_word);
+          c->first_word = first_word;
+          c->length = end_word-first_word;
+        }
+      } else{
+        count = intersect_bitmap_runs((uint64_t*)C,(const uint64_t*)A,a->first_word,a->length,(const uint16_t*)B,b->length);
+        c->first_word = a->first_word;
+        c->length = a->length;
+      }
+    } else{
+      c->type = roaring::RUNS;
+      size_t num_runs;
+      count = intersect_runs((uint16_t*)C,num_runs,(const uint16_t*)A,a->length,(const uint16_t*)B,b->length);
+      c->length = num_runs;
+    }
+    c->cardinality = count;
+    return count;
+  }
+
+  /*
+  Roaring results write their directory for capacity containers, the most
+  there can be, followed by the payloads. Once the number of non-empty
+  containers is known the payloads are moved down behind the directory.
+  */
+  inline Set<roaring>* finish_roaring(Set<roaring> *C_in, const size_t capacity,
+    const size_t num_containers, const size_t payload_bytes, const size_t count){
+    #if WRITE_VECTOR == 1
+    if(num_containers < capacity){
+      memmove(C_in->data+sizeof(uint32_t)+num_containers*sizeof(roaring::container),
+        C_in->data+sizeof(uint32_t)+capacity*sizeof(roaring::container),payload_bytes);
+    }
+    ((uint32_t*)C_in->data)[0] = num_containers;
+    #else
+    (void) capacity;
+    #endif
+
+    C_in->cardinality = count;
+    C_in->number_of_bytes = (num_containers > 0) ?
+      sizeof(uint32_t)+num_containers*sizeof(roaring::container)+payload_bytes : 0;
+    C_in->density = 0.0;
+    C_in->type = common::ROARING;
+    return C_in;
+  }
+
+  //Intersects the containers with equal keys.
+  inline Set<roaring>* set_intersect(Set<roaring> *C_in,const Set<roaring> *A_in,const Set<roaring> *B_in){
+    const size_t n_a = roaring::num_containers(A_in->data,A_in->number_of_bytes);
+    const size_t n_b = roaring::num_containers(B_in->data,B_in->number_of_bytes);
+    const roaring::container *A_dir = roaring::directory(A_in->data);
+    const roaring::container *B_dir = roaring::directory(B_in->data);
+    const uint8_t *A_payloads = roaring::payloads(A_in->data,n_a);
+    const uint8_t *B_payloads = roaring::payloads(B_in->data,n_b);
+
+    const size_t capacity = std::min(n_a,n_b);
+    roaring::container *C_dir = (roaring::container*)(C_in->data+sizeof(uint32_t));
+    uint8_t *C_payloads = C_in->data+sizeof(uint32_t)+capacity*sizeof(roaring::container);
+    #if WRITE_VECTOR == 0
+    (void) C_dir;
+    #endif
+
+    size_t count = 0;
+    size_t n_c = 0;
+    size_t offset = 0;
+    size_t i_a = 0, i_b = 0;
+    while(i_a < n_a && i_b < n_b){
+      if(A_dir[i_a].key < B_dir[i_b].key){
+        i_a++;
+      } else if(B_dir[i_b].key < A_dir[i_a].key){
+        i_b++;
+      } else{
+        roaring::container c;
+        const size_t matches = intersect_containers(C_payloads+offset,&c,
+          &A_dir[i_a],A_payloads+A_dir[i_a].offset,&B_dir[i_b],B_payloads+B_dir[i_b].offset);
+        if(matches > 0){
+          c.offset = offset;
+          #if WRITE_VECTOR == 1
+          C_dir[n_c] = c;
+          #endif
+          offset += roaring::payload_bytes(c);
+          count += matches;
+          n_c++;
+        }
+        i_a++;
+        i_b++;
+      }
     }
+    return finish_roaring(C_in,capacity,n_c,offset,count);
+  }
 
-    size_t A_num_blocks = A_in->number_of_bytes/(sizeof(uint32_t)+(BLOCK_SIZE/8));
-    size_t B_num_blocks = B_in->number_of_bytes/(sizeof(uint32_t)+(BLOCK_SIZE/8));
+  //Every container of A is intersected with the words of B in its chunk, seen as a bitmap container.
+  inline Set<roaring>* set_intersect(Set<roaring> *C_in,const Set<roaring> *A_in,const Set<bitset> *B_in){
+    const size_t n_a = roaring::num_containers(A_in->data,A_in->number_of_bytes);
+    const roaring::container *A_dir = roaring::directory(A_in->data);
+    const uint8_t *A_payloads = roaring::payloads(A_in->data,n_a);
 
-    size_t A_scratch_space = A_num_blocks*sizeof(uint64_t)*2;
-    //size_t B_scratch_space = B_num_blocks*sizeof(size_t);
-    //size_t scratch_space = A_scratch_space + B_scratch_space;
+    const size_t s_b = (B_in->number_of_bytes > 0) ? (B_in->number_of_bytes-sizeof(uint64_t))/sizeof(uint64_t):0;
+    const uint64_t start_index = (B_in->number_of_bytes > 0) ? ((uint64_t*)B_in->data)[0]:0;
+    const uint64_t * const B = (uint64_t*)(B_in->data+sizeof(uint64_t));
 
-    //need to move alloc outsize
-    uint32_t *A_offset_positions = (uint32_t*)(common::scratch_space[common::tid]);
-    uint32_t *B_offset_positions = (uint32_t*)(common::scratch_space[common::tid]+A_scratch_space);
-    //C_in->data += scratch_space;
+    const size_t capacity = n_a;
+    roaring::container *C_dir = (roaring::container*)(C_in->data+sizeof(uint32_t));
+    uint8_t *C_payloads = C_in->data+sizeof(uint32_t)+capacity*sizeof(roaring::container);
+    #if WRITE_VECTOR == 0
+    (void) C_dir;
+    #endif
 
-    uint64_t *A_data = (uint64_t*)(A_in->data+(A_num_blocks*sizeof(uint32_t)));
-    uint64_t *B_data = (uint64_t*)(B_in->data+(B_num_blocks*sizeof(uint32_t)));
+    size_t count = 0;
+    size_t n_c = 0;
+    size_t offset = 0;
+    for(size_t i_a = 0; i_a < n_a; i_a++){
+      const uint64_t chunk_word = ((uint64_t)A_dir[i_a].key)*roaring::WORDS_PER_CHUNK;
+      const uint64_t first_word = std::max(chunk_word,start_index);
+      const uint64_t end_word = std::min(chunk_word+roaring::WORDS_PER_CHUNK,start_index+s_b);
+      if(first_word >= end_word)
+        continue;
 
-    uint32_t *A_offset_pointer = (uint32_t*)A_in->data;
-    uint32_t *B_offset_pointer = (uint32_t*)B_in->data;
+      roaring::container b;
+      b.key = A_dir[i_a].key;
+      b.type = roaring::BITMAP;
+      b.cardinality = 0;
+      b.offset = 0;
+      b.first_word = first_word-chunk_word;
+      b.length = end_word-first_word;
+
+      roaring::container c;
+      const size_t matches = intersect_containers(C_payloads+offset,&c,
+        &A_dir[i_a],A_payloads+A_dir[i_a].offset,&b,(const uint8_t*)(B+(first_word-start_index)));
+      if(matches > 0){
+        c.offset = offset;
+        #if WRITE_VECTOR == 1
+        C_dir[n_c] = c;
+        #endif
+        offset += roaring::payload_bytes(c);
+        count += matches;
+        n_c++;
+      }
+    }
+    return finish_roaring(C_in,capacity,n_c,offset,count);
+  }
+  inline Set<roaring>* set_intersect(Set<roaring> *C_in,const Set<bitset> *A_in,const Set<roaring> *B_in){
+    return set_intersect(C_in,B_in,A_in);
+  }
 
-    size_t offset_count = simd_intersect_offsets((uint32_t *)C_in->data,
-      A_offset_positions,B_offset_positions,
-      A_offset_pointer,A_num_blocks,
-      B_offset_pointer,B_num_blocks,
-      A_data,B_data);
+  //The ids of A in the chunk of every container of B are intersected with it.
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<uinteger> *A_in,const Set<roaring> *B_in){
+    uint32_t * const C = (uint32_t*)C_in->data;
+    const uint32_t * const A = (uint32_t*)A_in->data;
+    const size_t s_a = A_in->cardinality;
+    const size_t n_b = roaring::num_containers(B_in->data,B_in->number_of_bytes);
+    const roaring::container *B_dir = roaring::directory(B_in->data);
+    const uint8_t *B_payloads = roaring::payloads(B_in->data,n_b);
+
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
 
-    uint64_t *result = (uint64_t*)(C_in->data + sizeof(uint32_t)*offset_count);
-    const size_t bytes_per_block = (BLOCK_SIZE/8);
-    const size_t words_per_block = bytes_per_block/sizeof(uint64_t);
     size_t count = 0;
-    for(size_t i = 0; i < offset_count; i++){
-      size_t A_offset = A_offset_positions[i] * words_per_block;
-      size_t B_offset = B_offset_positions[i] * words_per_block;
-      count += intersect_block(result+(i*words_per_block),A_data+A_offset,B_data+B_offset);
+    size_t a_i = 0;
+    for(size_t i_b = 0; i_b < n_b && a_i < s_a; i_b++){
+      const roaring::container &b = B_dir[i_b];
+      const uint32_t prefix = ((uint32_t)b.key) << 16;
+      a_i = std::lower_bound(A+a_i,A+s_a,prefix)-A;
+      const size_t a_end = (b.key == 0xFFFF) ? s_a : std::lower_bound(A+a_i,A+s_a,prefix+0x10000)-A;
+      const uint8_t *payload = B_payloads+b.offset;
+
+      if(b.type == roaring::ARRAY){
+        count += intersect_partition(&C[count],A,a_end,a_i,prefix,(const uint16_t*)payload,b.cardinality);
+      } else if(b.type == roaring::BITMAP){
+        const uint64_t *B64 = (const uint64_t*)payload;
+        for(; a_i < a_end; a_i++){
+          const size_t word = (A[a_i] & 0xFFFF) >> ADDRESS_BITS_PER_WORD;
+          if(word < b.first_word)
+            continue;
+          if(word >= (size_t)(b.first_word+b.length))
+            break;
+          if((B64[word-b.first_word] >> (A[a_i] % BITS_PER_WORD)) & 1){
+            #if WRITE_VECTOR == 1
+            C[count] = A[a_i];
+            #endif
+            count++;
+          }
+        }
+      } else{
+        const uint16_t *R = (const uint16_t*)payload;
+        size_t r = 0;
+        for(; a_i < a_end && r < b.length; a_i++){
+          const uint16_t low = A[a_i];
+          while(r < b.length && R[2*r+1] < low)
+            r++;
+          if(r < b.length && R[2*r] <= low){
+            #if WRITE_VECTOR == 1
+            C[count] = A[a_i];
+            #endif
+            count++;
+          }
+        }
+      }
+      a_i = a_end;
     }
 
     C_in->cardinality = count;
-    C_in->number_of_bytes = offset_count*(sizeof(uint32_t)+bytes_per_block);
+    C_in->number_of_bytes = count*sizeof(uint32_t);
     C_in->density = 0.0;
-    C_in->type= common::BITSET_NEW;
+    C_in->type= common::UINTEGER;
 
     return C_in;
   }
-  inline size_t hetero_intersect_offsets(
-    uint32_t *A_positions, 
-    uint32_t *B_position_data, 
-    uint32_t *A, 
-    size_t s_a,
-    uint32_t *B, 
-    size_t s_b,
-    uint64_t *B_data){
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<roaring> *A_in,const Set<uinteger> *B_in){
+    return set_intersect(C_in,B_in,A_in);
+  }
+  /*
+  Intersects the sorted ids of A with the runs of B. Blocks of four ids are
+  compared with the current run at once, a block is skipped while it lies
+  below the run and the run is advanced once the block passes its end.
+  */
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<uinteger> *A_in,const Set<runs> *B_in){
+    uint32_t * const C = (uint32_t*)C_in->data;
+    const uint32_t * const A = (uint32_t*)A_in->data;
+    const uint32_t * const R = (uint32_t*)B_in->data;
+    const size_t s_a = A_in->cardinality;
+    const size_t num_runs = B_in->number_of_bytes/(2*sizeof(uint32_t));
 
-    const size_t bytes_per_block = (BLOCK_SIZE/8);
-    const size_t words_per_block = bytes_per_block/sizeof(uint64_t);
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
 
     size_t count = 0;
     size_t i_a = 0;
-    size_t i_b = 0;
-    bool notFinished = i_a < s_a  && i_b < s_b;
-    while(notFinished){
-      while(notFinished && B[i_b] < (A[i_a] >> ADDRESS_BITS_PER_BLOCK)){
-        ++i_b;
-        notFinished = i_b < s_b;
-      }
-      if(notFinished && (A[i_a] >> ADDRESS_BITS_PER_BLOCK) == B[i_b]){
-        A_positions[count] = i_a;
-        B_position_data[count] = i_b;
-        _mm_prefetch(&B_data[i_b*words_per_block],_MM_HINT_T1);
-        ++count;
+    size_t r = 0;
+
+    #if VECTORIZE == 1
+    //The ids are compared as signed integers after flipping their top bit.
+    const __m128i sign = _mm_set1_epi32(0x80000000);
+    while((i_a+INTS_PER_REG) <= s_a && r < num_runs){
+      const uint32_t start = R[2*r];
+      const uint32_t last = start+R[2*r+1]-1;
+      const uint32_t a_max = A[i_a+INTS_PER_REG-1];
+      if(a_max < start){
+        i_a += INTS_PER_REG;
+        continue;
+      } else if(A[i_a] > last){
+        r++;
+        continue;
       }
-      ++i_a;
-      notFinished = notFinished && i_a < s_a;
-    }
-    return count;
-  }
-  inline size_t probe_block(
-    uint32_t *result,
-    uint32_t value,
-    uint64_t *block){
-    const uint32_t probe_value = value % BLOCK_SIZE;
-    const size_t word_to_check = probe_value / BITS_PER_WORD;
-    const size_t bit_to_check = probe_value % BITS_PER_WORD;
-    if((block[word_to_check] >> bit_to_check) % 2){
+
+      const __m128i v_a = _mm_loadu_si128((__m128i*)&A[i_a]);
+      const __m128i v_a_signed = _mm_xor_si128(v_a,sign);
+      const __m128i below = _mm_cmpgt_epi32(_mm_set1_epi32(start ^ 0x80000000),v_a_signed);
+      const __m128i above = _mm_cmpgt_epi32(v_a_signed,_mm_set1_epi32(last ^ 0x80000000));
+      const uint32_t mask = (~_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(below,above)))) & 0x0F;
+
       #if WRITE_VECTOR == 1
-      result[0] = value;
-      #else
-      (void) result;
+      _mm_storeu_si128((__m128i*)&C[count],_mm_shuffle_epi8(v_a,shuffle_mask32[mask]));
       #endif
-      return 1;
-    } 
-    return 0;
-  }
+      count += _mm_popcnt_u32(mask);
 
-  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<uinteger> *A_in,const Set<bitset_new> *B_in){
-    if(A_in->number_of_bytes == 0 || B_in->number_of_bytes == 0){
-      C_in->cardinality = 0;
-      C_in->number_of_bytes = 0;
-      C_in->density = 0.0;
-      C_in->type= common::UINTEGER;
-      return C_in;
+      if(a_max <= last)
+        i_a += INTS_PER_REG;
+      else
+        r++;
     }
+    #endif
 
-    size_t B_num_blocks = B_in->number_of_bytes/(sizeof(uint32_t)+(BLOCK_SIZE/8));
-    uint64_t *B_data = (uint64_t*)(B_in->data+(B_num_blocks*sizeof(uint32_t)));
-    uint32_t *B_offset_pointer = (uint32_t*)B_in->data;
-
-    uint32_t *A_data = (uint32_t*)A_in->data;
-
-    size_t A_scratch_space = A_in->cardinality*sizeof(uint32_t);
-    //size_t scratch_space = A_scratch_space + B_scratch_space;
-
-    //need to move alloc outsize
-    uint32_t *A_positions = (uint32_t*)common::scratch_space[common::tid];
-    uint32_t *B_offset_positions = (uint32_t*)(common::scratch_space[common::tid]+A_scratch_space);
-    //C_in->data += scratch_space;
-
-    size_t offset_count = hetero_intersect_offsets(
-      A_positions,B_offset_positions,A_data,
-      A_in->cardinality,B_offset_pointer,B_num_blocks,B_data);
-
-    size_t count = 0;
-    const size_t bytes_per_block = (BLOCK_SIZE/8);
-    const size_t words_per_block = bytes_per_block/sizeof(uint64_t);
-    uint32_t *result = (uint32_t*)C_in->data;
-    for(size_t i = 0; i < offset_count; i++){
-      const size_t B_offset = B_offset_positions[i] * words_per_block;
-      count += probe_block(result+count,A_data[A_positions[i]],B_data+B_offset);
+    while(i_a < s_a && r < num_runs){
+      const uint32_t start = R[2*r];
+      const uint32_t last = start+R[2*r+1]-1;
+      if(A[i_a] < start){
+        i_a++;
+      } else if(A[i_a] > last){
+        r++;
+      } else{
+        #if WRITE_VECTOR == 1
+        C[count] = A[i_a];
+        #endif
+        count++;
+        i_a++;
+      }
     }
-  
+
     C_in->cardinality = count;
     C_in->number_of_bytes = count*sizeof(uint32_t);
     C_in->density = 0.0;
@@ -1505,148 +1931,126 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
 
     return C_in;
   }
-  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<bitset_new> *A_in,const Set<uinteger> *B_in){
+  inline Set<uinteger>* set_intersect(Set<uinteger> *C_in,const Set<runs> *A_in,const Set<uinteger> *B_in){
     return set_intersect(C_in,B_in,A_in);
   }
 
-  inline void distinct_merge_three_way(
-    const size_t count,
-    uint32_t *result, 
-    const uint32_t *A, const size_t lenA, 
-    const uint32_t *B, const size_t lenB,
-    const uint32_t *C, const size_t lenC){
+  //The overlaps of the runs of A and B are the runs of the result.
+  inline Set<runs>* set_intersect(Set<runs> *C_in,const Set<runs> *A_in,const Set<runs> *B_in){
+    uint32_t * const C = (uint32_t*)C_in->data;
+    const uint32_t * const A = (uint32_t*)A_in->data;
+    const uint32_t * const B = (uint32_t*)B_in->data;
+    const size_t s_a = A_in->number_of_bytes/(2*sizeof(uint32_t));
+    const size_t s_b = B_in->number_of_bytes/(2*sizeof(uint32_t));
 
-    size_t i_a = 0;
-    size_t i_b = 0;
-    size_t i_c = 0;
-    for(size_t i=0; i < count; i++){
-      if(i_a < lenA && i_b < lenB && i_c < lenC){
-        if(A[i_a] <= B[i_b] && A[i_a] <= C[i_c]){
-          result[i] = A[i_a++];
-        } else if(B[i_b] <= A[i_a] && B[i_b] <= C[i_c]){
-          result[i] = B[i_b++];
-        } else{
-          result[i] = C[i_c++];
-        }
-      } else if(i_b < lenB && i_c < lenC){
-        if(B[i_b] <= C[i_c]){
-          result[i] = B[i_b++];
-        } else{
-          result[i] = C[i_c++];
-        }
-      } else if(i_a < lenA && i_c < lenC){
-        if(A[i_a] <= C[i_c]){
-          result[i] = A[i_a++];
-        } else{
-          result[i] = C[i_c++];
-        }
-      } else if(i_a < lenA && i_b < lenB){
-        if(A[i_a] <= B[i_b]){
-          result[i] = A[i_a++];
-        } else{
-          result[i] = B[i_b++];
-        }
-      } else if(i_a < lenA){
-        result[i] = A[i_a++];
-      } else if(i_b < lenB){
-        result[i] = B[i_b++];
-      } else{
-        result[i] = C[i_c++];
-      }
-    }
-  }
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
 
-  inline Set<new_type>* set_intersect(Set<new_type> *C_in,const Set<new_type> *A_in,const Set<new_type> *B_in){
-    if(A_in->number_of_bytes == 0 || B_in->number_of_bytes == 0){
-      C_in->cardinality = 0;
-      C_in->number_of_bytes = 0;
-      C_in->density = 0.0;
-      C_in->type= common::UINTEGER;
-      return C_in;
+    size_t count = 0;
+    size_t num_runs = 0;
+    size_t i_a = 0, i_b = 0;
+    while(i_a < s_a && i_b < s_b){
+      const uint32_t a_last = A[2*i_a]+A[2*i_a+1]-1;
+      const uint32_t b_last = B[2*i_b]+B[2*i_b+1]-1;
+      const uint32_t start = std::max(A[2*i_a],B[2*i_b]);
+      const uint32_t last = std::min(a_last,b_last);
+      if(start <= last){
+        #if WRITE_VECTOR == 1
+        C[2*num_runs] = start;
+        C[2*num_runs+1] = last-start+1;
+        #endif
+        num_runs++;
+        count += (last-start)+1;
+      }
+      if(a_last < b_last)
+        i_a++;
+      else
+        i_b++;
     }
 
-    const size_t A_num_uint_bytes = ((size_t*)A_in->data)[0];
-    uint8_t * A_uinteger_data = A_in->data+sizeof(size_t);
-    uint8_t * A_new_bs_data = A_in->data+sizeof(size_t)+A_num_uint_bytes;
-    const size_t A_num_bs_bytes = A_in->number_of_bytes-(sizeof(size_t)+A_num_uint_bytes);
-    const size_t A_uint_card = A_num_uint_bytes/sizeof(uint32_t);
-
-    const size_t B_num_uint_bytes = ((size_t*)B_in->data)[0];
-    uint8_t * B_uinteger_data = B_in->data+sizeof(size_t);
-    uint8_t * B_new_bs_data = B_in->data+sizeof(size_t)+B_num_uint_bytes;
-    const size_t B_num_bs_bytes = B_in->number_of_bytes-(sizeof(size_t)+B_num_uint_bytes);
-    const size_t B_uint_card = B_num_uint_bytes/sizeof(uint32_t);
-
-    //do all three uintegers then merge then intersect the bs
-    const size_t scratch1_space = A_num_uint_bytes;
-    uint8_t *scratch1 = common::scratch_space1[common::tid];
-    const size_t scratch2_space = A_num_uint_bytes;
-    uint8_t *scratch2 = scratch1+scratch1_space;    
-    uint8_t *scratch3 = scratch2+scratch2_space; 
-    //C_in->data += (scratch1_space+scratch2_space+scratch3_space);  
-
-    const Set<uinteger>A_I(A_uinteger_data,A_uint_card,A_num_uint_bytes,common::UINTEGER);
-    const Set<uinteger>B_I(B_uinteger_data,B_uint_card,B_num_uint_bytes,common::UINTEGER);
+    C_in->cardinality = count;
+    C_in->number_of_bytes = num_runs*2*sizeof(uint32_t);
+    C_in->density = 0.0;
+    C_in->type= common::RUNS;
 
-    const Set<bitset_new>A_BS(A_new_bs_data,A_in->cardinality-A_uint_card,A_num_bs_bytes,common::BITSET_NEW);
-    const Set<bitset_new>B_BS(B_new_bs_data,B_in->cardinality-B_uint_card,B_num_bs_bytes,common::BITSET_NEW);
+    return C_in;
+  }
 
+  /*
+  Keeps the bits of B inside the runs of A. The words a run covers completely
+  are copied with the bitset word kernel, only its first and last word are
+  masked.
+  */
+  inline Set<bitset>* set_intersect(Set<bitset> *C_in,const Set<runs> *A_in,const Set<bitset> *B_in){
     size_t count = 0;
-    
-    uint8_t *C_pointer = C_in->data+sizeof(size_t);
-    if( (A_I.number_of_bytes != 0 || B_I.number_of_bytes != 0) &&
-      (A_BS.number_of_bytes != 0 || B_BS.number_of_bytes != 0)){
-      
-      Set<uinteger>UU(scratch1);
-      Set<uinteger>UBS(scratch2);
-      Set<uinteger>BSU(scratch3);
+    C_in->number_of_bytes = 0;
 
-      UU = ops::set_intersect(&UU,&A_I,&B_I);
-      count += UU.cardinality;
+    if(A_in->number_of_bytes > 0 && B_in->number_of_bytes > 0){
+      const uint32_t * const R = (uint32_t*)A_in->data;
+      const size_t num_runs = A_in->number_of_bytes/(2*sizeof(uint32_t));
+      const uint64_t b_index = ((uint64_t*)B_in->data)[0];
+      const size_t s_b = ((B_in->number_of_bytes-sizeof(uint64_t))/sizeof(uint64_t));
 
-      UBS = ops::set_intersect(&UBS,&A_I,&B_BS);
-      count += UBS.cardinality;
+      uint64_t * const C = (uint64_t*)(C_in->data+sizeof(uint64_t));
+      const uint64_t * const B = (uint64_t*)(B_in->data+sizeof(uint64_t));
 
-      BSU = ops::set_intersect(&BSU,&B_I,&A_BS);
-      count += BSU.cardinality;
+      const uint64_t last_id = (uint64_t)R[2*(num_runs-1)]+R[2*(num_runs-1)+1]-1;
+      const uint64_t start_index = std::max(b_index,(uint64_t)bitset::word_index(R[0]));
+      const uint64_t end_index = std::min(b_index+s_b,(uint64_t)bitset::word_index(last_id)+1);
+      const uint64_t total_size = (start_index > end_index) ? 0:(end_index-start_index);
 
       #if WRITE_VECTOR == 1
-      distinct_merge_three_way(
-        count,
-        (uint32_t*)(C_pointer),
-        (uint32_t*)UU.data,UU.cardinality, 
-        (uint32_t*)UBS.data,UBS.cardinality,
-        (uint32_t*)BSU.data,BSU.cardinality);
+      uint64_t *c_index = (uint64_t*) C_in->data;
+      c_index[0] = start_index;
+      memset(C,(uint8_t)0,total_size*sizeof(uint64_t));
       #endif
-    } else if(A_BS.number_of_bytes == 0 && B_BS.number_of_bytes == 0){
-      Set<uinteger>UU(C_pointer);
-      UU = ops::set_intersect(&UU,&A_I,&B_I);
-      count += UU.cardinality;
 
-      ((size_t*)C_in->data)[0] = (count*sizeof(uint32_t));
-      C_in->cardinality = count;
-      C_in->number_of_bytes = sizeof(size_t)+(count*sizeof(uint32_t));
-      C_in->density = 0.0;
-      C_in->type= common::NEW_TYPE;
-
-      return C_in;
+      const uint64_t first_bit = start_index*BITS_PER_WORD;
+      const uint64_t end_bit = end_index*BITS_PER_WORD;
+      for(size_t r = 0; r < num_runs && total_size > 0; r++){
+        const uint64_t first = std::max((uint64_t)R[2*r],first_bit);
+        const uint64_t last = std::min((uint64_t)R[2*r]+R[2*r+1]-1,end_bit-1);
+        if(first >= end_bit)
+          break;
+        if(first > last)
+          continue;
+
+        const uint64_t first_word = first >> ADDRESS_BITS_PER_WORD;
+        const uint64_t last_word = last >> ADDRESS_BITS_PER_WORD;
+        const uint64_t head_mask = (~(uint64_t)0) << (first % BITS_PER_WORD);
+        const uint64_t tail_mask = (~(uint64_t)0) >> (BITS_PER_WORD-1-(last % BITS_PER_WORD));
+
+        if(first_word == last_word){
+          const uint64_t result = B[first_word-b_index] & head_mask & tail_mask;
+          #if WRITE_VECTOR == 1
+          C[first_word-start_index] |= result;
+          #endif
+          count += _mm_popcnt_u64(result);
+        } else{
+          const uint64_t head = B[first_word-b_index] & head_mask;
+          const uint64_t tail = B[last_word-b_index] & tail_mask;
+          #if WRITE_VECTOR == 1
+          C[first_word-start_index] |= head;
+          C[last_word-start_index] |= tail;
+          #endif
+          count += _mm_popcnt_u64(head) + _mm_popcnt_u64(tail);
+          count += kernels.and_words(C+(first_word+1-start_index),B+(first_word+1-b_index),
+            B+(first_word+1-b_index),last_word-first_word-1);
+        }
+      }
+      C_in->number_of_bytes = total_size*sizeof(uint64_t)+sizeof(uint64_t);
     }
-    
-    const size_t num_uint = count;
-    ((size_t*)C_in->data)[0] = (num_uint*sizeof(uint32_t));
-    C_pointer += (num_uint*sizeof(uint32_t));
-
-    Set<bitset_new>BSBS(C_pointer);
-    BSBS = ops::set_intersect(&BSBS,&A_BS,&B_BS);
-    count += BSBS.cardinality;
 
     C_in->cardinality = count;
-    C_in->number_of_bytes = sizeof(size_t)+(num_uint*sizeof(uint32_t))+BSBS.number_of_bytes;
     C_in->density = 0.0;
-    C_in->type= common::NEW_TYPE;
+    C_in->type= common::BITSET;
 
     return C_in;
   }
+  inline Set<bitset>* set_intersect(Set<bitset> *C_in,const Set<bitset> *A_in,const Set<runs> *B_in){
+    return set_intersect(C_in,B_in,A_in);
+  }
 /*
   inline Set<kunle>* set_intersect(
       Set<kunle> *C_in,
@@ -2086,6 +2490,9 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
               #endif
               return (Set<hybrid>*)set_intersect((Set<uinteger>*)C_in,(const Set<uinteger>*)A_in,(const Set<bitset>*)B_in);
               break;
+            case common::RUNS:
+              return (Set<hybrid>*)set_intersect((Set<uinteger>*)C_in,(const Set<uinteger>*)A_in,(const Set<runs>*)B_in);
+              break;
             default:
               break;
           }
@@ -2104,6 +2511,24 @@ inline Set<bitset>* set_intersect(Set<bitset> *C_in, const Set<bitset> *A_in, co
               #endif
               return (Set<hybrid>*)set_intersect((Set<bitset>*)C_in,(const Set<bitset>*)A_in,(const Set<bitset>*)B_in);
             break;
+            case common::RUNS:
+              return (Set<hybrid>*)set_intersect((Set<bitset>*)C_in,(const Set<runs>*)B_in,(const Set<bitset>*)A_in);
+            break;
+            default:
+            break;
+          }
+        break;
+        case common::RUNS:
+          switch (B_in->type) {
+            case common::UINTEGER:
+              return (Set<hybrid>*)set_intersect((Set<uinteger>*)C_in,(const Set<uinteger>*)B_in,(const Set<runs>*)A_in);
+            break;
+            case common::BITSET:
+              return (Set<hybrid>*)set_intersect((Set<bitset>*)C_in,(const Set<runs>*)A_in,(const Set<bitset>*)B_in);
+            break;
+            case common::RUNS:
+              return (Set<hybrid>*)set_intersect((Set<runs>*)C_in,(const Set<runs>*)A_in,(const Set<runs>*)B_in);
+            break;
             default:
             break;
           }
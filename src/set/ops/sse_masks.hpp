@@ -112,6 +112,25 @@ namespace ops{
   }; 
   static __m128i shuffle_mask16[256]; // precomputed dictionary
 
+  //Lane indices for _mm256_permutevar8x32_epi32 that move the 32-bit elements
+  //selected by an 8-bit mask to the front. Built at static initialization.
+  struct permutation_dictionary32{
+    uint32_t masks[256][8] __attribute__((aligned(32)));
+
+    permutation_dictionary32(){
+      for(uint32_t i = 0; i < 256; i++) {
+        uint32_t counter = 0;
+        for(uint32_t b = 0; b < 8; b++) {
+          if(i & (1 << b))
+            masks[i][counter++] = b;
+        }
+        while(counter < 8)
+          masks[i][counter++] = 0;
+      }
+    }
+  };
+  static const permutation_dictionary32 permutation_mask32;
+
   static inline int getBitSD(uint32_t value, uint32_t position) {
     return ( ( value & (1 << position) ) >> position);
   }
@@ -31,13 +31,8 @@ namespace ops{
       A += a_start_index;
       B += b_start_index;
       #if VECTORIZE == 1
-      for(; (i+3) < total_size; i += 4, A += 4, B += 4){
-        const __m256 a1 = _mm256_loadu_ps((const float*)A);
-        const __m256 a2 = _mm256_loadu_ps((const float*)B);
-        const __m256 r = _mm256_or_ps(a2, a1);
-
-        _mm256_storeu_ps((float*)A, r);
-      }
+      kernels.or_words(A,B,total_size);
+      i = total_size;
       #endif
 
       for(; i < total_size; i++, A++, B++){
@@ -100,6 +95,33 @@ namespace ops{
     return set_union(B_in,A_in);
   }
 
+  // Sets the bits of every run, whole words at a time.
+  inline void set_union(Set<bitset> *A_in,Set<runs> *B_in){
+    uint64_t* A = (uint64_t*)(A_in->data+sizeof(uint64_t));
+    const uint64_t start_index = 0;//(A_in->number_of_bytes > 0) ? ((uint64_t*)A_in->data)[0]:0;
+
+    const uint32_t *R = (uint32_t*)B_in->data;
+    const size_t num_runs = B_in->number_of_bytes/(2*sizeof(uint32_t));
+    for(size_t r = 0; r < num_runs; r++){
+      const uint64_t first = R[2*r];
+      const uint64_t last = first+R[2*r+1]-1;
+      const size_t first_word = bitset::word_index(first);
+      const size_t last_word = bitset::word_index(last);
+      const uint64_t head_mask = (~(uint64_t)0) << (first % BITS_PER_WORD);
+      const uint64_t tail_mask = (~(uint64_t)0) >> (BITS_PER_WORD-1-(last % BITS_PER_WORD));
+      if(first_word == last_word){
+        A[first_word-start_index] |= (head_mask & tail_mask);
+      } else{
+        A[first_word-start_index] |= head_mask;
+        memset(&A[first_word+1-start_index],(uint8_t)0xFF,(last_word-first_word-1)*sizeof(uint64_t));
+        A[last_word-start_index] |= tail_mask;
+      }
+    }
+  }
+  inline void set_union(Set<runs> *A_in,Set<bitset> *B_in){
+    set_union(B_in,A_in);
+  }
+
   // Dynamically dispatches the union of a bitset and hybrid set.
   inline void set_union(Set<bitset> *A_in,Set<hybrid> *B_in){
     switch(B_in->type){
@@ -118,6 +140,9 @@ namespace ops{
       case common::BITPACKED:
         set_union(A_in,(Set<bitpacked>*)B_in);
         break;
+      case common::RUNS:
+        set_union(A_in,(Set<runs>*)B_in);
+        break;
       case common::HYBRID:
         // There should never be a set where type is HYBRID.
         assert(false);
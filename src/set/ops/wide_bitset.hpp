@@ -0,0 +1,154 @@
+#ifndef _WIDE_BITSET_H_
+#define _WIDE_BITSET_H_
+
+/*
+Word loops of the bitset intersection, union and difference in 128-bit
+(SSE), 256-bit (AVX2) and 512-bit (AVX-512) versions. Each works on n
+64-bit words and finishes the words that do not fill a register itself:
+
+  and_words:    C = A & B, returns the number of set bits (C is only
+                written with WRITE_VECTOR)
+  or_words:     A |= B
+  andnot_words: C = A & ~B
+
+Like wide_intersection.hpp the wider versions are compiled for their own
+target and picked by dispatch.hpp.
+*/
+namespace ops{
+  inline size_t sse_and_words(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    size_t i = 0;
+    uint64_t tmp[2];
+    for(; (i+1) < n; i += 2){
+      const __m128i r = _mm_and_si128(_mm_loadu_si128((const __m128i*)&A[i]),_mm_loadu_si128((const __m128i*)&B[i]));
+      #if WRITE_VECTOR == 1
+      _mm_storeu_si128((__m128i*)&C[i],r);
+      #endif
+      _mm_storeu_si128((__m128i*)tmp,r);
+      count += _mm_popcnt_u64(tmp[0]);
+      count += _mm_popcnt_u64(tmp[1]);
+    }
+    for(; i < n; i++){
+      const uint64_t r = A[i] & B[i];
+      #if WRITE_VECTOR == 1
+      C[i] = r;
+      #endif
+      count += _mm_popcnt_u64(r);
+    }
+    return count;
+  }
+
+  inline void sse_or_words(uint64_t *A, const uint64_t *B, const size_t n){
+    size_t i = 0;
+    for(; (i+1) < n; i += 2){
+      const __m128i r = _mm_or_si128(_mm_loadu_si128((const __m128i*)&A[i]),_mm_loadu_si128((const __m128i*)&B[i]));
+      _mm_storeu_si128((__m128i*)&A[i],r);
+    }
+    for(; i < n; i++){
+      A[i] |= B[i];
+    }
+  }
+
+  inline void sse_andnot_words(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n){
+    size_t i = 0;
+    for(; (i+1) < n; i += 2){
+      const __m128i r = _mm_andnot_si128(_mm_loadu_si128((const __m128i*)&B[i]),_mm_loadu_si128((const __m128i*)&A[i]));
+      _mm_storeu_si128((__m128i*)&C[i],r);
+    }
+    for(; i < n; i++){
+      C[i] = A[i] & ~B[i];
+    }
+  }
+
+  #pragma GCC push_options
+  #pragma GCC target("avx2")
+  inline size_t avx2_and_words(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    size_t i = 0;
+    uint64_t tmp[4];
+    for(; (i+3) < n; i += 4){
+      const __m256i r = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)&A[i]),_mm256_loadu_si256((const __m256i*)&B[i]));
+      #if WRITE_VECTOR == 1
+      _mm256_storeu_si256((__m256i*)&C[i],r);
+      #endif
+      _mm256_storeu_si256((__m256i*)tmp,r);
+      count += _mm_popcnt_u64(tmp[0]);
+      count += _mm_popcnt_u64(tmp[1]);
+      count += _mm_popcnt_u64(tmp[2]);
+      count += _mm_popcnt_u64(tmp[3]);
+    }
+    return count + sse_and_words(C+i,A+i,B+i,n-i);
+  }
+
+  inline void avx2_or_words(uint64_t *A, const uint64_t *B, const size_t n){
+    size_t i = 0;
+    for(; (i+3) < n; i += 4){
+      const __m256i r = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)&A[i]),_mm256_loadu_si256((const __m256i*)&B[i]));
+      _mm256_storeu_si256((__m256i*)&A[i],r);
+    }
+    sse_or_words(A+i,B+i,n-i);
+  }
+
+  inline void avx2_andnot_words(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n){
+    size_t i = 0;
+    for(; (i+3) < n; i += 4){
+      const __m256i r = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i*)&B[i]),_mm256_loadu_si256((const __m256i*)&A[i]));
+      _mm256_storeu_si256((__m256i*)&C[i],r);
+    }
+    sse_andnot_words(C+i,A+i,B+i,n-i);
+  }
+  #pragma GCC pop_options
+
+  #pragma GCC push_options
+  #pragma GCC target("avx512f")
+  //Same GCC 12 false positive on the _mm512 intrinsics as in wide_intersection.hpp.
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+  inline size_t avx512_and_words(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    size_t i = 0;
+    uint64_t tmp[8];
+    for(; (i+7) < n; i += 8){
+      const __m512i r = _mm512_and_si512(_mm512_loadu_si512((const void*)&A[i]),_mm512_loadu_si512((const void*)&B[i]));
+      #if WRITE_VECTOR == 1
+      _mm512_storeu_si512((void*)&C[i],r);
+      #endif
+      _mm512_storeu_si512((void*)tmp,r);
+      for(size_t j = 0; j < 8; j++){
+        count += _mm_popcnt_u64(tmp[j]);
+      }
+    }
+    return count + avx2_and_words(C+i,A+i,B+i,n-i);
+  }
+
+  inline void avx512_or_words(uint64_t *A, const uint64_t *B, const size_t n){
+    size_t i = 0;
+    for(; (i+7) < n; i += 8){
+      const __m512i r = _mm512_or_si512(_mm512_loadu_si512((const void*)&A[i]),_mm512_loadu_si512((const void*)&B[i]));
+      _mm512_storeu_si512((void*)&A[i],r);
+    }
+    avx2_or_words(A+i,B+i,n-i);
+  }
+
+  inline void avx512_andnot_words(uint64_t *C, const uint64_t *A, const uint64_t *B, const size_t n){
+    size_t i = 0;
+    for(; (i+7) < n; i += 8){
+      const __m512i r = _mm512_andnot_si512(_mm512_loadu_si512((const void*)&B[i]),_mm512_loadu_si512((const void*)&A[i]));
+      _mm512_storeu_si512((void*)&C[i],r);
+    }
+    avx2_andnot_words(C+i,A+i,B+i,n-i);
+  }
+  #pragma GCC diagnostic pop
+  #pragma GCC pop_options
+}
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef _WIDE_INTERSECTION_H_
+#define _WIDE_INTERSECTION_H_
+
+/*
+256-bit (AVX2) and 512-bit (AVX-512) block loops of the uinteger and pshort
+intersections. Each compares a block of A against a block of B in all
+rotations, writes the common elements of the A block and advances the block
+with the smaller maximum, exactly like the 128-bit loops in intersection.hpp.
+They start at i_a and i_b, stop when either side has less than a block left
+and return the number of common elements found; the caller finishes the
+remainder with its 128-bit loop and scalar tail.
+
+The build only assumes SSE4.2. Every section below is compiled for its own
+target, so the instructions are only executed if dispatch.hpp selected the
+section for the CPU at startup.
+*/
+namespace ops{
+  #pragma GCC push_options
+  #pragma GCC target("avx2")
+  //Bit i is set if 32-bit element i of a occurs in b.
+  inline uint32_t avx2_match_mask32(const __m256i v_a, const __m256i v_b){
+    const __m256i v_s = _mm256_permute2x128_si256(v_b,v_b,1);
+    __m256i cmp = _mm256_or_si256(_mm256_cmpeq_epi32(v_a,v_b),_mm256_cmpeq_epi32(v_a,v_s));
+    cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi32(v_a,_mm256_shuffle_epi32(v_b,_MM_SHUFFLE(0,3,2,1))));
+    cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi32(v_a,_mm256_shuffle_epi32(v_s,_MM_SHUFFLE(0,3,2,1))));
+    cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi32(v_a,_mm256_shuffle_epi32(v_b,_MM_SHUFFLE(1,0,3,2))));
+    cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi32(v_a,_mm256_shuffle_epi32(v_s,_MM_SHUFFLE(1,0,3,2))));
+    cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi32(v_a,_mm256_shuffle_epi32(v_b,_MM_SHUFFLE(2,1,0,3))));
+    cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi32(v_a,_mm256_shuffle_epi32(v_s,_MM_SHUFFLE(2,1,0,3))));
+    return _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+  }
+
+  //Bit i is set if 16-bit element i of a occurs in b.
+  inline uint32_t avx2_match_mask16(const __m256i v_a, const __m256i v_b){
+    const __m256i v_s = _mm256_permute2x128_si256(v_b,v_b,1);
+    __m256i cmp = _mm256_or_si256(_mm256_cmpeq_epi16(v_a,v_b),_mm256_cmpeq_epi16(v_a,v_s));
+    #define AVX2_MATCH_ROTATION16(bytes) \
+      cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi16(v_a,_mm256_alignr_epi8(v_b,v_b,bytes))); \
+      cmp = _mm256_or_si256(cmp,_mm256_cmpeq_epi16(v_a,_mm256_alignr_epi8(v_s,v_s,bytes)));
+    AVX2_MATCH_ROTATION16(2)
+    AVX2_MATCH_ROTATION16(4)
+    AVX2_MATCH_ROTATION16(6)
+    AVX2_MATCH_ROTATION16(8)
+    AVX2_MATCH_ROTATION16(10)
+    AVX2_MATCH_ROTATION16(12)
+    AVX2_MATCH_ROTATION16(14)
+    #undef AVX2_MATCH_ROTATION16
+    //Saturating to bytes keeps one byte per element: 0-7 in the low lane, 8-15 in the high one.
+    const uint32_t bytes = _mm256_movemask_epi8(_mm256_packs_epi16(cmp,_mm256_setzero_si256()));
+    return (bytes & 0xFF) | ((bytes >> 8) & 0xFF00);
+  }
+
+  //Writes the 32-bit elements of v selected by the 8-bit mask to C.
+  inline void avx2_store_matches32(uint32_t *C, const __m256i v, const uint32_t mask){
+    const __m256i permutation = _mm256_load_si256((const __m256i*)permutation_mask32.masks[mask]);
+    _mm256_storeu_si256((__m256i*)C,_mm256_permutevar8x32_epi32(v,permutation));
+  }
+
+  inline size_t avx2_intersect_vector32(uint32_t *C, const uint32_t *A, const uint32_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    while(i_a + 8 <= s_a && i_b + 8 <= s_b) {
+      const __m256i v_a = _mm256_loadu_si256((__m256i*)&A[i_a]);
+      const __m256i v_b = _mm256_loadu_si256((__m256i*)&B[i_b]);
+      const uint32_t a_max = A[i_a+7];
+      const uint32_t b_max = B[i_b+7];
+
+      const uint32_t mask = avx2_match_mask32(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      avx2_store_matches32(&C[count],v_a,mask);
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 8;
+      i_b += (a_max >= b_max) * 8;
+    }
+    return count;
+  }
+
+  inline size_t avx2_intersect_vector16(uint16_t *C, const uint16_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    while(i_a + 16 <= s_a && i_b + 16 <= s_b) {
+      const __m256i v_a = _mm256_loadu_si256((__m256i*)&A[i_a]);
+      const __m256i v_b = _mm256_loadu_si256((__m256i*)&B[i_b]);
+      const uint16_t a_max = A[i_a+15];
+      const uint16_t b_max = B[i_b+15];
+
+      const uint32_t mask = avx2_match_mask16(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      const uint32_t mask_lower = mask & 0xFF;
+      _mm_storeu_si128((__m128i*)&C[count],
+        _mm_shuffle_epi8(_mm256_castsi256_si128(v_a),shuffle_mask16[mask_lower]));
+      _mm_storeu_si128((__m128i*)&C[count+_mm_popcnt_u32(mask_lower)],
+        _mm_shuffle_epi8(_mm256_extracti128_si256(v_a,1),shuffle_mask16[mask >> 8]));
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 16;
+      i_b += (a_max >= b_max) * 16;
+    }
+    return count;
+  }
+
+  /*
+  A is uinteger, B the i_b-th element onwards of the pshort partition of A's
+  current prefix. Runs while the next 16 elements of A share that prefix.
+  */
+  inline size_t avx2_intersect_partition(uint32_t *C, const uint32_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, const uint32_t prefix, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    const __m256i low_bits = _mm256_set1_epi32(0xFFFF);
+    size_t count = 0;
+    while(i_a + 16 <= s_a && (A[i_a+15] & 0xFFFF0000) == prefix && i_b + 16 <= s_b) {
+      const __m256i v_a_1_32 = _mm256_loadu_si256((__m256i*)&A[i_a]);
+      const __m256i v_a_2_32 = _mm256_loadu_si256((__m256i*)&A[i_a+8]);
+      //Packing interleaves the lanes, the permute restores the order of A.
+      const __m256i v_a = _mm256_permute4x64_epi64(
+        _mm256_packus_epi32(_mm256_and_si256(v_a_1_32,low_bits),_mm256_and_si256(v_a_2_32,low_bits)),
+        _MM_SHUFFLE(3,1,2,0));
+      const __m256i v_b = _mm256_loadu_si256((__m256i*)&B[i_b]);
+      const uint16_t a_max = A[i_a+15];
+      const uint16_t b_max = B[i_b+15];
+
+      const uint32_t mask = avx2_match_mask16(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      const uint32_t mask_lower = mask & 0xFF;
+      avx2_store_matches32(&C[count],v_a_1_32,mask_lower);
+      avx2_store_matches32(&C[count+_mm_popcnt_u32(mask_lower)],v_a_2_32,mask >> 8);
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 16;
+      i_b += (a_max >= b_max) * 16;
+    }
+    return count;
+  }
+  #pragma GCC pop_options
+
+  #pragma GCC push_options
+  #pragma GCC target("avx512f,avx512bw")
+  //GCC 12 mistakes the undefined upper halves in its AVX-512 headers for uninitialized variables.
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+  inline __mmask16 avx512_match_mask32(const __m512i v_a, const __m512i v_b){
+    __mmask16 mask = _mm512_cmpeq_epi32_mask(v_a,v_b);
+    #define AVX512_MATCH_ROTATION32(k) \
+      mask |= _mm512_cmpeq_epi32_mask(v_a,_mm512_alignr_epi32(v_b,v_b,k));
+    AVX512_MATCH_ROTATION32(1)  AVX512_MATCH_ROTATION32(2)  AVX512_MATCH_ROTATION32(3)
+    AVX512_MATCH_ROTATION32(4)  AVX512_MATCH_ROTATION32(5)  AVX512_MATCH_ROTATION32(6)
+    AVX512_MATCH_ROTATION32(7)  AVX512_MATCH_ROTATION32(8)  AVX512_MATCH_ROTATION32(9)
+    AVX512_MATCH_ROTATION32(10) AVX512_MATCH_ROTATION32(11) AVX512_MATCH_ROTATION32(12)
+    AVX512_MATCH_ROTATION32(13) AVX512_MATCH_ROTATION32(14) AVX512_MATCH_ROTATION32(15)
+    #undef AVX512_MATCH_ROTATION32
+    return mask;
+  }
+
+  //B is rotated by whole 128-bit lanes and, inside the lanes, by 16-bit elements.
+  inline __mmask32 avx512_match_mask16(const __m512i v_a, const __m512i v_b){
+    const __m512i v_l[4] = {
+      v_b,
+      _mm512_shuffle_i32x4(v_b,v_b,_MM_SHUFFLE(0,3,2,1)),
+      _mm512_shuffle_i32x4(v_b,v_b,_MM_SHUFFLE(1,0,3,2)),
+      _mm512_shuffle_i32x4(v_b,v_b,_MM_SHUFFLE(2,1,0,3))
+    };
+    __mmask32 mask = 0;
+    for(size_t l = 0; l < 4; l++){
+      mask |= _mm512_cmpeq_epi16_mask(v_a,v_l[l]);
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],2));
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],4));
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],6));
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],8));
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],10));
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],12));
+      mask |= _mm512_cmpeq_epi16_mask(v_a,_mm512_alignr_epi8(v_l[l],v_l[l],14));
+    }
+    return mask;
+  }
+
+  //Compresses in a register and stores only the selected elements.
+  inline void avx512_store_matches32(uint32_t *C, const __m512i v, const __mmask16 mask){
+    const __mmask16 written = (__mmask16)((1u << _mm_popcnt_u32(mask)) - 1);
+    _mm512_mask_storeu_epi32(C,written,_mm512_maskz_compress_epi32(mask,v));
+  }
+
+  //There is no 16-bit compress without VBMI2, every 128-bit lane is shuffled like in SSE.
+  inline void avx512_store_matches16(uint16_t *C, const __m512i v, const __mmask32 mask){
+    #define AVX512_STORE_LANE16(lane) { \
+      const uint32_t lane_mask = (mask >> (8*lane)) & 0xFF; \
+      _mm_storeu_si128((__m128i*)C,_mm_shuffle_epi8(_mm512_extracti32x4_epi32(v,lane),shuffle_mask16[lane_mask])); \
+      C += _mm_popcnt_u32(lane_mask); }
+    AVX512_STORE_LANE16(0)
+    AVX512_STORE_LANE16(1)
+    AVX512_STORE_LANE16(2)
+    AVX512_STORE_LANE16(3)
+    #undef AVX512_STORE_LANE16
+  }
+
+  inline size_t avx512_intersect_vector32(uint32_t *C, const uint32_t *A, const uint32_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    while(i_a + 16 <= s_a && i_b + 16 <= s_b) {
+      const __m512i v_a = _mm512_loadu_si512((const void*)&A[i_a]);
+      const __m512i v_b = _mm512_loadu_si512((const void*)&B[i_b]);
+      const uint32_t a_max = A[i_a+15];
+      const uint32_t b_max = B[i_b+15];
+
+      const __mmask16 mask = avx512_match_mask32(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      avx512_store_matches32(&C[count],v_a,mask);
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 16;
+      i_b += (a_max >= b_max) * 16;
+    }
+    return count;
+  }
+
+  inline size_t avx512_intersect_vector16(uint16_t *C, const uint16_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    while(i_a + 32 <= s_a && i_b + 32 <= s_b) {
+      const __m512i v_a = _mm512_loadu_si512((const void*)&A[i_a]);
+      const __m512i v_b = _mm512_loadu_si512((const void*)&B[i_b]);
+      const uint16_t a_max = A[i_a+31];
+      const uint16_t b_max = B[i_b+31];
+
+      const __mmask32 mask = avx512_match_mask16(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      avx512_store_matches16(&C[count],v_a,mask);
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 32;
+      i_b += (a_max >= b_max) * 32;
+    }
+    return count;
+  }
+
+  /*
+  Like avx2_intersect_partition with blocks of 32: the low halves of 32
+  elements of A are narrowed to 16 bits and compared to 32 elements of B.
+  */
+  inline size_t avx512_intersect_partition(uint32_t *C, const uint32_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, const uint32_t prefix, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    while(i_a + 32 <= s_a && (A[i_a+31] & 0xFFFF0000) == prefix && i_b + 32 <= s_b) {
+      const __m512i v_a_1_32 = _mm512_loadu_si512((const void*)&A[i_a]);
+      const __m512i v_a_2_32 = _mm512_loadu_si512((const void*)&A[i_a+16]);
+      const __m512i v_a = _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvtepi32_epi16(v_a_1_32)),
+        _mm512_cvtepi32_epi16(v_a_2_32),1);
+      const __m512i v_b = _mm512_loadu_si512((const void*)&B[i_b]);
+      const uint16_t a_max = A[i_a+31];
+      const uint16_t b_max = B[i_b+31];
+
+      const __mmask32 mask = avx512_match_mask16(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      const __mmask16 mask_lower = (__mmask16)(mask & 0xFFFF);
+      avx512_store_matches32(&C[count],v_a_1_32,mask_lower);
+      avx512_store_matches32(&C[count+_mm_popcnt_u32(mask_lower)],v_a_2_32,(__mmask16)(mask >> 16));
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 32;
+      i_b += (a_max >= b_max) * 32;
+    }
+    return count;
+  }
+  #pragma GCC pop_options
+
+  //The 16-bit loop once more for CPUs that can compress 16-bit elements.
+  #pragma GCC push_options
+  #pragma GCC target("avx512f,avx512bw,avx512vbmi2")
+  inline size_t avx512vbmi2_intersect_vector16(uint16_t *C, const uint16_t *A, const uint16_t *B,
+    const size_t s_a, const size_t s_b, size_t &i_a, size_t &i_b){
+    #if WRITE_VECTOR == 0
+    (void) C;
+    #endif
+    size_t count = 0;
+    while(i_a + 32 <= s_a && i_b + 32 <= s_b) {
+      const __m512i v_a = _mm512_loadu_si512((const void*)&A[i_a]);
+      const __m512i v_b = _mm512_loadu_si512((const void*)&B[i_b]);
+      const uint16_t a_max = A[i_a+31];
+      const uint16_t b_max = B[i_b+31];
+
+      const __mmask32 mask = avx512_match_mask16(v_a,v_b);
+      #if WRITE_VECTOR == 1
+      const __mmask32 written = (__mmask32)((1ull << _mm_popcnt_u32(mask)) - 1);
+      _mm512_mask_storeu_epi16(&C[count],written,_mm512_maskz_compress_epi16(mask,v_a));
+      #endif
+      count += _mm_popcnt_u32(mask);
+
+      i_a += (a_max <= b_max) * 32;
+      i_b += (a_max >= b_max) * 32;
+    }
+    return count;
+  }
+  #pragma GCC pop_options
+  #pragma GCC diagnostic pop
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef _SLAB_ALLOCATOR_HPP_
+#define _SLAB_ALLOCATOR_HPP_
+
+/*
+CHUNK ALLOCATOR FOR THE BUFFERS OF MATRIX CONSTRUCTION: ROW ARENAS, THE PER
+THREAD SIZING AND SELECTION BUFFERS AND THE SCRATCH SPACE. RELEASED CHUNKS ARE
+KEPT IN A CACHE AND A REQUEST TAKES THE SMALLEST CACHED CHUNK THAT FITS IT
+WITH LESS THAN 1/MAX_SLACK_FRACTION TO SPARE, SO THE TWO PASSES OF A BUILD
+AND REPEATED BUILDS REUSE THE SAME MEMORY INSTEAD OF GROWING THE HEAP. THE
+CACHE HOLDS AT MOST max_cached_bytes AND IS TRIMMED TO max_idle_bytes WHEN A
+BUILD ENDS. EVERY CHUNK IS ACCOUNTED FOR: BYTES IN USE, THEIR PEAK AND THE
+BYTES SITTING IN THE CACHE.
+*/
+
+#include <map>
+#include <iterator>
+#include <mutex>
+
+namespace slab {
+  static const size_t HUGE_PAGE_SIZE = 2*1024*1024;
+  static const size_t MIN_CHUNK_SIZE = 4096;
+  static const size_t CACHE_LINE_SIZE = 64;
+  static const size_t MAX_SLACK_FRACTION = 8;
+
+  //Released chunks beyond this many bytes go back to the system.
+  static size_t max_cached_bytes = (size_t)256 << 20;
+  //Cached bytes kept for the next build when a build ends.
+  static size_t max_idle_bytes = (size_t)64 << 20;
+
+  static std::mutex lock;
+  static std::unordered_map<void*,size_t> live_chunks;
+  static std::multimap<size_t,void*> cached_chunks;
+
+  static size_t bytes_in_use = 0;
+  static size_t peak_bytes_in_use = 0;
+  static size_t bytes_cached = 0;
+  static size_t num_allocated = 0;
+  static size_t num_reused = 0;
+
+  //Chunks are rounded to cache lines below a page, to pages below a huge
+  //page and to whole huge pages above.
+  static inline size_t chunk_size(const size_t num_bytes){
+    const size_t granularity = (num_bytes >= HUGE_PAGE_SIZE) ? HUGE_PAGE_SIZE :
+      (num_bytes >= MIN_CHUNK_SIZE) ? MIN_CHUNK_SIZE : CACHE_LINE_SIZE;
+    return ((std::max(num_bytes,(size_t)1) + granularity - 1)/granularity)*granularity;
+  }
+
+  static void* allocate_chunk(const size_t size){
+    const size_t alignment = (size >= HUGE_PAGE_SIZE) ? HUGE_PAGE_SIZE : 64;
+    void *chunk = NULL;
+    if(posix_memalign(&chunk,alignment,size) != 0) {fputs ("Memory error",stderr); exit (2);}
+    #ifdef MADV_HUGEPAGE
+    if(alignment == HUGE_PAGE_SIZE)
+      madvise(chunk,size,MADV_HUGEPAGE);
+    #endif
+    return chunk;
+  }
+
+  //Allocates at least num_bytes, 64 byte aligned (huge page aligned above 2MB).
+  static uint8_t* allocate(const size_t num_bytes){
+    size_t size = chunk_size(num_bytes);
+    std::lock_guard<std::mutex> guard(lock);
+    void *chunk = NULL;
+    std::multimap<size_t,void*>::iterator cached = cached_chunks.lower_bound(size);
+    if(cached != cached_chunks.end() && cached->first - size <= size/MAX_SLACK_FRACTION){
+      chunk = cached->second;
+      size = cached->first;
+      cached_chunks.erase(cached);
+      bytes_cached -= size;
+      num_reused++;
+    } else{
+      chunk = allocate_chunk(size);
+      num_allocated++;
+    }
+    live_chunks[chunk] = size;
+    bytes_in_use += size;
+    peak_bytes_in_use = std::max(peak_bytes_in_use,bytes_in_use);
+    return (uint8_t*) chunk;
+  }
+
+  //Returns a chunk from allocate to the cache (or to the system once the cache is full).
+  static void release(void *chunk){
+    if(chunk == NULL)
+      return;
+    std::lock_guard<std::mutex> guard(lock);
+    std::unordered_map<void*,size_t>::iterator live = live_chunks.find(chunk);
+    if(live == live_chunks.end()) {fputs ("Release of a chunk that was not allocated by the slab allocator",stderr); exit (2);}
+    const size_t size = live->second;
+    live_chunks.erase(live);
+    bytes_in_use -= size;
+    if(bytes_cached + size <= max_cached_bytes){
+      cached_chunks.insert(std::make_pair(size,chunk));
+      bytes_cached += size;
+    } else{
+      free(chunk);
+    }
+  }
+
+  //Grows a chunk to num_bytes keeping its first used_bytes.
+  static uint8_t* reallocate(uint8_t *chunk, const size_t used_bytes, const size_t num_bytes){
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      std::unordered_map<void*,size_t>::iterator live = live_chunks.find(chunk);
+      if(live != live_chunks.end() && live->second >= num_bytes)
+        return chunk;
+    }
+    uint8_t *grown = allocate(num_bytes);
+    memcpy(grown,chunk,used_bytes);
+    release(chunk);
+    return grown;
+  }
+
+  //Frees cached chunks, largest first, until at most max_bytes are cached.
+  //Expects the lock to be held.
+  static inline void shrink_cache(const size_t max_bytes){
+    while(bytes_cached > max_bytes){
+      std::multimap<size_t,void*>::iterator largest = std::prev(cached_chunks.end());
+      bytes_cached -= largest->first;
+      free(largest->second);
+      cached_chunks.erase(largest);
+    }
+  }
+
+  //Called by the builders once a matrix is packed: what the next build
+  //reuses is kept, the rest of the chunks of this build are freed.
+  static inline void trim(){
+    std::lock_guard<std::mutex> guard(lock);
+    shrink_cache(max_idle_bytes);
+  }
+
+  static inline void set_cache_limits(const size_t max_cached_bytes_in, const size_t max_idle_bytes_in){
+    std::lock_guard<std::mutex> guard(lock);
+    max_cached_bytes = max_cached_bytes_in;
+    max_idle_bytes = std::min(max_idle_bytes_in,max_cached_bytes_in);
+    shrink_cache(max_cached_bytes);
+  }
+
+  static inline void print_stats(){
+    std::lock_guard<std::mutex> guard(lock);
+    std::cout << "Slab bytes in use: " << bytes_in_use << std::endl;
+    std::cout << "Slab peak bytes in use: " << peak_bytes_in_use << std::endl;
+    std::cout << "Slab bytes cached: " << bytes_cached << std::endl;
+    std::cout << "Slab chunks allocated: " << num_allocated << " reused: " << num_reused << std::endl;
+  }
+}
+
+#endif
@@ -10,3 +10,12 @@ TEST(CliqueTest, FacebookCliqueCounting) {
   clique_app.run();
   EXPECT_EQ(30004668, clique_app.num_cliques);
 }
+
+TEST(CliqueTest, FacebookCliqueCountingDegeneracyOriented) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser input_data(4,false,4,0,inputGraph,"hybrid");
+  input_data.orientation = common::DEGENERACY_ORDER;
+  n_clique<hybrid,hybrid> clique_app(input_data);
+  clique_app.run();
+  EXPECT_EQ(30004668, clique_app.num_cliques);
+}
@@ -10,3 +10,138 @@ TEST(BFSTest, FacebookCliqueCounting) {
   n_path.run();
   EXPECT_EQ((size_t) 4, n_path.path_length);
 }
+
+TEST(BFSTest, FacebookInternalIds) {
+  MutableGraph* inputGraph = MutableGraph::directedFromBinary("test/data/dfacebook.bin");
+  SparseMatrix<uinteger,uinteger>* graph = SparseMatrix<uinteger,uinteger>::build(inputGraph,
+    [](uint32_t node, uint32_t attribute){(void)node; (void)attribute; return true;},
+    [](uint32_t node, uint32_t nbr, uint32_t attribute){(void)node; (void)nbr; (void)attribute; return true;},
+    4);
+
+  vector<uint64_t> external_ids(graph->id_map,graph->id_map+graph->matrix_size);
+  external_ids.push_back(std::numeric_limits<uint64_t>::max());
+  vector<uint32_t> internal_ids(external_ids.size());
+  graph->get_internal_ids(external_ids.data(),external_ids.size(),internal_ids.data(),4);
+  for(size_t i = 0; i < graph->matrix_size; i++){
+    EXPECT_EQ((uint32_t)i, internal_ids[i]);
+  }
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(), internal_ids.back());
+  EXPECT_EQ((uint32_t)17, graph->get_internal_id(graph->id_map[17]));
+}
+
+TEST(BFSTest, FacebookParallelEdgeList) {
+  MutableGraph* inputGraph = MutableGraph::directedFromBinary("test/data/dfacebook.bin");
+  const string edge_list_path = "/tmp/dfacebook_edges.txt";
+  ofstream edges(edge_list_path);
+  edges << "# FromNodeId\tToNodeId" << endl;
+  vector<uint64_t> first_appearance;
+  unordered_set<uint64_t> seen;
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    const uint64_t src = inputGraph->id_map->at(i);
+    vector<uint32_t> *row = inputGraph->out_neighborhoods->at(i);
+    for(size_t j = 0; j < row->size(); j++){
+      const uint64_t dst = inputGraph->id_map->at(row->at(j));
+      edges << src << "\t" << dst << endl;
+      if(seen.insert(src).second)
+        first_appearance.push_back(src);
+      if(seen.insert(dst).second)
+        first_appearance.push_back(dst);
+    }
+  }
+  edges.close();
+
+  MutableGraph* parsedGraph = MutableGraph::directedFromEdgeList(edge_list_path,8);
+  ASSERT_EQ(first_appearance.size(),parsedGraph->num_nodes);
+  EXPECT_TRUE(first_appearance == *parsedGraph->id_map);
+
+  unordered_map<uint64_t,uint32_t> parsed_ids;
+  for(size_t i = 0; i < parsedGraph->num_nodes; i++){
+    parsed_ids[parsedGraph->id_map->at(i)] = i;
+  }
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    if(parsed_ids.find(inputGraph->id_map->at(i)) == parsed_ids.end())
+      continue;
+    const uint32_t p = parsed_ids[inputGraph->id_map->at(i)];
+    for(size_t side = 0; side < 2; side++){
+      vector<uint32_t> *row = (side == 0) ? inputGraph->out_neighborhoods->at(i) : inputGraph->in_neighborhoods->at(i);
+      vector<uint32_t> *parsed_row = (side == 0) ? parsedGraph->out_neighborhoods->at(p) : parsedGraph->in_neighborhoods->at(p);
+      vector<uint32_t> expected;
+      for(size_t j = 0; j < row->size(); j++){
+        expected.push_back(parsed_ids[inputGraph->id_map->at(row->at(j))]);
+      }
+      std::sort(expected.begin(),expected.end());
+      EXPECT_TRUE(expected == *parsed_row);
+    }
+  }
+}
+
+TEST(BFSTest, PipelinedReader) {
+  ifstream binary("test/data/dfacebook.bin", ios::binary);
+  const string contents((istreambuf_iterator<char>(binary)),istreambuf_iterator<char>());
+
+  //Records of 7 bytes straddle the 1000 byte buffers.
+  pipelined_io::stream stream("test/data/dfacebook.bin",1000);
+  ASSERT_EQ(contents.size(),stream.file_size());
+  string streamed(contents.size(),'\0');
+  for(size_t i = 0; i < contents.size(); i += 7){
+    stream.read(&streamed[i],min((size_t)7,contents.size()-i));
+  }
+  EXPECT_TRUE(contents == streamed);
+
+  const string text_path = "/tmp/pipelined_lines.txt";
+  ofstream text(text_path);
+  string expected;
+  for(size_t i = 0; i < 5000; i++){
+    const string line = to_string(i*7919) + "\t" + to_string(i) + "\n";
+    text << line;
+    expected += line;
+  }
+  text << "12 13";
+  expected += "12 13";
+  text.close();
+
+  pipelined_io::reader lines(text_path,true,4096);
+  string joined;
+  while(pipelined_io::buffer *b = lines.next()){
+    joined.append(b->data,b->size);
+    if(joined.size() < expected.size()){
+      EXPECT_EQ('\n',b->data[b->size-1]);
+    }
+  }
+  unlink(text_path.c_str());
+  EXPECT_TRUE(expected == joined);
+}
+
+TEST(BFSTest, FacebookReorderedDirected) {
+  MutableGraph* inputGraph = MutableGraph::directedFromBinary("test/data/dfacebook.bin");
+  set< pair<uint64_t,uint64_t> > expected;
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    vector<uint32_t> *row = inputGraph->out_neighborhoods->at(i);
+    for(size_t j = 0; j < row->size(); j++){
+      expected.insert(make_pair(inputGraph->id_map->at(i),inputGraph->id_map->at(row->at(j))));
+    }
+  }
+
+  inputGraph->reorder_by_the_game(4);
+  set< pair<uint64_t,uint64_t> > out_edges;
+  set< pair<uint64_t,uint64_t> > in_edges;
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    vector<uint32_t> *out = inputGraph->out_neighborhoods->at(i);
+    vector<uint32_t> *in = inputGraph->in_neighborhoods->at(i);
+    EXPECT_TRUE(std::is_sorted(out->begin(),out->end()));
+    EXPECT_TRUE(std::is_sorted(in->begin(),in->end()));
+    for(size_t j = 0; j < out->size(); j++){
+      out_edges.insert(make_pair(inputGraph->id_map->at(i),inputGraph->id_map->at(out->at(j))));
+    }
+    for(size_t j = 0; j < in->size(); j++){
+      in_edges.insert(make_pair(inputGraph->id_map->at(in->at(j)),inputGraph->id_map->at(i)));
+    }
+  }
+  EXPECT_TRUE(expected == out_edges);
+  EXPECT_TRUE(expected == in_edges);
+
+  Parser input_data(4,false,4,0,inputGraph,"uint");
+  n_path<uinteger,uinteger> n_path(input_data);
+  n_path.run();
+  EXPECT_EQ((size_t) 4, n_path.path_length);
+}
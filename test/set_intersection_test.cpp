@@ -0,0 +1,326 @@
+#define WRITE_VECTOR 1
+
+#include <random>
+#include "gtest/gtest.h"
+#include "SparseMatrix.hpp"
+
+/*
+The uinteger and pshort intersections run the widest block loop the CPU
+supports before the 128-bit one. Random sets, sparse and dense, with runs of
+equal prefixes longer than every block width are checked against
+std::set_intersection, with the kernels of every ISA the CPU supports.
+*/
+static vector<uint32_t> random_set(std::mt19937 &generator, const size_t length, const uint32_t range){
+  std::uniform_int_distribution<uint32_t> value(0,range-1);
+  std::set<uint32_t> elements;
+  while(elements.size() < length)
+    elements.insert(value(generator));
+  return vector<uint32_t>(elements.begin(),elements.end());
+}
+
+static vector<uint32_t> elements_of(Set<uinteger> *S){
+  vector<uint32_t> elements;
+  S->foreach([&](uint32_t e){ elements.push_back(e); });
+  return elements;
+}
+
+static vector<uint32_t> elements_of(Set<pshort> *S){
+  vector<uint32_t> elements;
+  S->foreach([&](uint32_t e){ elements.push_back(e); });
+  return elements;
+}
+
+TEST(SetIntersectionTest, WideKernelsMatchReference) {
+  ops::prepare_shuffling_dictionary16();
+  std::mt19937 generator(2015);
+  const size_t lengths[] = {0, 3, 17, 64, 500, 3000};
+  const uint32_t ranges[] = {100, 5000, 200000, 1 << 24};
+
+  const size_t max_length = 3000;
+  uint8_t *a_buffer = new uint8_t[max_length*sizeof(uint32_t)*4];
+  uint8_t *b_buffer = new uint8_t[max_length*sizeof(uint32_t)*4];
+  uint8_t *c_buffer = new uint8_t[max_length*sizeof(uint32_t)*4];
+
+  for(int level = ops::SSE42; level <= ops::detect_isa(); level++){
+    ops::use_isa((ops::isa)level);
+    for(size_t r = 0; r < 4; r++){
+      for(size_t la = 0; la < 6; la++){
+        for(size_t lb = 0; lb < 6; lb++){
+          if(lengths[la] > ranges[r] || lengths[lb] > ranges[r])
+            continue;
+          vector<uint32_t> a = random_set(generator,lengths[la],ranges[r]);
+          vector<uint32_t> b = random_set(generator,lengths[lb],ranges[r]);
+          vector<uint32_t> expected;
+          std::set_intersection(a.begin(),a.end(),b.begin(),b.end(),std::back_inserter(expected));
+
+          Set<uinteger> A = Set<uinteger>::from_array(a_buffer,a.data(),a.size());
+          Set<uinteger> B = Set<uinteger>::from_array(b_buffer,b.data(),b.size());
+          Set<uinteger> C(c_buffer);
+          ops::set_intersect_standard(&C,&A,&B);
+          EXPECT_EQ(expected.size(),C.cardinality);
+          EXPECT_TRUE(expected == elements_of(&C));
+
+          Set<pshort> B_pshort = Set<pshort>::from_array(b_buffer,b.data(),b.size());
+          ops::set_intersect(&C,&A,&B_pshort);
+          EXPECT_EQ(expected.size(),C.cardinality);
+          EXPECT_TRUE(expected == elements_of(&C));
+
+          Set<pshort> A_pshort = Set<pshort>::from_array(a_buffer,a.data(),a.size());
+          Set<pshort> C_pshort(c_buffer);
+          ops::set_intersect(&C_pshort,&A_pshort,&B_pshort);
+          EXPECT_EQ(expected.size(),C_pshort.cardinality);
+          EXPECT_TRUE(expected == elements_of(&C_pshort));
+        }
+      }
+    }
+  }
+  ops::use_isa(ops::detect_isa());
+  delete[] a_buffer;
+  delete[] b_buffer;
+  delete[] c_buffer;
+}
+
+TEST(SetIntersectionTest, WordKernelsMatchScalar) {
+  std::mt19937_64 generator(2015);
+  const size_t n = 131;
+  uint64_t a[n], b[n], c[n], or_result[n];
+  for(size_t i = 0; i < n; i++){
+    a[i] = generator() & generator();
+    b[i] = generator() & generator();
+  }
+
+  for(int level = ops::SSE42; level <= ops::detect_isa(); level++){
+    ops::use_isa((ops::isa)level);
+    for(size_t length = 0; length <= n; length += 13){
+      size_t expected = 0;
+      for(size_t i = 0; i < length; i++)
+        expected += __builtin_popcountll(a[i] & b[i]);
+      EXPECT_EQ(expected,ops::kernels.and_words(c,a,b,length));
+      for(size_t i = 0; i < length; i++)
+        EXPECT_EQ(a[i] & b[i],c[i]);
+
+      ops::kernels.andnot_words(c,a,b,length);
+      for(size_t i = 0; i < length; i++)
+        EXPECT_EQ(a[i] & ~b[i],c[i]);
+
+      memcpy(or_result,a,sizeof(a));
+      ops::kernels.or_words(or_result,b,length);
+      for(size_t i = 0; i < length; i++)
+        EXPECT_EQ(a[i] | b[i],or_result[i]);
+    }
+  }
+  ops::use_isa(ops::detect_isa());
+}
+
+/*
+Sets over several 2^16 chunks, each chunk sparse, dense or made of runs, so
+every pair of roaring container types meets.
+*/
+static vector<uint32_t> mixed_set(std::mt19937 &generator, const size_t num_chunks){
+  std::uniform_int_distribution<uint32_t> value(0,0xFFFF);
+  std::set<uint32_t> elements;
+  for(uint32_t chunk = 0; chunk < num_chunks; chunk++){
+    const uint32_t prefix = (chunk*3 + generator()%2) << 16;
+    switch(generator() % 3){
+      case 0:
+        for(size_t i = 0; i < 300; i++)
+          elements.insert(prefix | value(generator));
+        break;
+      case 1:
+        for(size_t i = 0; i < 3000; i++)
+          elements.insert(prefix | (value(generator) % 8192));
+        break;
+      default:
+        for(size_t r = 0; r < 20; r++){
+          const uint32_t start = value(generator) % 60000;
+          const uint32_t length = 1 + generator() % 2000;
+          for(uint32_t j = 0; j < length; j++)
+            elements.insert(prefix | (start+j));
+        }
+        break;
+    }
+  }
+  return vector<uint32_t>(elements.begin(),elements.end());
+}
+
+TEST(SetIntersectionTest, RoaringMatchesReference) {
+  ops::prepare_shuffling_dictionary16();
+  std::mt19937 generator(2015);
+  const size_t buffer_bytes = 1 << 24;
+  uint8_t *a_buffer = new uint8_t[buffer_bytes];
+  uint8_t *b_buffer = new uint8_t[buffer_bytes];
+  uint8_t *c_buffer = new uint8_t[buffer_bytes];
+
+  for(int level = ops::SSE42; level <= ops::detect_isa(); level++){
+    ops::use_isa((ops::isa)level);
+    for(size_t trial = 0; trial < 40; trial++){
+      vector<uint32_t> a = mixed_set(generator,1+trial%5);
+      vector<uint32_t> b = mixed_set(generator,1+trial%4);
+      vector<uint32_t> expected;
+      std::set_intersection(a.begin(),a.end(),b.begin(),b.end(),std::back_inserter(expected));
+
+      Set<roaring> A = Set<roaring>::from_array(a_buffer,a.data(),a.size());
+      vector<uint32_t> decoded;
+      A.foreach([&](uint32_t e){ decoded.push_back(e); });
+      EXPECT_TRUE(a == decoded);
+
+      Set<roaring> B = Set<roaring>::from_array(b_buffer,b.data(),b.size());
+      Set<roaring> C(c_buffer);
+      ops::set_intersect(&C,&A,&B);
+      vector<uint32_t> result;
+      C.foreach([&](uint32_t e){ result.push_back(e); });
+      EXPECT_EQ(expected.size(),C.cardinality);
+      EXPECT_TRUE(expected == result);
+
+      Set<uinteger> A_uint = Set<uinteger>::from_array(a_buffer,a.data(),a.size());
+      Set<uinteger> C_uint(c_buffer);
+      ops::set_intersect(&C_uint,&A_uint,&B);
+      EXPECT_EQ(expected.size(),C_uint.cardinality);
+      EXPECT_TRUE(expected == elements_of(&C_uint));
+
+      Set<bitset> A_bitset = Set<bitset>::from_array(a_buffer,a.data(),a.size());
+      ops::set_intersect(&C,&A_bitset,&B);
+      result.clear();
+      C.foreach([&](uint32_t e){ result.push_back(e); });
+      EXPECT_EQ(expected.size(),C.cardinality);
+      EXPECT_TRUE(expected == result);
+    }
+  }
+  ops::use_isa(ops::detect_isa());
+  delete[] a_buffer;
+  delete[] b_buffer;
+  delete[] c_buffer;
+}
+
+TEST(SetIntersectionTest, RunsMatchesReference) {
+  std::mt19937 generator(2016);
+  const size_t buffer_bytes = 1 << 24;
+  uint8_t *a_buffer = new uint8_t[buffer_bytes];
+  uint8_t *b_buffer = new uint8_t[buffer_bytes];
+  uint8_t *c_buffer = new uint8_t[buffer_bytes];
+
+  for(int level = ops::SSE42; level <= ops::detect_isa(); level++){
+    ops::use_isa((ops::isa)level);
+    for(size_t trial = 0; trial < 20; trial++){
+      vector<uint32_t> a = mixed_set(generator,1+trial%5);
+      vector<uint32_t> b = mixed_set(generator,1+trial%4);
+      vector<uint32_t> expected;
+      std::set_intersection(a.begin(),a.end(),b.begin(),b.end(),std::back_inserter(expected));
+
+      Set<runs> A = Set<runs>::from_array(a_buffer,a.data(),a.size());
+      vector<uint32_t> decoded;
+      A.foreach([&](uint32_t e){ decoded.push_back(e); });
+      EXPECT_TRUE(a == decoded);
+
+      Set<runs> B = Set<runs>::from_array(b_buffer,b.data(),b.size());
+      Set<runs> C(c_buffer);
+      ops::set_intersect(&C,&A,&B);
+      vector<uint32_t> result;
+      C.foreach([&](uint32_t e){ result.push_back(e); });
+      EXPECT_EQ(expected.size(),C.cardinality);
+      EXPECT_TRUE(expected == result);
+
+      Set<uinteger> A_uint = Set<uinteger>::from_array(a_buffer,a.data(),a.size());
+      Set<uinteger> C_uint(c_buffer);
+      ops::set_intersect(&C_uint,&A_uint,&B);
+      EXPECT_EQ(expected.size(),C_uint.cardinality);
+      EXPECT_TRUE(expected == elements_of(&C_uint));
+
+      Set<bitset> A_bitset = Set<bitset>::from_array(a_buffer,a.data(),a.size());
+      Set<bitset> C_bitset(c_buffer);
+      ops::set_intersect(&C_bitset,&A_bitset,&B);
+      result.clear();
+      C_bitset.foreach([&](uint32_t e){ result.push_back(e); });
+      EXPECT_EQ(expected.size(),C_bitset.cardinality);
+      EXPECT_TRUE(expected == result);
+    }
+  }
+  ops::use_isa(ops::detect_isa());
+  delete[] a_buffer;
+  delete[] b_buffer;
+  delete[] c_buffer;
+}
+
+TEST(SetIntersectionTest, BitsetNewMatchesReference) {
+  std::mt19937 generator(2017);
+  const size_t buffer_bytes = 1 << 24;
+  uint8_t *a_buffer = new uint8_t[buffer_bytes];
+  uint8_t *b_buffer = new uint8_t[buffer_bytes];
+  uint8_t *c_buffer = new uint8_t[buffer_bytes];
+
+  for(int level = ops::SSE42; level <= ops::detect_isa(); level++){
+    ops::use_isa((ops::isa)level);
+    for(size_t trial = 0; trial < 20; trial++){
+      vector<uint32_t> a = mixed_set(generator,1+trial%5);
+      vector<uint32_t> b = mixed_set(generator,1+trial%4);
+      vector<uint32_t> expected;
+      std::set_intersection(a.begin(),a.end(),b.begin(),b.end(),std::back_inserter(expected));
+
+      Set<bitset_new> A = Set<bitset_new>::from_array(a_buffer,a.data(),a.size());
+      vector<uint32_t> decoded;
+      A.foreach([&](uint32_t e){ decoded.push_back(e); });
+      EXPECT_TRUE(a == decoded);
+
+      Set<bitset_new> B = Set<bitset_new>::from_array(b_buffer,b.data(),b.size());
+      Set<bitset_new> C(c_buffer);
+      ops::set_intersect(&C,&A,&B);
+      vector<uint32_t> result;
+      C.foreach([&](uint32_t e){ result.push_back(e); });
+      EXPECT_EQ(expected.size(),C.cardinality);
+      EXPECT_TRUE(expected == result);
+      //Only blocks with a common id are kept.
+      std::set<uint32_t> expected_blocks;
+      for(size_t i = 0; i < expected.size(); i++)
+        expected_blocks.insert(expected[i]/BLOCK_SIZE);
+      EXPECT_EQ(expected_blocks.size(),bitset_new::num_blocks(C.number_of_bytes));
+
+      Set<uinteger> A_uint = Set<uinteger>::from_array(a_buffer,a.data(),a.size());
+      Set<uinteger> C_uint(c_buffer);
+      ops::set_intersect(&C_uint,&A_uint,&B);
+      EXPECT_EQ(expected.size(),C_uint.cardinality);
+      EXPECT_TRUE(expected == elements_of(&C_uint));
+    }
+  }
+  ops::use_isa(ops::detect_isa());
+  delete[] a_buffer;
+  delete[] b_buffer;
+  delete[] c_buffer;
+}
+
+/*
+Hub rows with one neighbor per block are the worst case for the bitset_new
+result: a block per element. The result must fit MAX_BYTES_PER_ELEMENT bytes
+per element of the smaller input, also when the blocks it ANDs in place come
+out empty.
+*/
+TEST(SetIntersectionTest, BitsetNewSparseRowsFitResultBound) {
+  const size_t num_ids = 1000;
+  const size_t guard_bytes = 64;
+  uint8_t *a_buffer = new uint8_t[num_ids*MAX_BYTES_PER_ELEMENT];
+  uint8_t *b_buffer = new uint8_t[num_ids*MAX_BYTES_PER_ELEMENT];
+
+  for(int level = ops::SSE42; level <= ops::detect_isa(); level++){
+    ops::use_isa((ops::isa)level);
+    for(uint32_t offset = 0; offset < 2; offset++){
+      vector<uint32_t> a, b;
+      for(uint32_t i = 0; i < num_ids; i++){
+        a.push_back(i*BLOCK_SIZE);
+        b.push_back(i*BLOCK_SIZE+offset);
+      }
+      Set<bitset_new> A = Set<bitset_new>::from_array(a_buffer,a.data(),a.size());
+      Set<bitset_new> B = Set<bitset_new>::from_array(b_buffer,b.data(),b.size());
+
+      const size_t result_bytes = num_ids*MAX_BYTES_PER_ELEMENT;
+      vector<uint8_t> c_buffer(result_bytes+guard_bytes,0xAB);
+      Set<bitset_new> C(c_buffer.data());
+      ops::set_intersect(&C,&A,&B);
+      EXPECT_EQ(offset == 0 ? num_ids : 0,C.cardinality);
+      EXPECT_GE(result_bytes,C.number_of_bytes);
+      for(size_t i = result_bytes; i < c_buffer.size(); i++)
+        EXPECT_EQ(0xAB,c_buffer[i]);
+    }
+  }
+  ops::use_isa(ops::detect_isa());
+  delete[] a_buffer;
+  delete[] b_buffer;
+}
@@ -18,3 +18,90 @@ TEST(SymbiosityTest, FacebookSymbiosityCountingHybridUndirected) {
   symbiosity_app.run();
   EXPECT_EQ((size_t) 4039, symbiosity_app.count);
 }
+
+TEST(SymbiosityTest, ColumnarEdgeAttributes) {
+  const string edge_path = "/tmp/symbiosity_attribute_edges.txt";
+  const string node_path = "/tmp/symbiosity_attribute_nodes.txt";
+  ofstream edges(edge_path);
+  ofstream nodes(node_path);
+  for(uint64_t src = 0; src < 200; src++){
+    nodes << src << " " << src%3 << endl;
+    for(uint64_t k = 0; k < 5; k++){
+      const uint64_t dst = (src*7+k*13)%200;
+      if(dst != src)
+        edges << src << " " << dst << " " << (src*31+dst)%100 << endl;
+    }
+  }
+  edges.close();
+  nodes.close();
+
+  MutableGraph* inputGraph = MutableGraph::directedFromAttributeList(edge_path,node_path);
+  SparseMatrix<hybrid,hybrid>* graph = SparseMatrix<hybrid,hybrid>::build(inputGraph,
+    [](uint32_t node, uint32_t attribute){(void) node; return attribute != 0;},
+    [](uint32_t node, uint32_t nbr, uint32_t attribute){(void) node; (void) nbr; return attribute < 50;},
+    4);
+
+  size_t num_checked = 0;
+  for(size_t i = 0; i < graph->matrix_size; i++){
+    const uint32_t *row_attributes = graph->get_row_attributes(i);
+    size_t j = 0;
+    graph->get_row(i).foreach([&](uint32_t nbr){
+      EXPECT_EQ((graph->id_map[i]*31+graph->id_map[nbr])%100,(uint64_t)row_attributes[j]);
+      EXPECT_LT(row_attributes[j++],(uint32_t)50);
+    });
+    const uint32_t *col_attributes = graph->get_column_attributes(i);
+    size_t k = 0;
+    graph->get_column(i).foreach([&](uint32_t nbr){
+      EXPECT_EQ((graph->id_map[nbr]*31+graph->id_map[i])%100,(uint64_t)col_attributes[k++]);
+    });
+    num_checked += j + k;
+  }
+  EXPECT_EQ(graph->cardinality,num_checked);
+  delete graph;
+}
+
+TEST(SymbiosityTest, ReorderedEdgeAttributes) {
+  const string edge_path = "/tmp/symbiosity_reordered_edges.txt";
+  const string node_path = "/tmp/symbiosity_reordered_nodes.txt";
+  ofstream edges(edge_path);
+  ofstream nodes(node_path);
+  for(uint64_t src = 0; src < 200; src++){
+    nodes << src << " " << src%3 << endl;
+    for(uint64_t k = 0; k < 5; k++){
+      const uint64_t dst = (src*7+k*13)%200;
+      if(dst != src)
+        edges << src << " " << dst << " " << (src*31+dst)%100 << endl;
+    }
+  }
+  edges.close();
+  nodes.close();
+
+  MutableGraph* inputGraph = MutableGraph::directedFromAttributeList(edge_path,node_path);
+  const size_t num_edges = inputGraph->num_edges;
+  inputGraph->reorder_rcm(4);
+
+  size_t num_out = 0;
+  size_t num_in = 0;
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    const uint64_t id = inputGraph->id_map->at(i);
+    EXPECT_EQ((uint32_t)(id%3),inputGraph->node_attr->at(i));
+    vector<uint32_t> *out = inputGraph->out_neighborhoods->at(i);
+    vector<uint32_t> *in = inputGraph->in_neighborhoods->at(i);
+    EXPECT_TRUE(std::is_sorted(out->begin(),out->end()));
+    EXPECT_TRUE(std::is_sorted(in->begin(),in->end()));
+    for(size_t j = 0; j < out->size(); j++){
+      const uint64_t nbr = inputGraph->id_map->at(out->at(j));
+      EXPECT_EQ((id*31+nbr)%100,(uint64_t)inputGraph->out_edge_attributes->at(i)->at(j));
+      vector<uint32_t> *nbr_in = inputGraph->in_neighborhoods->at(out->at(j));
+      EXPECT_TRUE(std::binary_search(nbr_in->begin(),nbr_in->end(),(uint32_t)i));
+    }
+    for(size_t j = 0; j < in->size(); j++){
+      const uint64_t nbr = inputGraph->id_map->at(in->at(j));
+      EXPECT_EQ((nbr*31+id)%100,(uint64_t)inputGraph->in_edge_attributes->at(i)->at(j));
+    }
+    num_out += out->size();
+    num_in += in->size();
+  }
+  EXPECT_EQ(num_edges,num_out);
+  EXPECT_EQ(num_edges,num_in);
+}
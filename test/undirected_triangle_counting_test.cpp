@@ -2,6 +2,18 @@
 
 #include "gtest/gtest.h"
 #include "undirected_triangle_counting.cpp"
+#include "DeltaMatrix.hpp"
+
+//Creates an empty file with a unique name under /tmp, removed by the caller.
+static string temporary_file(const string name){
+  string pattern = "/tmp/" + name + ".XXXXXX";
+  vector<char> path(pattern.begin(),pattern.end());
+  path.push_back('\0');
+  const int fd = mkstemp(path.data());
+  if(fd == -1) {fputs ("Temporary file error",stderr); exit (1);}
+  close(fd);
+  return string(path.data());
+}
 
 TEST(TEST1, FACEBOOK_TRIANGLES_HYBRID) {
   MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
@@ -11,3 +23,415 @@ TEST(TEST1, FACEBOOK_TRIANGLES_HYBRID) {
   size_t expected_result = 1612010;
   EXPECT_EQ(expected_result, triangle_app.num_triangles);
 }
+
+TEST(TEST1, FACEBOOK_TRIANGLES_ROARING) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser input_data(4,false,0,0,inputGraph,"roaring");
+  undirected_triangle_counting<roaring,roaring> triangle_app(input_data);
+  triangle_app.run();
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_RUNS) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser input_data(4,false,0,0,inputGraph,"runs");
+  undirected_triangle_counting<runs,runs> triangle_app(input_data);
+  triangle_app.run();
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_BITSET_NEW) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser input_data(4,false,0,0,inputGraph,"bitset_new");
+  undirected_triangle_counting<bitset_new,bitset_new> triangle_app(input_data);
+  triangle_app.run();
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_SNAPSHOT) {
+  const string snapshot_path = "/tmp/facebook_triangles_hybrid.snapshot";
+  unlink(snapshot_path.c_str());
+
+  const uint64_t graph_hash = snapshot::file_hash("test/data/facebook.bin");
+  const snapshot::source source = snapshot::make_source("undirected_triangle_counting","",
+    common::ID_ORDER,common::UNDIRECTED,graph_hash);
+
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser build_data(4,false,0,0,inputGraph,"hybrid",snapshot_path);
+  build_data.snapshot_source = source;
+  undirected_triangle_counting<hybrid,hybrid> build_app(build_data);
+  build_app.run();
+
+  //Only a run built from the same source maps the snapshot.
+  const snapshot::header h = snapshot::read_header(snapshot_path);
+  EXPECT_TRUE(snapshot::matches(h,source));
+  EXPECT_FALSE(snapshot::matches(h,snapshot::make_source("undirected_lollipop_counting","",
+    common::ID_ORDER,common::UNDIRECTED,graph_hash)));
+  EXPECT_FALSE(snapshot::matches(h,snapshot::make_source("undirected_triangle_counting","",
+    common::DEGREE_ORDER,common::UNDIRECTED,graph_hash)));
+  EXPECT_FALSE(snapshot::matches(h,snapshot::make_source("undirected_triangle_counting","rcm",
+    common::ID_ORDER,common::UNDIRECTED,graph_hash)));
+  EXPECT_FALSE(snapshot::matches(h,snapshot::make_source("undirected_triangle_counting","",
+    common::ID_ORDER,common::UNDIRECTED,graph_hash+1)));
+
+  Parser mapped_data(4,false,0,0,NULL,"hybrid",snapshot_path);
+  mapped_data.snapshot_source = source;
+  undirected_triangle_counting<hybrid,hybrid> mapped_app(mapped_data);
+  mapped_app.run();
+  unlink(snapshot_path.c_str());
+
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, build_app.num_triangles);
+  EXPECT_EQ(expected_result, mapped_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_STREAMED) {
+  Parser input_data(4,false,0,0,NULL,"hybrid");
+  input_data.stream_path = "test/data/facebook.bin";
+  undirected_triangle_counting<hybrid,hybrid> triangle_app(input_data);
+  triangle_app.run();
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_BINARY_V2) {
+  const string binary_path = "/tmp/facebook_v2.bin";
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  inputGraph->writeToBinaryV2(binary_path);
+
+  MutableGraph* loadedGraph = MutableGraph::undirectedFromBinary(binary_path,4);
+  ASSERT_EQ(inputGraph->num_nodes,loadedGraph->num_nodes);
+  EXPECT_EQ(inputGraph->num_edges,loadedGraph->num_edges);
+  EXPECT_EQ(inputGraph->max_nbrhood_size,loadedGraph->max_nbrhood_size);
+  EXPECT_TRUE(*inputGraph->id_map == *loadedGraph->id_map);
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    EXPECT_TRUE(*inputGraph->out_neighborhoods->at(i) == *loadedGraph->out_neighborhoods->at(i));
+  }
+
+  Parser input_data(4,false,0,0,loadedGraph,"hybrid");
+  undirected_triangle_counting<hybrid,hybrid> triangle_app(input_data);
+  triangle_app.run();
+
+  Parser stream_data(4,false,0,0,NULL,"hybrid");
+  stream_data.stream_path = binary_path;
+  undirected_triangle_counting<hybrid,hybrid> stream_app(stream_data);
+  stream_app.run();
+  unlink(binary_path.c_str());
+
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+  EXPECT_EQ(expected_result, stream_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_COMPRESSED) {
+  const string binary_path = "/tmp/facebook_v2.bin";
+  const string compressed_path = "/tmp/facebook_compressed.bin";
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  inputGraph->writeToBinaryV2(binary_path);
+  inputGraph->writeToCompressedBinary(compressed_path,4);
+
+  struct stat binary_stat;
+  struct stat compressed_stat;
+  stat(binary_path.c_str(),&binary_stat);
+  stat(compressed_path.c_str(),&compressed_stat);
+  EXPECT_LT(2*compressed_stat.st_size,binary_stat.st_size);
+
+  MutableGraph* loadedGraph = MutableGraph::undirectedFromBinary(compressed_path,4);
+  ASSERT_EQ(inputGraph->num_nodes,loadedGraph->num_nodes);
+  EXPECT_TRUE(*inputGraph->id_map == *loadedGraph->id_map);
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    EXPECT_TRUE(*inputGraph->out_neighborhoods->at(i) == *loadedGraph->out_neighborhoods->at(i));
+  }
+
+  Parser stream_data(4,false,0,0,NULL,"hybrid");
+  stream_data.stream_path = compressed_path;
+  undirected_triangle_counting<hybrid,hybrid> stream_app(stream_data);
+  stream_app.run();
+  unlink(binary_path.c_str());
+  unlink(compressed_path.c_str());
+
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, stream_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_DEGENERACY_ORIENTED) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser input_data(4,false,0,0,inputGraph,"hybrid");
+  input_data.orientation = common::DEGENERACY_ORDER;
+  undirected_triangle_counting<hybrid,hybrid> triangle_app(input_data);
+  triangle_app.run();
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_DEGREE_ORIENTED) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  Parser input_data(4,false,0,0,inputGraph,"hybrid");
+  input_data.orientation = common::DEGREE_ORDER;
+  undirected_triangle_counting<hybrid,hybrid> triangle_app(input_data);
+  triangle_app.run();
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, triangle_app.num_triangles);
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_64BIT_IDS) {
+  const string edge_list_path = "/tmp/facebook_triangles_64bit.txt";
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  ofstream edge_list(edge_list_path);
+  for(size_t i = 0; i < inputGraph->num_nodes; i++){
+    vector<uint32_t> *hood = inputGraph->out_neighborhoods->at(i);
+    for(size_t j = 0; j < hood->size(); j++){
+      if(hood->at(j) < i)
+        edge_list << inputGraph->id_map->at(i) << " " << inputGraph->id_map->at(hood->at(j)) << endl;
+    }
+  }
+  edge_list.close();
+
+  typedef basic_uinteger<uint64_t> uinteger64;
+  BasicMutableGraph<uint64_t>* wideGraph = BasicMutableGraph<uint64_t>::undirectedFromEdgeList(edge_list_path);
+  unlink(edge_list_path.c_str());
+  SparseMatrix<uinteger64,uinteger64,uint64_t>* graph = SparseMatrix<uinteger64,uinteger64,uint64_t>::build(wideGraph,
+    [](uint64_t node, uint32_t attribute){(void)node; (void)attribute; return true;},
+    [](uint64_t node, uint64_t nbr, uint32_t attribute){(void)attribute; return nbr < node;},
+    4);
+
+  size_t num_triangles = 0;
+  for(size_t i = 0; i < graph->matrix_size; i++){
+    vector<uint64_t> a;
+    graph->get_row(i).foreach([&a](uint64_t nbr){ a.push_back(nbr); });
+    for(size_t j = 0; j < a.size(); j++){
+      graph->get_row(a[j]).foreach([&a,&num_triangles](uint64_t nbr){
+        num_triangles += std::binary_search(a.begin(),a.end(),nbr);
+      });
+    }
+  }
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, num_triangles);
+  EXPECT_EQ(inputGraph->num_edges/2, graph->cardinality);
+
+  //Delete and reinsert the edges of the 1000 largest rows through a delta.
+  const size_t cardinality = graph->cardinality;
+  vector< pair<uint64_t,uint64_t> > edges;
+  for(size_t i = graph->matrix_size-1000; i < graph->matrix_size; i++){
+    graph->get_row(i).foreach([&](uint64_t j){ edges.push_back(make_pair(i,j)); });
+  }
+  DeltaMatrix<uinteger64,uinteger64,uint64_t> delta(graph);
+  delta.delete_edges(edges);
+  delta.compact(4);
+  delta.insert_edges(edges);
+  delta.compact(4);
+
+  shared_ptr<const DeltaMatrix<uinteger64,uinteger64,uint64_t>::version> v = delta.snapshot();
+  uint64_t *decoded_a = new uint64_t[v->max_row_length()];
+  uint64_t *decoded_b = new uint64_t[v->max_row_length()];
+  uint8_t *buffer_a = new uint8_t[v->max_row_bytes()];
+  uint8_t *buffer_b = new uint8_t[v->max_row_bytes()];
+  num_triangles = 0;
+  for(size_t i = 0; i < v->base->matrix_size; i++){
+    vector<uint64_t> a;
+    v->get_row(i,decoded_a,buffer_a).foreach([&a](uint64_t nbr){ a.push_back(nbr); });
+    for(size_t j = 0; j < a.size(); j++){
+      v->get_row(a[j],decoded_b,buffer_b).foreach([&a,&num_triangles](uint64_t nbr){
+        num_triangles += std::binary_search(a.begin(),a.end(),nbr);
+      });
+    }
+  }
+  EXPECT_EQ(expected_result, num_triangles);
+  EXPECT_EQ(cardinality, v->base->cardinality);
+}
+
+template<class T,class R>
+static size_t count_triangles(const typename DeltaMatrix<T,R>::version *graph){
+  uint32_t *decoded_a = new uint32_t[graph->max_row_length()];
+  uint32_t *decoded_b = new uint32_t[graph->max_row_length()];
+  uint8_t *buffer_a = new uint8_t[graph->max_row_bytes()];
+  uint8_t *buffer_b = new uint8_t[graph->max_row_bytes()];
+  Set<R> C(new uint8_t[512*graph->max_row_length()*sizeof(uint32_t)]);
+  size_t num_triangles = 0;
+  for(size_t i = 0; i < graph->base->matrix_size; i++){
+    Set<R> A = graph->get_row(i,decoded_a,buffer_a);
+    A.foreach([&](uint32_t j){
+      Set<R> B = graph->get_row(j,decoded_b,buffer_b);
+      num_triangles += ops::set_intersect(&C,&A,&B)->cardinality;
+    });
+  }
+  return num_triangles;
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_DELTA) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  SparseMatrix<hybrid,hybrid>* matrix = SparseMatrix<hybrid,hybrid>::build(inputGraph,
+    [](uint32_t node, uint32_t attribute){(void)node; (void)attribute; return true;},
+    [](uint32_t node, uint32_t nbr, uint32_t attribute){(void)attribute; return nbr < node;},
+    4);
+  common::alloc_scratch_space(512*matrix->max_nbrhood_size*sizeof(uint32_t),4);
+  //Compacted by hand, so the merged rows of the deltas are counted.
+  DeltaMatrix<hybrid,hybrid> graph(matrix,0.0);
+
+  //Remove the edges of the 1000 largest rows, then put them back.
+  vector< pair<uint32_t,uint32_t> > edges;
+  for(size_t i = matrix->matrix_size-1000; i < matrix->matrix_size; i++){
+    matrix->get_row(i).foreach([&](uint32_t j){ edges.push_back(make_pair(i,j)); });
+  }
+  shared_ptr<const DeltaMatrix<hybrid,hybrid>::version> before = graph.snapshot();
+  graph.delete_edges(edges);
+  shared_ptr<const DeltaMatrix<hybrid,hybrid>::version> deleted = graph.snapshot();
+  graph.compact(4);
+  graph.insert_edges(edges);
+
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, (count_triangles<hybrid,hybrid>(before.get())));
+  EXPECT_GT(expected_result, (count_triangles<hybrid,hybrid>(deleted.get())));
+  EXPECT_EQ(expected_result, (count_triangles<hybrid,hybrid>(graph.snapshot().get())));
+
+  graph.compact(4);
+  EXPECT_EQ((size_t)0, graph.snapshot()->num_dirty);
+  EXPECT_EQ(matrix->cardinality, graph.snapshot()->base->cardinality);
+  EXPECT_EQ(expected_result, (count_triangles<hybrid,hybrid>(graph.snapshot().get())));
+}
+
+TEST(TEST1, FACEBOOK_TRIANGLES_DELTA_AUTO_COMPACTION) {
+  MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  SparseMatrix<hybrid,hybrid>* matrix = SparseMatrix<hybrid,hybrid>::build(inputGraph,
+    [](uint32_t node, uint32_t attribute){(void)node; (void)attribute; return true;},
+    [](uint32_t node, uint32_t nbr, uint32_t attribute){(void)attribute; return nbr < node;},
+    4);
+  common::alloc_scratch_space(512*matrix->max_nbrhood_size*sizeof(uint32_t),4);
+  const size_t matrix_size = matrix->matrix_size;
+  DeltaMatrix<hybrid,hybrid> graph(matrix,0.1,4);
+
+  //Below the threshold the deltas stay, past it the batch compacts them.
+  vector< pair<uint32_t,uint32_t> > few_edges, edges;
+  for(size_t i = matrix_size-1000; i < matrix_size; i++){
+    matrix->get_row(i).foreach([&](uint32_t j){
+      edges.push_back(make_pair(i,j));
+      if(i >= matrix_size-10)
+        few_edges.push_back(make_pair(i,j));
+    });
+  }
+  graph.delete_edges(few_edges);
+  EXPECT_EQ((size_t)10, graph.snapshot()->num_dirty);
+  graph.delete_edges(edges);
+  EXPECT_EQ((size_t)0, graph.snapshot()->num_dirty);
+  graph.insert_edges(edges);
+  EXPECT_EQ((size_t)0, graph.snapshot()->num_dirty);
+
+  size_t expected_result = 1612010;
+  EXPECT_EQ(expected_result, (count_triangles<hybrid,hybrid>(graph.snapshot().get())));
+  delete inputGraph;
+}
+
+TEST(TEST1, HUB_NEIGHBORHOOD_SORT) {
+  //A star whose hub row is long enough to be sorted by all workers together.
+  const size_t num_leaves = 3*neighborhood_sort::HUB_ROW_LENGTH;
+  const string edge_list_path = temporary_file("hub_edges");
+  ofstream edges(edge_list_path);
+  for(size_t i = 0; i < num_leaves; i++){
+    const size_t leaf = 1 + (i*7919) % num_leaves;
+    edges << 0 << " " << leaf << endl;
+    if(i % 3 == 0)
+      edges << leaf << " " << 0 << endl;
+  }
+  edges.close();
+
+  MutableGraph* inputGraph = MutableGraph::undirectedFromEdgeList(edge_list_path,8);
+  unlink(edge_list_path.c_str());
+  EXPECT_EQ(num_leaves + num_leaves/3,inputGraph->max_nbrhood_size);
+  EXPECT_EQ(2*num_leaves,inputGraph->num_edges);
+  vector<uint32_t> *hub = inputGraph->out_neighborhoods->at(0);
+  ASSERT_EQ(num_leaves,hub->size());
+  for(size_t j = 0; j < hub->size(); j++){
+    EXPECT_EQ((uint32_t)(j+1),hub->at(j));
+  }
+  delete inputGraph;
+}
+
+TEST(TEST1, PARALLEL_REORDERINGS) {
+  //The parallel BFS visits nodes in the order of the serial one.
+  MutableGraph* serialGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  MutableGraph* parallelGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+  srand(7);
+  serialGraph->reorder_bfs(1);
+  srand(7);
+  parallelGraph->reorder_bfs(8);
+  EXPECT_TRUE(*serialGraph->id_map == *parallelGraph->id_map);
+  delete serialGraph;
+  delete parallelGraph;
+
+  const size_t expected_result = 1612010;
+  const std::function<void(MutableGraph*)> reorderings[] = {
+    [](MutableGraph *g){ g->reorder_bfs(8); },
+    [](MutableGraph *g){ g->reorder_strong_run(8); },
+    [](MutableGraph *g){ g->reorder_by_shingles(8); },
+    [](MutableGraph *g){ g->reorder_by_degree(8); },
+    [](MutableGraph *g){ g->reorder_rcm(8); },
+    [](MutableGraph *g){ g->reorder_gorder(5,8); },
+    [](MutableGraph *g){ g->reorder_rabbit(8); }
+  };
+  for(size_t r = 0; r < 7; r++){
+    MutableGraph* inputGraph = MutableGraph::undirectedFromBinary("test/data/facebook.bin");
+    vector<uint64_t> ids = *inputGraph->id_map;
+    reorderings[r](inputGraph);
+    vector<uint64_t> reordered_ids = *inputGraph->id_map;
+    std::sort(ids.begin(),ids.end());
+    std::sort(reordered_ids.begin(),reordered_ids.end());
+    EXPECT_TRUE(ids == reordered_ids);
+
+    Parser input_data(4,false,0,0,inputGraph,"hybrid");
+    undirected_triangle_counting<hybrid,hybrid> triangle_app(input_data);
+    triangle_app.run();
+    EXPECT_EQ(expected_result, triangle_app.num_triangles);
+    delete inputGraph;
+  }
+}
+
+TEST(TEST1, CACHED_ORDERING) {
+  const string graph_path = temporary_file("facebook_cached_ordering");
+  const string cache_path = ordering_cache::path(graph_path,"the_game");
+  {
+    ifstream src("test/data/facebook.bin", ios::binary);
+    ofstream dst(graph_path, ios::binary);
+    dst << src.rdbuf();
+  }
+
+  //The first run computes and caches the ordering, the second reuses it.
+  MutableGraph* computedGraph = MutableGraph::undirectedFromBinary(graph_path);
+  computedGraph->reorder_cached("the_game",graph_path,8);
+  ASSERT_TRUE(snapshot::exists(cache_path));
+  MutableGraph* cachedGraph = MutableGraph::undirectedFromBinary(graph_path);
+  srand(11);
+  cachedGraph->reorder_cached("the_game",graph_path,4);
+  EXPECT_TRUE(*computedGraph->id_map == *cachedGraph->id_map);
+  for(size_t i = 0; i < computedGraph->num_nodes; i++){
+    EXPECT_TRUE(*computedGraph->out_neighborhoods->at(i) == *cachedGraph->out_neighborhoods->at(i));
+  }
+
+  //A cache computed for another graph is not used.
+  MutableGraph* otherGraph = MutableGraph::undirectedFromBinary(graph_path);
+  otherGraph->reorder_random(4);
+  otherGraph->writeToBinaryV2(graph_path);
+  MutableGraph* changedGraph = MutableGraph::undirectedFromBinary(graph_path);
+  const uint64_t changed_hash = ordering_cache::graph_hash<uint32_t>(changedGraph->id_map,
+    changedGraph->out_neighborhoods,changedGraph->in_neighborhoods,true,4);
+  vector<uint32_t> new2old_ids;
+  EXPECT_FALSE(ordering_cache::load<uint32_t>(cache_path,"the_game",changed_hash,
+    changedGraph->num_nodes,new2old_ids));
+  changedGraph->reorder_cached("the_game",graph_path,4);
+  EXPECT_TRUE(ordering_cache::load<uint32_t>(cache_path,"the_game",changed_hash,
+    changedGraph->num_nodes,new2old_ids));
+
+  Parser input_data(4,false,0,0,cachedGraph,"hybrid");
+  undirected_triangle_counting<hybrid,hybrid> triangle_app(input_data);
+  triangle_app.run();
+  EXPECT_EQ((size_t)1612010, triangle_app.num_triangles);
+
+  unlink(cache_path.c_str());
+  unlink(graph_path.c_str());
+  delete computedGraph;
+  delete cachedGraph;
+  delete otherGraph;
+  delete changedGraph;
+}
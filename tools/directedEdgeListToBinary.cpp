@@ -3,15 +3,24 @@
 #include "MutableGraph.hpp"
 
 int main (int argc, char* argv[]) {
-  if(argc != 3){
+  if((argc != 3 && argc != 4) ||
+     (argc == 4 && string(argv[3]) != "--v1" && string(argv[3]) != "--compressed")){
     cout << "Please see usage below: " << endl;
-    cout << "\t./main <adjacency list file/folder> <input edgeList> <output file>" << endl;
+    cout << "\t./main <input edgeList> <output file> [--v1|--compressed]" << endl;
+    cout << "\t--v1 writes the first version of the binary format" << endl;
+    cout << "\t--compressed writes the compressed binary format" << endl;
     exit(0);
   }
   MutableGraph *inputGraph = MutableGraph::directedFromEdgeList(argv[1]);
   cout << "Loaded edge list" << endl;
   
-  inputGraph->writeDirectedToBinary(argv[2]);
+  const string format = (argc == 4) ? argv[3] : "";
+  if(format == "--v1")
+    inputGraph->writeDirectedToBinary(argv[2]);
+  else if(format == "--compressed")
+    inputGraph->writeToCompressedBinary(argv[2]);
+  else
+    inputGraph->writeToBinaryV2(argv[2]);
   
   return 0;
 }
@@ -0,0 +1,160 @@
+#define WRITE_VECTOR 0
+
+#include <random>
+#include "SparseMatrix.hpp"
+#include "MutableGraph.hpp"
+
+/*
+Applies every node ordering of MutableGraph to an undirected graph, builds
+the pruned hybrid matrix triangle counting uses and reports per ordering:
+the layouts chosen for the rows, bits per edge, the mean gap between
+consecutive neighbor ids and a triangle counting cost estimated from the
+intersections of sampled rows. The ordering of the lowest estimate is
+recommended and, given an output path, written as a binary graph.
+*/
+
+static const size_t SAMPLED_ROWS = 20000;
+static const unsigned SAMPLE_SEED = 12345;
+
+struct evaluation {
+  string name;
+  size_t num_rows[common::RUNS+1];
+  double bits_per_edge;
+  double mean_gap;
+  double mean_log_gap;
+  double estimated_seconds;
+  double reorder_seconds;
+};
+
+static void gaps(MutableGraph *inputGraph, double &mean_gap, double &mean_log_gap) {
+  double total = 0.0;
+  double total_log = 0.0;
+  size_t count = 0;
+  for(size_t i = 0; i < inputGraph->num_nodes; i++) {
+    vector<uint32_t> *row = inputGraph->out_neighborhoods->at(i);
+    for(size_t j = 1; j < row->size(); j++) {
+      const double gap = row->at(j) - row->at(j-1);
+      total += gap;
+      total_log += log2(gap);
+      count++;
+    }
+  }
+  mean_gap = (count == 0) ? 0.0 : total / count;
+  mean_log_gap = (count == 0) ? 0.0 : total_log / count;
+}
+
+//Runs the triangle counting work of the sampled rows on one thread and scales it to all rows.
+static double estimate_triangle_seconds(SparseMatrix<hybrid,hybrid> *graph) {
+  const size_t num_samples = min(SAMPLED_ROWS, graph->matrix_size);
+  vector<size_t> rows = common::range<size_t>(graph->matrix_size);
+  std::mt19937 generator(SAMPLE_SEED);
+  std::shuffle(rows.begin(), rows.end(), generator);
+
+  uint8_t *buffer = new uint8_t[512*graph->max_nbrhood_size*sizeof(uint32_t) + 1];
+  size_t num_triangles = 0;
+  const double start_time = common::startClock();
+  for(size_t s = 0; s < num_samples; s++) {
+    Set<hybrid> A = graph->get_row(rows[s]);
+    Set<hybrid> C(buffer);
+    A.foreach([&] (uint32_t j) {
+      Set<hybrid> B = graph->get_row(j);
+      num_triangles += ops::set_intersect(&C,&A,&B)->cardinality;
+    });
+  }
+  const double seconds = common::startClock() - start_time;
+  delete[] buffer;
+  (void) num_triangles;
+  return (num_samples == 0) ? 0.0 : seconds * graph->matrix_size / num_samples;
+}
+
+static evaluation evaluate(const string path, const string name,
+    std::function<void(MutableGraph*)> reorder_graph, const size_t num_threads,
+    const string output_path, const bool write) {
+  evaluation e;
+  e.name = name;
+  MutableGraph *inputGraph = MutableGraph::undirectedFromBinary(path, num_threads);
+  const double reorder_time = common::startClock();
+  reorder_graph(inputGraph);
+  e.reorder_seconds = common::startClock() - reorder_time;
+  if(write) {
+    inputGraph->writeToBinaryV2(output_path);
+    delete inputGraph;
+    return e;
+  }
+  gaps(inputGraph, e.mean_gap, e.mean_log_gap);
+
+  auto graph = SparseMatrix<hybrid,hybrid>::from_symmetric_graph(inputGraph,
+    [] (uint32_t node, uint32_t attribute) -> bool {
+      (void) node; (void) attribute;
+      return true;
+    },
+    [] (uint32_t node, uint32_t nbr, uint32_t attribute) -> bool {
+      (void) attribute;
+      return nbr < node;
+    },
+    num_threads);
+
+  std::fill(e.num_rows, e.num_rows + common::RUNS + 1, 0);
+  for(size_t i = 0; i < graph->matrix_size; i++) {
+    if(graph->row_lengths[i] > 0)
+      e.num_rows[graph->get_row(i).type]++;
+  }
+  e.bits_per_edge = (graph->cardinality == 0) ? 0.0 :
+    8.0 * graph->row_total_bytes_used / graph->cardinality;
+  e.estimated_seconds = estimate_triangle_seconds(graph);
+
+  delete graph;
+  delete inputGraph;
+  return e;
+}
+
+int main(int argc, char* argv[]) {
+  if(argc < 2 || argc > 4) {
+    cout << "Please see usage below: " << endl;
+    cout << "\t./evaluate_orderings <binary graph file> [<threads>] [<output binary of the best ordering>]" << endl;
+    exit(0);
+  }
+  const string path = argv[1];
+  const size_t num_threads = (argc > 2) ? atoi(argv[2]) : edge_list::default_num_threads();
+  const string output_path = (argc > 3) ? argv[3] : "";
+
+  //Orderings with a random component are seeded, so the persisted graph matches its evaluation.
+  const vector< pair<string, std::function<void(MutableGraph*)> > > orderings = {
+    make_pair("original", [](MutableGraph* g) { (void) g; }),
+    make_pair("random", [num_threads](MutableGraph* g) { srand(SAMPLE_SEED); g->reorder_random(num_threads); }),
+    make_pair("bfs", [num_threads](MutableGraph* g) { srand(SAMPLE_SEED); g->reorder_bfs(num_threads); }),
+    make_pair("degree", [num_threads](MutableGraph* g) { g->reorder_by_degree(num_threads); }),
+    make_pair("rev_degree", [num_threads](MutableGraph* g) { g->reorder_by_rev_degree(num_threads); }),
+    make_pair("strong_run", [num_threads](MutableGraph* g) { g->reorder_strong_run(num_threads); }),
+    make_pair("shingles", [num_threads](MutableGraph* g) { srand(SAMPLE_SEED); g->reorder_by_shingles(num_threads); }),
+    make_pair("the_game", [num_threads](MutableGraph* g) { srand(SAMPLE_SEED); g->reorder_by_the_game(num_threads); }),
+    make_pair("rcm", [num_threads](MutableGraph* g) { g->reorder_rcm(num_threads); }),
+    make_pair("gorder", [num_threads](MutableGraph* g) { g->reorder_gorder(5, num_threads); }),
+    make_pair("rabbit", [num_threads](MutableGraph* g) { g->reorder_rabbit(num_threads); })
+  };
+
+  vector<evaluation> evaluations;
+  for(size_t o = 0; o < orderings.size(); o++) {
+    evaluations.push_back(evaluate(path, orderings[o].first, orderings[o].second, num_threads, output_path, false));
+  }
+
+  size_t best = 0;
+  cout << endl << "ordering\treorder(s)\tbitset\tpshort\tuint\tbitpacked\tvariant\truns\tbits/edge\tmean gap\tmean log2 gap\testimated triangles(s)" << endl;
+  for(size_t o = 0; o < evaluations.size(); o++) {
+    const evaluation &e = evaluations[o];
+    cout << e.name << "\t" << e.reorder_seconds << "\t"
+      << e.num_rows[common::BITSET] << "\t" << e.num_rows[common::PSHORT] << "\t"
+      << e.num_rows[common::UINTEGER] << "\t" << e.num_rows[common::BITPACKED] << "\t"
+      << e.num_rows[common::VARIANT] << "\t" << e.num_rows[common::RUNS] << "\t" << e.bits_per_edge << "\t"
+      << e.mean_gap << "\t" << e.mean_log_gap << "\t" << e.estimated_seconds << endl;
+    if(e.estimated_seconds < evaluations[best].estimated_seconds)
+      best = o;
+  }
+  cout << "Recommended ordering: " << evaluations[best].name << endl;
+
+  if(output_path != "") {
+    evaluate(path, orderings[best].first, orderings[best].second, num_threads, output_path, true);
+    cout << evaluations[best].name << " ordering written to " << output_path << endl;
+  }
+  return 0;
+}
@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include "MutableGraph.hpp"
 
+static string format = "";
+
 void gen_ordering(
     char* argv[],
     string const& name,
@@ -12,16 +14,26 @@ void gen_ordering(
   auto startTime = common::startClock();
   reorder_graph(inputGraph);
   common::stopClock(name, startTime);
-  inputGraph->writeUndirectedToBinary(outfile);
+  if(format == "--v1")
+    inputGraph->writeUndirectedToBinary(outfile);
+  else if(format == "--compressed")
+    inputGraph->writeToCompressedBinary(outfile);
+  else
+    inputGraph->writeToBinaryV2(outfile);
   cout << name << " generated" << endl;
 }
 
 int main (int argc, char* argv[]) {
-  if(argc != 3){
+  if((argc != 3 && argc != 4) ||
+     (argc == 4 && string(argv[3]) != "--v1" && string(argv[3]) != "--compressed")){
     cout << "Please see usage below: " << endl;
-    cout << "\t./main <input edgeList> <output path>" << endl;
+    cout << "\t./main <input edgeList> <output path> [--v1|--compressed]" << endl;
+    cout << "\t--v1 writes the first version of the binary format" << endl;
+    cout << "\t--compressed writes the compressed binary format" << endl;
     exit(0);
   }
+  if(argc == 4)
+    format = argv[3];
 
   gen_ordering(argv, "shingles", [](MutableGraph* g) { g->reorder_by_shingles(); });
   gen_ordering(argv, "the_game", [](MutableGraph* g) { g->reorder_by_the_game(); });
@@ -30,6 +42,9 @@ int main (int argc, char* argv[]) {
   gen_ordering(argv, "rev_degree", [](MutableGraph* g) { g->reorder_by_rev_degree(); });
   gen_ordering(argv, "strong_run", [](MutableGraph* g) { g->reorder_strong_run(); });
   gen_ordering(argv, "random", [](MutableGraph* g) { g->reorder_random(); });
+  gen_ordering(argv, "rcm", [](MutableGraph* g) { g->reorder_rcm(); });
+  gen_ordering(argv, "gorder", [](MutableGraph* g) { g->reorder_gorder(); });
+  gen_ordering(argv, "rabbit", [](MutableGraph* g) { g->reorder_rabbit(); });
 
   return 0;
 }